@@ -43,6 +43,45 @@ CREATE OR REPLACE FUNCTION @extschema@.remove_reorder_policy(hypertable REGCLASS
 AS '@MODULE_PATHNAME@', 'ts_policy_reorder_remove'
 LANGUAGE C VOLATILE STRICT;
 
+/* chunk precreation policy */
+-- Create the chunks for the current and the next chunks_ahead time ranges
+-- ahead of time, so that inserts do not have to create them.
+CREATE OR REPLACE FUNCTION @extschema@.add_chunk_precreation_policy(
+    hypertable REGCLASS,
+    chunks_ahead INTEGER = 1,
+    if_not_exists BOOL = false,
+    schedule_interval INTERVAL = NULL,
+    initial_start TIMESTAMPTZ = NULL,
+    timezone TEXT = NULL
+) RETURNS INTEGER
+AS '@MODULE_PATHNAME@', 'ts_policy_chunk_precreation_add'
+LANGUAGE C VOLATILE;
+
+CREATE OR REPLACE FUNCTION @extschema@.remove_chunk_precreation_policy(hypertable REGCLASS, if_exists BOOL = false) RETURNS VOID
+AS '@MODULE_PATHNAME@', 'ts_policy_chunk_precreation_remove'
+LANGUAGE C VOLATILE STRICT;
+
+/* staging policy */
+-- Create new chunks of the hypertable unlogged, so that inserts skip WAL,
+-- and merge chunks older than merge_after into regular chunks sorted on the
+-- time index. Chunks that are not merged yet are truncated by crash recovery
+-- and queries that read them fail on physical standbys.
+CREATE OR REPLACE FUNCTION @extschema@.add_staging_policy(
+    hypertable REGCLASS,
+    merge_after "any",
+    if_not_exists BOOL = false,
+    schedule_interval INTERVAL = NULL,
+    initial_start TIMESTAMPTZ = NULL,
+    timezone TEXT = NULL
+) RETURNS INTEGER
+AS '@MODULE_PATHNAME@', 'ts_policy_staging_add'
+LANGUAGE C VOLATILE;
+
+-- Removing the policy merges the chunks that are still staged.
+CREATE OR REPLACE FUNCTION @extschema@.remove_staging_policy(hypertable REGCLASS, if_exists BOOL = false) RETURNS VOID
+AS '@MODULE_PATHNAME@', 'ts_policy_staging_remove'
+LANGUAGE C VOLATILE STRICT;
+
 /* compression policy */
 CREATE OR REPLACE FUNCTION @extschema@.add_compression_policy(
     hypertable REGCLASS, compress_after "any",
@@ -18,6 +18,22 @@ CREATE OR REPLACE FUNCTION _timescaledb_internal.policy_reorder_check(config JSO
 RETURNS void AS '@MODULE_PATHNAME@', 'ts_policy_reorder_check'
 LANGUAGE C;
 
+CREATE OR REPLACE PROCEDURE _timescaledb_internal.policy_chunk_precreation(job_id INTEGER, config JSONB)
+AS '@MODULE_PATHNAME@', 'ts_policy_chunk_precreation_proc'
+LANGUAGE C;
+
+CREATE OR REPLACE FUNCTION _timescaledb_internal.policy_chunk_precreation_check(config JSONB)
+RETURNS void AS '@MODULE_PATHNAME@', 'ts_policy_chunk_precreation_check'
+LANGUAGE C;
+
+CREATE OR REPLACE PROCEDURE _timescaledb_internal.policy_staging(job_id INTEGER, config JSONB)
+AS '@MODULE_PATHNAME@', 'ts_policy_staging_proc'
+LANGUAGE C;
+
+CREATE OR REPLACE FUNCTION _timescaledb_internal.policy_staging_check(config JSONB)
+RETURNS void AS '@MODULE_PATHNAME@', 'ts_policy_staging_check'
+LANGUAGE C;
+
 CREATE OR REPLACE PROCEDURE _timescaledb_internal.policy_recompression(job_id INTEGER, config JSONB)
 AS '@MODULE_PATHNAME@', 'ts_policy_recompression_proc'
 LANGUAGE C;
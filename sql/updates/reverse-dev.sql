@@ -30,3 +30,23 @@ RETURNS TABLE (job_id INTEGER, schedule_interval INTERVAL, max_runtime INTERVAL,
 next_start TIMESTAMPTZ, check_config TEXT)
 AS '@MODULE_PATHNAME@', 'ts_job_alter'
 LANGUAGE C VOLATILE;
+
+DROP FUNCTION IF EXISTS @extschema@.add_chunk_precreation_policy(REGCLASS, INTEGER, BOOL, INTERVAL, TIMESTAMPTZ, TEXT);
+DROP FUNCTION IF EXISTS @extschema@.remove_chunk_precreation_policy(REGCLASS, BOOL);
+DROP PROCEDURE IF EXISTS _timescaledb_internal.policy_chunk_precreation(INTEGER, JSONB);
+DROP FUNCTION IF EXISTS _timescaledb_internal.policy_chunk_precreation_check(JSONB);
+
+DROP VIEW IF EXISTS timescaledb_information.cache_stats;
+DROP VIEW IF EXISTS timescaledb_information.cache_stats_shared;
+DROP FUNCTION IF EXISTS _timescaledb_internal.cache_stats(BOOL);
+
+DROP VIEW IF EXISTS timescaledb_information.continuous_aggregate_refresh_stats;
+DROP FUNCTION IF EXISTS _timescaledb_internal.cagg_refresh_stats();
+
+DROP VIEW IF EXISTS timescaledb_information.hypertable_insert_stats;
+DROP FUNCTION IF EXISTS _timescaledb_internal.insert_stats();
+
+DROP FUNCTION IF EXISTS @extschema@.add_staging_policy(REGCLASS, "any", BOOL, INTERVAL, TIMESTAMPTZ, TEXT);
+DROP FUNCTION IF EXISTS @extschema@.remove_staging_policy(REGCLASS, BOOL);
+DROP PROCEDURE IF EXISTS _timescaledb_internal.policy_staging(INTEGER, JSONB);
+DROP FUNCTION IF EXISTS _timescaledb_internal.policy_staging_check(JSONB);
@@ -346,4 +346,130 @@ WHERE
 			   'MEMBER') IS TRUE
     OR pg_catalog.pg_has_role(current_user, owner, 'MEMBER') IS TRUE;
 
+-- Statistics of the internal caches, either for the current backend or
+-- aggregated over all backends. Backends add their statistics to the
+-- aggregate at the end of every transaction.
+CREATE OR REPLACE FUNCTION _timescaledb_internal.cache_stats(
+    shared BOOL = false
+) RETURNS TABLE (
+    cache_name NAME,
+    hits BIGINT,
+    misses BIGINT,
+    evictions BIGINT,
+    invalidations BIGINT,
+    num_elements BIGINT,
+    memory_bytes BIGINT
+) AS '@MODULE_PATHNAME@', 'ts_cache_stats' LANGUAGE C VOLATILE;
+
+CREATE OR REPLACE VIEW timescaledb_information.cache_stats AS
+SELECT *
+FROM _timescaledb_internal.cache_stats(shared => false)
+ORDER BY cache_name;
+
+CREATE OR REPLACE VIEW timescaledb_information.cache_stats_shared AS
+SELECT cache_name,
+    hits,
+    misses,
+    evictions,
+    invalidations
+FROM _timescaledb_internal.cache_stats(shared => true)
+ORDER BY cache_name;
+
+-- Statistics of continuous aggregate refreshes since the server started,
+-- including the progress of refreshes that are running. Durations of the
+-- phases are summed over all refreshes.
+CREATE OR REPLACE FUNCTION _timescaledb_internal.cagg_refresh_stats()
+RETURNS TABLE (
+    mat_hypertable_id INTEGER,
+    refreshes BIGINT,
+    failed_refreshes BIGINT,
+    last_refresh_start TIMESTAMPTZ,
+    last_refresh_duration INTERVAL,
+    last_ranges_refreshed BIGINT,
+    last_rows_deleted BIGINT,
+    last_rows_inserted BIGINT,
+    total_refresh_duration INTERVAL,
+    ranges_refreshed BIGINT,
+    rows_deleted BIGINT,
+    rows_inserted BIGINT,
+    raw_rows_read BIGINT,
+    compressed_batches_read BIGINT,
+    invalidation_duration INTERVAL,
+    delete_duration INTERVAL,
+    insert_duration INTERVAL,
+    watermark_duration INTERVAL,
+    running_pid INTEGER,
+    running_phase TEXT,
+    running_since TIMESTAMPTZ,
+    running_phase_since TIMESTAMPTZ,
+    running_ranges_refreshed BIGINT,
+    running_rows_inserted BIGINT
+) AS '@MODULE_PATHNAME@', 'ts_cagg_refresh_stats' LANGUAGE C VOLATILE;
+
+CREATE OR REPLACE VIEW timescaledb_information.continuous_aggregate_refresh_stats AS
+SELECT cagg.user_view_schema AS view_schema,
+    cagg.user_view_name AS view_name,
+    stats.refreshes,
+    stats.failed_refreshes,
+    stats.last_refresh_start,
+    stats.last_refresh_duration,
+    stats.last_ranges_refreshed,
+    stats.last_rows_deleted,
+    stats.last_rows_inserted,
+    stats.total_refresh_duration,
+    stats.ranges_refreshed,
+    stats.rows_deleted,
+    stats.rows_inserted,
+    stats.raw_rows_read,
+    stats.compressed_batches_read,
+    stats.invalidation_duration,
+    stats.delete_duration,
+    stats.insert_duration,
+    stats.watermark_duration,
+    stats.running_pid,
+    stats.running_phase,
+    stats.running_since,
+    stats.running_phase_since,
+    stats.running_ranges_refreshed,
+    stats.running_rows_inserted
+FROM _timescaledb_internal.cagg_refresh_stats() stats
+JOIN _timescaledb_catalog.continuous_agg cagg ON cagg.mat_hypertable_id = stats.mat_hypertable_id
+ORDER BY view_schema, view_name;
+
+-- Latencies of the stages of the insert path of hypertables since the
+-- server started, collected when timescaledb.track_insert_stats is
+-- enabled. Times are in milliseconds and percentiles are estimated from a
+-- histogram with power-of-two buckets of nanoseconds.
+CREATE OR REPLACE FUNCTION _timescaledb_internal.insert_stats()
+RETURNS TABLE (
+    hypertable_id INTEGER,
+    stage TEXT,
+    statements BIGINT,
+    calls BIGINT,
+    total_time FLOAT8,
+    mean_time FLOAT8,
+    p50_time FLOAT8,
+    p90_time FLOAT8,
+    p99_time FLOAT8,
+    max_time FLOAT8,
+    histogram BIGINT[]
+) AS '@MODULE_PATHNAME@', 'ts_insert_stats' LANGUAGE C VOLATILE;
+
+CREATE OR REPLACE VIEW timescaledb_information.hypertable_insert_stats AS
+SELECT ht.schema_name AS hypertable_schema,
+    ht.table_name AS hypertable_name,
+    stats.stage,
+    stats.statements,
+    stats.calls,
+    stats.total_time,
+    stats.mean_time,
+    stats.p50_time,
+    stats.p90_time,
+    stats.p99_time,
+    stats.max_time,
+    stats.histogram
+FROM _timescaledb_internal.insert_stats() stats
+JOIN _timescaledb_catalog.hypertable ht ON ht.id = stats.hypertable_id
+ORDER BY hypertable_schema, hypertable_name, stage;
+
 GRANT SELECT ON ALL TABLES IN SCHEMA timescaledb_information TO PUBLIC;
@@ -8,6 +8,7 @@
 #include <utils/builtins.h>
 
 #include "bgw/job.h"
+#include "extension_constants.h"
 #include "policy.h"
 
 void
@@ -24,6 +25,14 @@ ts_bgw_policy_delete_by_hypertable_id(int32 hypertable_id)
 	}
 }
 
+bool
+ts_bgw_policy_staging_exists(int32 hypertable_id)
+{
+	return ts_bgw_job_find_by_proc_and_hypertable_id(POLICY_STAGING_PROC_NAME,
+													 INTERNAL_SCHEMA_NAME,
+													 hypertable_id) != NIL;
+}
+
 /* This function does NOT cascade deletes to the bgw_job table. */
 ScanTupleResult
 ts_bgw_policy_delete_row_only_tuple_found(TupleInfo *ti, void *const data)
@@ -12,8 +12,15 @@
 #include "export.h"
 #include "config.h"
 
+/*
+ * New chunks of hypertables with a staging policy are created unlogged, and
+ * the policy's job turns them into regular chunks later.
+ */
+#define POLICY_STAGING_PROC_NAME "policy_staging"
+
 extern ScanTupleResult ts_bgw_policy_delete_row_only_tuple_found(TupleInfo *ti, void *const data);
 
 extern void ts_bgw_policy_delete_by_hypertable_id(int32 hypertable_id);
+extern bool ts_bgw_policy_staging_exists(int32 hypertable_id);
 
 #endif /* TIMESCALEDB_BGW_POLICY_POLICY_H */
@@ -8,6 +8,7 @@
 #include <storage/ipc.h>
 
 #include "cache.h"
+#include "cache_stats.h"
 #include "compat/compat.h"
 
 /* List of pinned caches. A cache occurs once in this list for every pin
@@ -57,6 +58,8 @@ ts_cache_init(Cache *cache)
 	cache->refcount = 1;
 	cache->handle_txn_callbacks = true;
 	cache->release_on_commit = true;
+	cache->backend_stats = ts_cache_stats_get_entry(cache->name);
+	cache->backend_stats->mcxt = ts_cache_memory_ctx(cache);
 }
 
 static void
@@ -71,6 +74,12 @@ cache_destroy(Cache *cache)
 	if (cache->pre_destroy_hook != NULL)
 		cache->pre_destroy_hook(cache);
 
+	cache->backend_stats->num_elements -= cache->stats.numelements;
+
+	/* A newer instance of the cache might already have replaced this one */
+	if (cache->backend_stats->mcxt == ts_cache_memory_ctx(cache))
+		cache->backend_stats->mcxt = NULL;
+
 	hash_destroy(cache->htab);
 	MemoryContextDelete(cache->hctl.hcxt);
 }
@@ -80,6 +89,7 @@ ts_cache_invalidate(Cache *cache)
 {
 	if (cache == NULL)
 		return;
+	cache->backend_stats->invalidations++;
 	cache->refcount--;
 	cache_destroy(cache);
 }
@@ -185,6 +195,7 @@ ts_cache_fetch(Cache *cache, CacheQuery *query)
 	if (found)
 	{
 		cache->stats.hits++;
+		cache->backend_stats->hits++;
 
 		if (cache->update_entry != NULL)
 			query->result = cache->update_entry(cache, query);
@@ -192,10 +203,12 @@ ts_cache_fetch(Cache *cache, CacheQuery *query)
 	else
 	{
 		cache->stats.misses++;
+		cache->backend_stats->misses++;
 
 		if (action == HASH_ENTER)
 		{
 			cache->stats.numelements++;
+			cache->backend_stats->num_elements++;
 			query->result = cache->create_entry(cache, query);
 		}
 	}
@@ -226,8 +239,14 @@ ts_cache_remove(Cache *cache, void *key)
 	}
 
 	hash_search(cache->htab, key, HASH_REMOVE, &found);
+
+	/* Entries are removed explicitly when the object they describe is gone,
+	 * so this is not an eviction and only the number of elements changes. */
 	if (found)
+	{
 		cache->stats.numelements--;
+		cache->backend_stats->num_elements--;
+	}
 
 	return found;
 }
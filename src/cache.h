@@ -12,6 +12,8 @@
 
 #include "export.h"
 
+typedef struct CacheStatsEntry CacheStatsEntry;
+
 typedef enum CacheQueryFlags
 {
 	CACHE_FLAG_NONE = 0,
@@ -45,6 +47,8 @@ typedef struct Cache
 	long numelements;
 	int flags;
 	CacheStats stats;
+	/* Statistics shared by all instances of caches with the same name */
+	CacheStatsEntry *backend_stats;
 	void *(*get_key)(struct CacheQuery *);
 	void *(*create_entry)(struct Cache *, CacheQuery *);
 	void *(*update_entry)(struct Cache *, CacheQuery *);
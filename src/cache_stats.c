@@ -0,0 +1,331 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#include <postgres.h>
+#include <access/htup_details.h>
+#include <access/xact.h>
+#include <fmgr.h>
+#include <funcapi.h>
+#include <port/atomics.h>
+#include <storage/lwlock.h>
+#include <utils/builtins.h>
+
+#include "cache_stats.h"
+#include "loader/cache_stats.h"
+#include "utils.h"
+
+/*
+ * Statistics for the internal caches.
+ *
+ * Each backend keeps its own counters, which can be read without any
+ * locking. At the end of every transaction, the counters that changed since
+ * the last flush are added to the statistics in shared memory, which are
+ * set up by the loader and therefore shared by all databases and extension
+ * versions in the cluster.
+ */
+static CacheStatsEntry cache_stats[CACHE_STATS_MAX_ENTRIES];
+static int cache_stats_num_entries = 0;
+
+/* Entry used for caches that do not fit in the registry. Never exposed. */
+static CacheStatsEntry cache_stats_overflow;
+
+static CacheStatsShared *cache_stats_shared = NULL;
+
+enum Anum_cache_stats
+{
+	Anum_cache_stats_name = 1,
+	Anum_cache_stats_hits,
+	Anum_cache_stats_misses,
+	Anum_cache_stats_evictions,
+	Anum_cache_stats_invalidations,
+	Anum_cache_stats_num_elements,
+	Anum_cache_stats_memory_bytes,
+	_Anum_cache_stats_max,
+};
+
+#define Natts_cache_stats (_Anum_cache_stats_max - 1)
+
+/*
+ * Get the statistics entry for the cache with the given name, creating it if
+ * necessary.
+ *
+ * The returned entry lives for the lifetime of the backend, so caches can
+ * keep a pointer to it.
+ */
+CacheStatsEntry *
+ts_cache_stats_get_entry(const char *name)
+{
+	CacheStatsEntry *entry;
+	int i;
+
+	for (i = 0; i < cache_stats_num_entries; i++)
+	{
+		if (strncmp(NameStr(cache_stats[i].name), name, NAMEDATALEN) == 0)
+			return &cache_stats[i];
+	}
+
+	if (cache_stats_num_entries >= CACHE_STATS_MAX_ENTRIES)
+		return &cache_stats_overflow;
+
+	entry = &cache_stats[cache_stats_num_entries++];
+	memset(entry, 0, sizeof(CacheStatsEntry));
+	namestrcpy(&entry->name, name);
+
+	return entry;
+}
+
+static CacheStatsShared *
+cache_stats_get_shared(void)
+{
+	if (cache_stats_shared == NULL)
+	{
+		CacheStatsShared **rendezvous =
+			(CacheStatsShared **) find_rendezvous_variable(RENDEZVOUS_CACHE_STATS);
+
+		/* The loader might be an older version without cache statistics */
+		cache_stats_shared = *rendezvous;
+	}
+
+	return cache_stats_shared;
+}
+
+/*
+ * Find the shared entry for a cache, claiming a free one if this is the first
+ * time the cache is seen in the cluster.
+ */
+static CacheStatsSharedEntry *
+cache_stats_get_shared_entry(CacheStatsShared *shared, const NameData *name)
+{
+	CacheStatsSharedEntry *result = NULL;
+	int i;
+
+	LWLockAcquire(shared->lock, LW_EXCLUSIVE);
+
+	for (i = 0; i < shared->num_entries; i++)
+	{
+		if (namestrcmp(&shared->entries[i].name, NameStr(*name)) == 0)
+		{
+			result = &shared->entries[i];
+			break;
+		}
+	}
+
+	if (result == NULL && shared->num_entries < CACHE_STATS_MAX_ENTRIES)
+	{
+		result = &shared->entries[shared->num_entries++];
+		namestrcpy(&result->name, NameStr(*name));
+	}
+
+	LWLockRelease(shared->lock);
+
+	return result;
+}
+
+#define FLUSH_COUNTER(entry, counter)                                                              \
+	do                                                                                             \
+	{                                                                                              \
+		if ((entry)->counter > (entry)->flushed_##counter)                                         \
+		{                                                                                          \
+			pg_atomic_fetch_add_u64(&(entry)->shared->counter,                                     \
+									(entry)->counter - (entry)->flushed_##counter);                \
+			(entry)->flushed_##counter = (entry)->counter;                                         \
+		}                                                                                          \
+	} while (0)
+
+/*
+ * Add the counters of this backend to the shared statistics.
+ */
+static void
+cache_stats_flush(void)
+{
+	CacheStatsShared *shared = cache_stats_get_shared();
+	int i;
+
+	if (shared == NULL)
+		return;
+
+	for (i = 0; i < cache_stats_num_entries; i++)
+	{
+		CacheStatsEntry *entry = &cache_stats[i];
+
+		if (entry->shared == NULL)
+		{
+			entry->shared = cache_stats_get_shared_entry(shared, &entry->name);
+
+			/* No space left in shared memory */
+			if (entry->shared == NULL)
+				continue;
+		}
+
+		FLUSH_COUNTER(entry, hits);
+		FLUSH_COUNTER(entry, misses);
+		FLUSH_COUNTER(entry, evictions);
+		FLUSH_COUNTER(entry, invalidations);
+	}
+}
+
+static void
+cache_stats_xact_end(XactEvent event, void *arg)
+{
+	switch (event)
+	{
+		case XACT_EVENT_COMMIT:
+		case XACT_EVENT_PARALLEL_COMMIT:
+		case XACT_EVENT_ABORT:
+		case XACT_EVENT_PARALLEL_ABORT:
+			cache_stats_flush();
+			break;
+		default:
+			break;
+	}
+}
+
+/*
+ * Get the memory used by a cache.
+ *
+ * Caches that track the size of their elements report that size. Otherwise,
+ * the size of the memory context of the current instance of the cache is
+ * used, if there is one.
+ */
+static bool
+cache_stats_memory_bytes(const CacheStatsEntry *entry, int64 *memory_bytes)
+{
+	if (entry->track_memory)
+		*memory_bytes = entry->memory_bytes;
+	else if (entry->mcxt != NULL)
+		*memory_bytes = (int64) ts_memory_context_allocated(entry->mcxt);
+	else
+		return false;
+
+	return true;
+}
+
+static HeapTuple
+cache_stats_make_tuple(TupleDesc tupdesc, const CacheStatsEntry *entry)
+{
+	Datum values[Natts_cache_stats] = { 0 };
+	bool nulls[Natts_cache_stats] = { false };
+	int64 memory_bytes;
+
+	values[AttrNumberGetAttrOffset(Anum_cache_stats_name)] = NameGetDatum(&entry->name);
+	values[AttrNumberGetAttrOffset(Anum_cache_stats_hits)] = Int64GetDatum(entry->hits);
+	values[AttrNumberGetAttrOffset(Anum_cache_stats_misses)] = Int64GetDatum(entry->misses);
+	values[AttrNumberGetAttrOffset(Anum_cache_stats_evictions)] = Int64GetDatum(entry->evictions);
+	values[AttrNumberGetAttrOffset(Anum_cache_stats_invalidations)] =
+		Int64GetDatum(entry->invalidations);
+	values[AttrNumberGetAttrOffset(Anum_cache_stats_num_elements)] =
+		Int64GetDatum(entry->num_elements);
+
+	if (cache_stats_memory_bytes(entry, &memory_bytes))
+		values[AttrNumberGetAttrOffset(Anum_cache_stats_memory_bytes)] =
+			Int64GetDatum(memory_bytes);
+	else
+		nulls[AttrNumberGetAttrOffset(Anum_cache_stats_memory_bytes)] = true;
+
+	return heap_form_tuple(tupdesc, values, nulls);
+}
+
+/*
+ * Statistics aggregated over all backends do not include the number of
+ * elements and memory usage since these are only meaningful for a backend.
+ */
+static HeapTuple
+cache_stats_make_shared_tuple(TupleDesc tupdesc, CacheStatsSharedEntry *entry)
+{
+	Datum values[Natts_cache_stats] = { 0 };
+	bool nulls[Natts_cache_stats] = { false };
+
+	values[AttrNumberGetAttrOffset(Anum_cache_stats_name)] = NameGetDatum(&entry->name);
+	values[AttrNumberGetAttrOffset(Anum_cache_stats_hits)] =
+		Int64GetDatum((int64) pg_atomic_read_u64(&entry->hits));
+	values[AttrNumberGetAttrOffset(Anum_cache_stats_misses)] =
+		Int64GetDatum((int64) pg_atomic_read_u64(&entry->misses));
+	values[AttrNumberGetAttrOffset(Anum_cache_stats_evictions)] =
+		Int64GetDatum((int64) pg_atomic_read_u64(&entry->evictions));
+	values[AttrNumberGetAttrOffset(Anum_cache_stats_invalidations)] =
+		Int64GetDatum((int64) pg_atomic_read_u64(&entry->invalidations));
+	nulls[AttrNumberGetAttrOffset(Anum_cache_stats_num_elements)] = true;
+	nulls[AttrNumberGetAttrOffset(Anum_cache_stats_memory_bytes)] = true;
+
+	return heap_form_tuple(tupdesc, values, nulls);
+}
+
+TS_FUNCTION_INFO_V1(ts_cache_stats);
+
+/*
+ * Return the statistics of the internal caches.
+ *
+ * With shared = false, the statistics of the current backend are returned.
+ * Otherwise the statistics aggregated over all backends are returned. The
+ * aggregated statistics include the counters of the current backend, but
+ * other backends only add their counters at the end of a transaction.
+ */
+Datum
+ts_cache_stats(PG_FUNCTION_ARGS)
+{
+	bool shared = PG_ARGISNULL(0) ? false : PG_GETARG_BOOL(0);
+	FuncCallContext *funcctx;
+	CacheStatsShared *shared_stats;
+	HeapTuple tuple;
+	int num_entries;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		MemoryContext oldcontext;
+		TupleDesc tupdesc;
+
+		funcctx = SRF_FIRSTCALL_INIT();
+		oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("function returning record called in context "
+							"that cannot accept type record")));
+
+		funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+		MemoryContextSwitchTo(oldcontext);
+
+		if (shared)
+			cache_stats_flush();
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	shared_stats = shared ? cache_stats_get_shared() : NULL;
+
+	if (!shared)
+		num_entries = cache_stats_num_entries;
+	else if (shared_stats == NULL)
+		num_entries = 0;
+	else
+	{
+		LWLockAcquire(shared_stats->lock, LW_SHARED);
+		num_entries = shared_stats->num_entries;
+		LWLockRelease(shared_stats->lock);
+	}
+
+	if (funcctx->call_cntr >= (uint64) num_entries)
+		SRF_RETURN_DONE(funcctx);
+
+	if (shared)
+		tuple = cache_stats_make_shared_tuple(funcctx->tuple_desc,
+											  &shared_stats->entries[funcctx->call_cntr]);
+	else
+		tuple = cache_stats_make_tuple(funcctx->tuple_desc, &cache_stats[funcctx->call_cntr]);
+
+	SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+}
+
+void
+_cache_stats_init(void)
+{
+	RegisterXactCallback(cache_stats_xact_end, NULL);
+}
+
+void
+_cache_stats_fini(void)
+{
+	UnregisterXactCallback(cache_stats_xact_end, NULL);
+}
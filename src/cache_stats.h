@@ -0,0 +1,51 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#ifndef TIMESCALEDB_CACHE_STATS_H
+#define TIMESCALEDB_CACHE_STATS_H
+
+#include <postgres.h>
+
+#include "export.h"
+
+typedef struct CacheStatsSharedEntry CacheStatsSharedEntry;
+
+/*
+ * Backend-local statistics for one kind of cache.
+ *
+ * All instances of a cache with the same name share an entry, so that, e.g.,
+ * the statistics of a hypertable cache survive its invalidation. Counters
+ * are cumulative for the lifetime of the backend and added to the statistics
+ * in shared memory at the end of every transaction.
+ */
+typedef struct CacheStatsEntry
+{
+	NameData name;
+	int64 hits;
+	int64 misses;
+	/* Entries dropped to make room for new ones, not explicit removals */
+	int64 evictions;
+	int64 invalidations;
+	/* Number of elements currently cached */
+	int64 num_elements;
+	/* Size of the cached elements, if tracked by the cache */
+	int64 memory_bytes;
+	bool track_memory;
+	/* Memory context of the current instance of the cache, if any */
+	MemoryContext mcxt;
+	/* Counter values already added to the shared statistics */
+	int64 flushed_hits;
+	int64 flushed_misses;
+	int64 flushed_evictions;
+	int64 flushed_invalidations;
+	CacheStatsSharedEntry *shared;
+} CacheStatsEntry;
+
+extern TSDLLEXPORT CacheStatsEntry *ts_cache_stats_get_entry(const char *name);
+
+extern void _cache_stats_init(void);
+extern void _cache_stats_fini(void);
+
+#endif /* TIMESCALEDB_CACHE_STATS_H */
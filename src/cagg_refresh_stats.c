@@ -0,0 +1,464 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#include <postgres.h>
+#include <access/htup_details.h>
+#include <fmgr.h>
+#include <funcapi.h>
+#include <miscadmin.h>
+#include <storage/lwlock.h>
+#include <storage/procarray.h>
+#include <utils/builtins.h>
+#include <utils/timestamp.h>
+
+#include "cagg_refresh_stats.h"
+#include "utils.h"
+
+/*
+ * Statistics of continuous aggregate refreshes.
+ *
+ * A refresh counts the work it does in backend-local counters, which are
+ * published to shared memory whenever the refresh moves on to another
+ * phase, so that refreshes in progress can be monitored. At the end of the
+ * refresh, the counters are added to the totals of the continuous
+ * aggregate. The statistics are set up by the loader and kept for a limited
+ * number of continuous aggregates, evicting the least recently refreshed
+ * one when needed.
+ */
+static CaggRefreshStats *current_refresh = NULL;
+
+static CaggRefreshStatsShared *cagg_refresh_stats_shared = NULL;
+
+static const char *phase_names[] = {
+	[CAGG_REFRESH_PHASE_NONE] = "materialize",
+	[CAGG_REFRESH_PHASE_INVALIDATION] = "invalidation",
+	[CAGG_REFRESH_PHASE_DELETE] = "delete",
+	[CAGG_REFRESH_PHASE_INSERT] = "insert",
+	[CAGG_REFRESH_PHASE_WATERMARK] = "watermark",
+	[CAGG_REFRESH_PHASE_CASCADE] = "cascade",
+};
+
+enum Anum_cagg_refresh_stats
+{
+	Anum_cagg_refresh_stats_mat_hypertable_id = 1,
+	Anum_cagg_refresh_stats_refreshes,
+	Anum_cagg_refresh_stats_failed_refreshes,
+	Anum_cagg_refresh_stats_last_refresh_start,
+	Anum_cagg_refresh_stats_last_refresh_duration,
+	Anum_cagg_refresh_stats_last_ranges_refreshed,
+	Anum_cagg_refresh_stats_last_rows_deleted,
+	Anum_cagg_refresh_stats_last_rows_inserted,
+	Anum_cagg_refresh_stats_total_refresh_duration,
+	Anum_cagg_refresh_stats_ranges_refreshed,
+	Anum_cagg_refresh_stats_rows_deleted,
+	Anum_cagg_refresh_stats_rows_inserted,
+	Anum_cagg_refresh_stats_raw_rows_read,
+	Anum_cagg_refresh_stats_compressed_batches_read,
+	Anum_cagg_refresh_stats_invalidation_duration,
+	Anum_cagg_refresh_stats_delete_duration,
+	Anum_cagg_refresh_stats_insert_duration,
+	Anum_cagg_refresh_stats_watermark_duration,
+	Anum_cagg_refresh_stats_running_pid,
+	Anum_cagg_refresh_stats_running_phase,
+	Anum_cagg_refresh_stats_running_since,
+	Anum_cagg_refresh_stats_running_phase_since,
+	Anum_cagg_refresh_stats_running_ranges_refreshed,
+	Anum_cagg_refresh_stats_running_rows_inserted,
+	_Anum_cagg_refresh_stats_max,
+};
+
+#define Natts_cagg_refresh_stats (_Anum_cagg_refresh_stats_max - 1)
+
+static CaggRefreshStatsShared *
+cagg_refresh_stats_get_shared(void)
+{
+	if (cagg_refresh_stats_shared == NULL)
+	{
+		CaggRefreshStatsShared **rendezvous = (CaggRefreshStatsShared **) find_rendezvous_variable(
+			RENDEZVOUS_CAGG_REFRESH_STATS);
+
+		/* The loader might be an older version without refresh statistics */
+		cagg_refresh_stats_shared = *rendezvous;
+	}
+
+	return cagg_refresh_stats_shared;
+}
+
+/*
+ * Find the entry of a continuous aggregate, claiming a free one or the one
+ * of the least recently refreshed continuous aggregate that is not being
+ * refreshed if it has none. Must hold the lock in exclusive mode.
+ */
+static CaggRefreshStatsSharedEntry *
+cagg_refresh_stats_get_entry(CaggRefreshStatsShared *shared, int32 mat_hypertable_id)
+{
+	CaggRefreshStatsSharedEntry *victim = NULL;
+	int i;
+
+	for (i = 0; i < CAGG_REFRESH_STATS_MAX_ENTRIES; i++)
+	{
+		CaggRefreshStatsSharedEntry *entry = &shared->entries[i];
+
+		if (entry->database_id == MyDatabaseId && entry->mat_hypertable_id == mat_hypertable_id)
+			return entry;
+
+		if (!OidIsValid(entry->database_id))
+		{
+			if (victim == NULL || OidIsValid(victim->database_id))
+				victim = entry;
+		}
+		else if (entry->pid == 0 && (victim == NULL || (OidIsValid(victim->database_id) &&
+														entry->last_start < victim->last_start)))
+			victim = entry;
+	}
+
+	if (victim != NULL)
+	{
+		memset(victim, 0, sizeof(CaggRefreshStatsSharedEntry));
+		victim->database_id = MyDatabaseId;
+		victim->mat_hypertable_id = mat_hypertable_id;
+	}
+
+	return victim;
+}
+
+/*
+ * Make the progress of the current refresh visible to other backends.
+ */
+static void
+cagg_refresh_stats_publish(CaggRefreshStats *stats)
+{
+	CaggRefreshStatsShared *shared = cagg_refresh_stats_get_shared();
+
+	if (shared == NULL || stats->shared == NULL)
+		return;
+
+	LWLockAcquire(shared->lock, LW_EXCLUSIVE);
+
+	if (stats->shared->pid == MyProcPid)
+	{
+		stats->shared->phase = stats->phase;
+		stats->shared->phase_start = stats->phase_start;
+		stats->shared->current = stats->counters;
+	}
+
+	LWLockRelease(shared->lock);
+}
+
+/*
+ * Start collecting statistics for a refresh of a continuous aggregate.
+ */
+void
+ts_cagg_refresh_stats_begin(CaggRefreshStats *stats, int32 mat_hypertable_id)
+{
+	CaggRefreshStatsShared *shared = cagg_refresh_stats_get_shared();
+
+	MemSet(stats, 0, sizeof(CaggRefreshStats));
+	stats->mat_hypertable_id = mat_hypertable_id;
+	stats->phase = CAGG_REFRESH_PHASE_NONE;
+	stats->start = GetCurrentTimestamp();
+	stats->phase_start = stats->start;
+	stats->parent = current_refresh;
+	current_refresh = stats;
+
+	if (shared == NULL)
+		return;
+
+	LWLockAcquire(shared->lock, LW_EXCLUSIVE);
+	stats->shared = cagg_refresh_stats_get_entry(shared, mat_hypertable_id);
+
+	if (stats->shared != NULL)
+	{
+		stats->shared->pid = MyProcPid;
+		stats->shared->phase = stats->phase;
+		stats->shared->start = stats->start;
+		stats->shared->phase_start = stats->phase_start;
+		MemSet(&stats->shared->current, 0, sizeof(CaggRefreshCounters));
+	}
+
+	LWLockRelease(shared->lock);
+}
+
+static void
+cagg_refresh_counters_add(CaggRefreshCounters *total, const CaggRefreshCounters *counters)
+{
+	total->ranges += counters->ranges;
+	total->rows_deleted += counters->rows_deleted;
+	total->rows_inserted += counters->rows_inserted;
+	total->raw_rows_read += counters->raw_rows_read;
+	total->compressed_batches_read += counters->compressed_batches_read;
+	total->invalidation_time += counters->invalidation_time;
+	total->delete_time += counters->delete_time;
+	total->insert_time += counters->insert_time;
+	total->watermark_time += counters->watermark_time;
+	total->total_time += counters->total_time;
+}
+
+/*
+ * Add the time spent in the current phase to its counter and start a new
+ * phase.
+ */
+static void
+cagg_refresh_stats_switch_phase(CaggRefreshStats *stats, CaggRefreshPhase phase, TimestampTz now)
+{
+	int64 elapsed = now - stats->phase_start;
+
+	switch (stats->phase)
+	{
+		case CAGG_REFRESH_PHASE_INVALIDATION:
+			stats->counters.invalidation_time += elapsed;
+			break;
+		case CAGG_REFRESH_PHASE_DELETE:
+			stats->counters.delete_time += elapsed;
+			break;
+		case CAGG_REFRESH_PHASE_INSERT:
+			stats->counters.insert_time += elapsed;
+			break;
+		case CAGG_REFRESH_PHASE_WATERMARK:
+			stats->counters.watermark_time += elapsed;
+			break;
+		case CAGG_REFRESH_PHASE_NONE:
+		case CAGG_REFRESH_PHASE_CASCADE:
+			break;
+	}
+
+	stats->phase = phase;
+	stats->phase_start = now;
+}
+
+/*
+ * Finish a refresh and add its statistics to the totals of the continuous
+ * aggregate.
+ */
+void
+ts_cagg_refresh_stats_end(CaggRefreshStats *stats, bool failed)
+{
+	CaggRefreshStatsShared *shared = cagg_refresh_stats_get_shared();
+	TimestampTz now = GetCurrentTimestamp();
+
+	Assert(current_refresh == stats);
+	current_refresh = stats->parent;
+
+	cagg_refresh_stats_switch_phase(stats, CAGG_REFRESH_PHASE_NONE, now);
+	stats->counters.total_time = now - stats->start;
+
+	if (shared == NULL || stats->shared == NULL)
+		return;
+
+	LWLockAcquire(shared->lock, LW_EXCLUSIVE);
+
+	/*
+	 * The entry might have been evicted if a concurrent refresh of the same
+	 * continuous aggregate took it over and finished first
+	 */
+	if (stats->shared->database_id == MyDatabaseId &&
+		stats->shared->mat_hypertable_id == stats->mat_hypertable_id)
+	{
+		if (failed)
+			stats->shared->failed_refreshes++;
+		else
+			stats->shared->refreshes++;
+
+		cagg_refresh_counters_add(&stats->shared->total, &stats->counters);
+		stats->shared->last = stats->counters;
+		stats->shared->last_start = stats->start;
+
+		if (stats->shared->pid == MyProcPid)
+			stats->shared->pid = 0;
+	}
+
+	LWLockRelease(shared->lock);
+}
+
+/*
+ * Move the refresh in progress to a new phase.
+ */
+void
+ts_cagg_refresh_stats_set_phase(CaggRefreshPhase phase)
+{
+	if (current_refresh == NULL || current_refresh->phase == phase)
+		return;
+
+	cagg_refresh_stats_switch_phase(current_refresh, phase, GetCurrentTimestamp());
+	cagg_refresh_stats_publish(current_refresh);
+}
+
+/*
+ * Get the counters of the refresh in progress, or NULL if there is none.
+ */
+CaggRefreshCounters *
+ts_cagg_refresh_stats_counters(void)
+{
+	return current_refresh == NULL ? NULL : &current_refresh->counters;
+}
+
+static Datum
+microseconds_to_interval(int64 microseconds)
+{
+	Interval *interval = palloc0(sizeof(Interval));
+
+	interval->time = microseconds;
+
+	return IntervalPGetDatum(interval);
+}
+
+static HeapTuple
+cagg_refresh_stats_make_tuple(TupleDesc tupdesc, const CaggRefreshStatsSharedEntry *entry)
+{
+	Datum values[Natts_cagg_refresh_stats] = { 0 };
+	bool nulls[Natts_cagg_refresh_stats] = { false };
+	bool has_refreshed = entry->refreshes + entry->failed_refreshes > 0;
+	/* The backend might have exited in the middle of a refresh */
+	bool running = entry->pid != 0 && BackendPidGetProc(entry->pid) != NULL;
+
+	values[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_mat_hypertable_id)] =
+		Int32GetDatum(entry->mat_hypertable_id);
+	values[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_refreshes)] =
+		Int64GetDatum(entry->refreshes);
+	values[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_failed_refreshes)] =
+		Int64GetDatum(entry->failed_refreshes);
+
+	if (has_refreshed)
+	{
+		values[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_last_refresh_start)] =
+			TimestampTzGetDatum(entry->last_start);
+		values[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_last_refresh_duration)] =
+			microseconds_to_interval(entry->last.total_time);
+		values[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_last_ranges_refreshed)] =
+			Int64GetDatum(entry->last.ranges);
+		values[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_last_rows_deleted)] =
+			Int64GetDatum(entry->last.rows_deleted);
+		values[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_last_rows_inserted)] =
+			Int64GetDatum(entry->last.rows_inserted);
+	}
+	else
+	{
+		nulls[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_last_refresh_start)] = true;
+		nulls[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_last_refresh_duration)] = true;
+		nulls[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_last_ranges_refreshed)] = true;
+		nulls[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_last_rows_deleted)] = true;
+		nulls[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_last_rows_inserted)] = true;
+	}
+
+	values[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_total_refresh_duration)] =
+		microseconds_to_interval(entry->total.total_time);
+	values[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_ranges_refreshed)] =
+		Int64GetDatum(entry->total.ranges);
+	values[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_rows_deleted)] =
+		Int64GetDatum(entry->total.rows_deleted);
+	values[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_rows_inserted)] =
+		Int64GetDatum(entry->total.rows_inserted);
+	values[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_raw_rows_read)] =
+		Int64GetDatum(entry->total.raw_rows_read);
+	values[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_compressed_batches_read)] =
+		Int64GetDatum(entry->total.compressed_batches_read);
+	values[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_invalidation_duration)] =
+		microseconds_to_interval(entry->total.invalidation_time);
+	values[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_delete_duration)] =
+		microseconds_to_interval(entry->total.delete_time);
+	values[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_insert_duration)] =
+		microseconds_to_interval(entry->total.insert_time);
+	values[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_watermark_duration)] =
+		microseconds_to_interval(entry->total.watermark_time);
+
+	if (running)
+	{
+		int phase = entry->phase;
+
+		values[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_running_pid)] =
+			Int32GetDatum(entry->pid);
+
+		if (phase >= 0 && phase < (int) lengthof(phase_names))
+			values[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_running_phase)] =
+				CStringGetTextDatum(phase_names[phase]);
+		else
+			nulls[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_running_phase)] = true;
+
+		values[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_running_since)] =
+			TimestampTzGetDatum(entry->start);
+		values[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_running_phase_since)] =
+			TimestampTzGetDatum(entry->phase_start);
+		values[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_running_ranges_refreshed)] =
+			Int64GetDatum(entry->current.ranges);
+		values[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_running_rows_inserted)] =
+			Int64GetDatum(entry->current.rows_inserted);
+	}
+	else
+	{
+		nulls[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_running_pid)] = true;
+		nulls[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_running_phase)] = true;
+		nulls[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_running_since)] = true;
+		nulls[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_running_phase_since)] = true;
+		nulls[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_running_ranges_refreshed)] = true;
+		nulls[AttrNumberGetAttrOffset(Anum_cagg_refresh_stats_running_rows_inserted)] = true;
+	}
+
+	return heap_form_tuple(tupdesc, values, nulls);
+}
+
+TS_FUNCTION_INFO_V1(ts_cagg_refresh_stats);
+
+/*
+ * Return the refresh statistics of the continuous aggregates in the current
+ * database.
+ *
+ * The entries are copied on the first call so that the result is consistent
+ * even if refreshes finish while it is returned.
+ */
+Datum
+ts_cagg_refresh_stats(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	CaggRefreshStatsSharedEntry *entries;
+	HeapTuple tuple;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		CaggRefreshStatsShared *shared = cagg_refresh_stats_get_shared();
+		MemoryContext oldcontext;
+		TupleDesc tupdesc;
+		int num_entries = 0;
+		int i;
+
+		funcctx = SRF_FIRSTCALL_INIT();
+		oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("function returning record called in context "
+							"that cannot accept type record")));
+
+		funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+		entries = palloc(sizeof(CaggRefreshStatsSharedEntry) * CAGG_REFRESH_STATS_MAX_ENTRIES);
+
+		if (shared != NULL)
+		{
+			LWLockAcquire(shared->lock, LW_SHARED);
+
+			for (i = 0; i < CAGG_REFRESH_STATS_MAX_ENTRIES; i++)
+			{
+				if (shared->entries[i].database_id == MyDatabaseId)
+					entries[num_entries++] = shared->entries[i];
+			}
+
+			LWLockRelease(shared->lock);
+		}
+
+		funcctx->user_fctx = entries;
+		funcctx->max_calls = num_entries;
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	entries = funcctx->user_fctx;
+
+	if (funcctx->call_cntr >= funcctx->max_calls)
+		SRF_RETURN_DONE(funcctx);
+
+	tuple = cagg_refresh_stats_make_tuple(funcctx->tuple_desc, &entries[funcctx->call_cntr]);
+
+	SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+}
@@ -0,0 +1,48 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#ifndef TIMESCALEDB_CAGG_REFRESH_STATS_H
+#define TIMESCALEDB_CAGG_REFRESH_STATS_H
+
+#include <postgres.h>
+#include <datatype/timestamp.h>
+
+#include "export.h"
+#include "loader/cagg_refresh_stats.h"
+
+typedef enum CaggRefreshPhase
+{
+	CAGG_REFRESH_PHASE_NONE = 0,
+	CAGG_REFRESH_PHASE_INVALIDATION,
+	CAGG_REFRESH_PHASE_DELETE,
+	CAGG_REFRESH_PHASE_INSERT,
+	CAGG_REFRESH_PHASE_WATERMARK,
+	CAGG_REFRESH_PHASE_CASCADE,
+} CaggRefreshPhase;
+
+/*
+ * Statistics of a refresh in progress in this backend.
+ *
+ * Refreshes can be nested when refreshing dependent continuous aggregates,
+ * in which case the statistics are kept for the innermost refresh.
+ */
+typedef struct CaggRefreshStats
+{
+	int32 mat_hypertable_id;
+	CaggRefreshPhase phase;
+	TimestampTz start;
+	TimestampTz phase_start;
+	CaggRefreshCounters counters;
+	CaggRefreshStatsSharedEntry *shared;
+	struct CaggRefreshStats *parent;
+} CaggRefreshStats;
+
+extern TSDLLEXPORT void ts_cagg_refresh_stats_begin(CaggRefreshStats *stats,
+													int32 mat_hypertable_id);
+extern TSDLLEXPORT void ts_cagg_refresh_stats_end(CaggRefreshStats *stats, bool failed);
+extern TSDLLEXPORT void ts_cagg_refresh_stats_set_phase(CaggRefreshPhase phase);
+extern TSDLLEXPORT CaggRefreshCounters *ts_cagg_refresh_stats_counters(void);
+
+#endif /* TIMESCALEDB_CAGG_REFRESH_STATS_H */
@@ -41,6 +41,7 @@
 #include "chunk.h"
 
 #include "bgw_policy/chunk_stats.h"
+#include "bgw_policy/policy.h"
 #include "cache.h"
 #include "chunk_index.h"
 #include "chunk_scan.h"
@@ -760,6 +761,13 @@ ts_chunk_create_table(const Chunk *chunk, const Hypertable *ht, const char *tabl
 
 	rel = table_open(ht->main_table_relid, AccessShareLock);
 
+	/*
+	 * Chunks of hypertables with a staging policy skip WAL until the policy
+	 * merges them
+	 */
+	if (chunk->relkind == RELKIND_RELATION && ts_bgw_policy_staging_exists(ht->fd.id))
+		stmt.base.relation->relpersistence = RELPERSISTENCE_UNLOGGED;
+
 	/*
 	 * If the chunk is created in the internal schema, become the catalog
 	 * owner, otherwise become the hypertable owner
@@ -1528,7 +1536,7 @@ ts_chunk_create_for_point(const Hypertable *ht, const Point *p, bool *found, con
  * Returns a list of matching chunk ids.
  */
 List *
-ts_chunk_id_find_in_subspace(Hypertable *ht, List *dimension_vecs)
+ts_chunk_id_find_in_subspace(Hypertable *ht, List *dimension_vecs, int64 *num_examined)
 {
 	List *chunk_ids = NIL;
 
@@ -1594,6 +1602,10 @@ ts_chunk_id_find_in_subspace(Hypertable *ht, List *dimension_vecs)
 
 	ts_scan_iterator_close(&iterator);
 
+	/* Every chunk with a slice matching some dimension was looked at */
+	if (num_examined != NULL)
+		*num_examined += hash_get_num_entries(ctx.htab);
+
 	chunk_scan_ctx_destroy(&ctx);
 
 	return chunk_ids;
@@ -4578,6 +4590,24 @@ ts_chunk_scan_iterator_set_chunk_id(ScanIterator *it, int32 chunk_id)
 								   Int32GetDatum(chunk_id));
 }
 
+/*
+ * Scan for multiple chunks in one index pass. The chunks are returned in
+ * chunk ID order.
+ */
+void
+ts_chunk_scan_iterator_set_chunk_ids(ScanIterator *it, const Datum *chunk_ids, int num_chunk_ids)
+{
+	it->ctx.index = catalog_get_index(ts_catalog_get(), CHUNK, CHUNK_ID_INDEX);
+	ts_scan_iterator_scan_key_reset(it);
+	ts_scan_iterator_scan_key_init_array(it,
+										 Anum_chunk_idx_id,
+										 BTEqualStrategyNumber,
+										 F_INT4EQ,
+										 INT4OID,
+										 chunk_ids,
+										 num_chunk_ids);
+}
+
 #include "hypercube.h"
 static Hypercube *
 fill_hypercube_for_foreign_table_chunk(Hyperspace *hs)
@@ -10,6 +10,7 @@
 #include <catalog/indexing.h>
 #include <catalog/objectaddress.h>
 #include <catalog/pg_constraint.h>
+#include <catalog/pg_type.h>
 #include <catalog/heap.h>
 #include <commands/tablecmds.h>
 #include <funcapi.h>
@@ -556,6 +557,27 @@ ts_chunk_constraint_scan_iterator_set_chunk_id(ScanIterator *it, int32 chunk_id)
 								   Int32GetDatum(chunk_id));
 }
 
+/*
+ * Scan for the constraints of multiple chunks in one index pass. The
+ * constraints are returned in chunk ID order.
+ */
+void
+ts_chunk_constraint_scan_iterator_set_chunk_ids(ScanIterator *it, const Datum *chunk_ids,
+												int num_chunk_ids)
+{
+	it->ctx.index = catalog_get_index(ts_catalog_get(),
+									  CHUNK_CONSTRAINT,
+									  CHUNK_CONSTRAINT_CHUNK_ID_CONSTRAINT_NAME_IDX);
+	ts_scan_iterator_scan_key_reset(it);
+	ts_scan_iterator_scan_key_init_array(it,
+										 Anum_chunk_constraint_chunk_id_constraint_name_idx_chunk_id,
+										 BTEqualStrategyNumber,
+										 F_INT4EQ,
+										 INT4OID,
+										 chunk_ids,
+										 num_chunk_ids);
+}
+
 static void
 init_scan_by_chunk_id_constraint_name(ScanIterator *iterator, int32 chunk_id,
 									  const char *constraint_name)
@@ -41,8 +41,9 @@ ts_chunk_constraint_scan_by_chunk_id(int32 chunk_id, Size num_constraints_hint,
 extern ChunkConstraints *ts_chunk_constraints_copy(ChunkConstraints *chunk_constraints);
 extern int ts_chunk_constraint_scan_by_dimension_slice(const DimensionSlice *slice,
 													   ChunkScanCtx *ctx, MemoryContext mctx);
-extern int ts_chunk_constraint_scan_by_dimension_slice_to_list(const DimensionSlice *slice,
-															   List **list, MemoryContext mctx);
+extern TSDLLEXPORT int
+ts_chunk_constraint_scan_by_dimension_slice_to_list(const DimensionSlice *slice, List **list,
+													MemoryContext mctx);
 extern int ts_chunk_constraint_scan_by_dimension_slice_id(int32 dimension_slice_id,
 														  ChunkConstraints *ccs,
 														  MemoryContext mctx);
@@ -89,5 +90,8 @@ extern ChunkConstraint *ts_chunk_constraints_add_from_tuple(ChunkConstraints *cc
 extern ScanIterator ts_chunk_constraint_scan_iterator_create(MemoryContext result_mcxt);
 extern void ts_chunk_constraint_scan_iterator_set_slice_id(ScanIterator *it, int32 slice_id);
 extern void ts_chunk_constraint_scan_iterator_set_chunk_id(ScanIterator *it, int32 chunk_id);
+extern void ts_chunk_constraint_scan_iterator_set_chunk_ids(ScanIterator *it,
+															const Datum *chunk_ids,
+															int num_chunk_ids);
 
 #endif /* TIMESCALEDB_CHUNK_CONSTRAINT_H */
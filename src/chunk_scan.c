@@ -9,6 +9,7 @@
 #include <utils/syscache.h>
 #include <utils/builtins.h>
 
+#include "debug_assert.h"
 #include "debug_point.h"
 #include "dimension_vector.h"
 #include "guc.h"
@@ -21,6 +22,41 @@
 #include "ts_catalog/chunk_data_node.h"
 #include "utils.h"
 
+/*
+ * Position of a chunk ID in the list of chunk IDs to scan for. Batched scans
+ * return chunks in chunk ID order, so this is used to map the scanned chunks
+ * back to the order of the list.
+ */
+typedef struct ChunkIdPosition
+{
+	int32 chunk_id;
+	int position;
+} ChunkIdPosition;
+
+static int
+chunk_id_position_cmp(const void *left, const void *right)
+{
+	const ChunkIdPosition *lhs = left;
+	const ChunkIdPosition *rhs = right;
+
+	if (lhs->chunk_id != rhs->chunk_id)
+		return lhs->chunk_id < rhs->chunk_id ? -1 : 1;
+
+	return lhs->position - rhs->position;
+}
+
+static int
+chunk_id_cmp(const void *left, const void *right)
+{
+	const Chunk *lhs = *((const Chunk **) left);
+	const Chunk *rhs = *((const Chunk **) right);
+
+	if (lhs->fd.id == rhs->fd.id)
+		return 0;
+
+	return lhs->fd.id < rhs->fd.id ? -1 : 1;
+}
+
 /*
  * Scan for chunks matching a query.
  *
@@ -37,6 +73,8 @@
  * For performance, try not to interleave scans of different metadata tables
  * in order to maintain data locality while scanning. Also, keep scanned
  * tables and indexes open until all the metadata is scanned for all chunks.
+ * The chunk metadata and the chunk constraints are fetched for all chunks in
+ * a single index pass each. The chunk IDs must be unique.
  */
 Chunk **
 ts_chunk_scan_by_chunk_ids(const Hyperspace *hs, const List *chunk_ids, unsigned int *num_chunks)
@@ -48,64 +86,112 @@ ts_chunk_scan_by_chunk_ids(const Hyperspace *hs, const List *chunk_ids, unsigned
 	MemoryContext orig_mcxt;
 	Chunk **locked_chunks = NULL;
 	Chunk **unlocked_chunks = NULL;
+	Chunk **scanned_chunks;
+	ChunkIdPosition *positions;
+	Datum *ids;
+	int num_chunk_ids = list_length(chunk_ids);
 	int locked_chunk_count = 0;
 	int unlocked_chunk_count = 0;
+	int position_index = 0;
 	ListCell *lc;
 	int remote_chunk_count = 0;
 
 	Assert(OidIsValid(hs->main_table_relid));
 	orig_mcxt = MemoryContextSwitchTo(work_mcxt);
 
+	if (num_chunk_ids == 0)
+	{
+		MemoryContextSwitchTo(orig_mcxt);
+		MemoryContextDelete(work_mcxt);
+		*num_chunks = 0;
+		return NULL;
+	}
+
+	positions = palloc(sizeof(ChunkIdPosition) * num_chunk_ids);
+	ids = palloc(sizeof(Datum) * num_chunk_ids);
+	scanned_chunks = palloc0(sizeof(Chunk *) * num_chunk_ids);
+
+	int i = 0;
+	foreach (lc, chunk_ids)
+	{
+		positions[i].chunk_id = lfirst_int(lc);
+		positions[i].position = i;
+		ids[i] = Int32GetDatum(lfirst_int(lc));
+		i++;
+	}
+
+	qsort(positions, num_chunk_ids, sizeof(ChunkIdPosition), chunk_id_position_cmp);
+
+	/* A chunk is returned only once by the batched scan */
+	for (i = 1; i < num_chunk_ids; i++)
+		Ensure(positions[i - 1].chunk_id != positions[i].chunk_id,
+			   "duplicate chunk ID %d in chunk scan",
+			   positions[i].chunk_id);
+
 	/*
 	 * For each matching chunk, fill in the metadata from the "chunk" table.
 	 * Make sure to filter out "dropped" chunks.
 	 */
 	ScanIterator chunk_it = ts_chunk_scan_iterator_create(orig_mcxt);
-	unlocked_chunks = MemoryContextAlloc(work_mcxt, sizeof(Chunk *) * list_length(chunk_ids));
-	foreach (lc, chunk_ids)
+	ts_chunk_scan_iterator_set_chunk_ids(&chunk_it, ids, num_chunk_ids);
+	ts_scan_iterator_start_scan(&chunk_it);
+
+	while (ts_scan_iterator_next(&chunk_it) != NULL)
 	{
-		int chunk_id = lfirst_int(lc);
-		TupleInfo *ti;
+		TupleInfo *ti = ts_scan_iterator_tuple_info(&chunk_it);
+		bool isnull;
+		Datum datum = slot_getattr(ti->slot, Anum_chunk_id, &isnull);
+		int32 chunk_id = DatumGetInt32(datum);
+		bool is_dropped;
 
 		Assert(CurrentMemoryContext == work_mcxt);
+		Assert(!isnull);
 
-		ts_chunk_scan_iterator_set_chunk_id(&chunk_it, chunk_id);
-		ts_scan_iterator_start_or_restart_scan(&chunk_it);
-		ti = ts_scan_iterator_next(&chunk_it);
+		/* Chunks are returned in chunk ID order */
+		while (position_index < num_chunk_ids && positions[position_index].chunk_id < chunk_id)
+			position_index++;
 
-		if (ti)
-		{
-			bool isnull;
-			Datum datum = slot_getattr(ti->slot, Anum_chunk_dropped, &isnull);
-			bool is_dropped = isnull ? false : DatumGetBool(datum);
+		Assert(position_index < num_chunk_ids &&
+			   positions[position_index].chunk_id == chunk_id);
 
-			MemoryContextSwitchTo(per_tuple_mcxt);
-			MemoryContextReset(per_tuple_mcxt);
+		datum = slot_getattr(ti->slot, Anum_chunk_dropped, &isnull);
+		is_dropped = isnull ? false : DatumGetBool(datum);
 
-			if (!is_dropped)
-			{
-				Chunk *chunk = MemoryContextAllocZero(orig_mcxt, sizeof(Chunk));
+		MemoryContextSwitchTo(per_tuple_mcxt);
+		MemoryContextReset(per_tuple_mcxt);
 
-				MemoryContext old_mcxt = MemoryContextSwitchTo(ti->mctx);
-				ts_chunk_formdata_fill(&chunk->fd, ti);
-				MemoryContextSwitchTo(old_mcxt);
+		if (!is_dropped)
+		{
+			Chunk *chunk = MemoryContextAllocZero(orig_mcxt, sizeof(Chunk));
 
-				chunk->constraints = NULL;
-				chunk->cube = NULL;
-				chunk->hypertable_relid = hs->main_table_relid;
+			MemoryContext old_mcxt = MemoryContextSwitchTo(ti->mctx);
+			ts_chunk_formdata_fill(&chunk->fd, ti);
+			MemoryContextSwitchTo(old_mcxt);
 
-				unlocked_chunks[unlocked_chunk_count] = chunk;
-				unlocked_chunk_count++;
-			}
+			chunk->constraints = NULL;
+			chunk->cube = NULL;
+			chunk->hypertable_relid = hs->main_table_relid;
 
-			MemoryContextSwitchTo(work_mcxt);
-			/* Only one chunk should match */
-			Assert(ts_scan_iterator_next(&chunk_it) == NULL);
+			scanned_chunks[positions[position_index].position] = chunk;
 		}
+
+		MemoryContextSwitchTo(work_mcxt);
 	}
 
 	ts_scan_iterator_close(&chunk_it);
 
+	/*
+	 * Keep the chunks in the order of the chunk ID list, leaving out the
+	 * chunks that were not found or are dropped.
+	 */
+	unlocked_chunks = scanned_chunks;
+
+	for (i = 0; i < num_chunk_ids; i++)
+	{
+		if (scanned_chunks[i] != NULL)
+			unlocked_chunks[unlocked_chunk_count++] = scanned_chunks[i];
+	}
+
 	Assert(unlocked_chunk_count == 0 || unlocked_chunks != NULL);
 	Assert(unlocked_chunk_count <= list_length(chunk_ids));
 	Assert(CurrentMemoryContext == work_mcxt);
@@ -163,27 +249,51 @@ ts_chunk_scan_by_chunk_ids(const Hyperspace *hs, const List *chunk_ids, unsigned
 	}
 
 	/*
-	 * Fetch the chunk constraints.
+	 * Fetch the chunk constraints. The constraints are returned in chunk ID
+	 * order, so walk the chunks in the same order.
 	 */
-	ScanIterator constr_it = ts_chunk_constraint_scan_iterator_create(orig_mcxt);
-
-	for (int i = 0; i < locked_chunk_count; i++)
+	if (locked_chunk_count > 0)
 	{
-		Chunk *chunk = locked_chunks[i];
-		chunk->constraints = ts_chunk_constraints_alloc(/* size_hint = */ 0, orig_mcxt);
+		Chunk **chunks_by_id = palloc(sizeof(Chunk *) * locked_chunk_count);
+		int chunk_index = 0;
+
+		for (int i = 0; i < locked_chunk_count; i++)
+		{
+			Chunk *chunk = locked_chunks[i];
+
+			chunk->constraints = ts_chunk_constraints_alloc(/* size_hint = */ 0, orig_mcxt);
+			chunks_by_id[i] = chunk;
+			ids[i] = Int32GetDatum(chunk->fd.id);
+		}
 
-		ts_chunk_constraint_scan_iterator_set_chunk_id(&constr_it, chunk->fd.id);
-		ts_scan_iterator_start_or_restart_scan(&constr_it);
+		qsort(chunks_by_id, locked_chunk_count, sizeof(Chunk *), chunk_id_cmp);
+
+		ScanIterator constr_it = ts_chunk_constraint_scan_iterator_create(orig_mcxt);
+		ts_chunk_constraint_scan_iterator_set_chunk_ids(&constr_it, ids, locked_chunk_count);
+		ts_scan_iterator_start_scan(&constr_it);
 
 		while (ts_scan_iterator_next(&constr_it) != NULL)
 		{
 			TupleInfo *constr_ti = ts_scan_iterator_tuple_info(&constr_it);
+			bool isnull;
+			Datum datum = slot_getattr(constr_ti->slot, Anum_chunk_constraint_chunk_id, &isnull);
+			int32 chunk_id = DatumGetInt32(datum);
+
+			Assert(!isnull);
+
+			while (chunk_index < locked_chunk_count && chunks_by_id[chunk_index]->fd.id < chunk_id)
+				chunk_index++;
+
+			Assert(chunk_index < locked_chunk_count &&
+				   chunks_by_id[chunk_index]->fd.id == chunk_id);
+
 			MemoryContextSwitchTo(per_tuple_mcxt);
-			ts_chunk_constraints_add_from_tuple(chunk->constraints, constr_ti);
+			ts_chunk_constraints_add_from_tuple(chunks_by_id[chunk_index]->constraints, constr_ti);
 			MemoryContextSwitchTo(work_mcxt);
 		}
+
+		ts_scan_iterator_close(&constr_it);
 	}
-	ts_scan_iterator_close(&constr_it);
 
 	/*
 	 * Build hypercubes for the chunks by finding and combining the dimension
@@ -34,10 +34,13 @@
 #include <access/xact.h>
 #include <catalog/pg_trigger_d.h>
 #include <commands/copy.h>
+#include <commands/defrem.h>
 #include <commands/tablecmds.h>
 #include <commands/trigger.h>
 #include <executor/executor.h>
 #include <executor/nodeModifyTable.h>
+#include <libpq/pqformat.h>
+#include <libpq/pqmq.h>
 #include <miscadmin.h>
 #include <nodes/makefuncs.h>
 #include <optimizer/optimizer.h>
@@ -45,8 +48,18 @@
 #include <parser/parse_collate.h>
 #include <parser/parse_expr.h>
 #include <parser/parse_relation.h>
+#include <pgstat.h>
+#include <port/atomics.h>
+#include <postmaster/bgworker.h>
+#include <rewrite/rewriteHandler.h>
 #include <storage/bufmgr.h>
+#include <storage/dsm.h>
+#include <storage/latch.h>
+#include <storage/proc.h>
+#include <storage/shm_mq.h>
+#include <storage/shm_toc.h>
 #include <storage/smgr.h>
+#include <tcop/tcopprot.h>
 #include <utils/builtins.h>
 #include <utils/elog.h>
 #include <utils/guc.h>
@@ -54,12 +67,20 @@
 #include <utils/lsyscache.h>
 #include <utils/rel.h>
 #include <utils/rls.h>
+#include <utils/snapmgr.h>
 
 #include "compat/compat.h"
 #include "copy.h"
 #include "cross_module_fn.h"
 #include "dimension.h"
+#include "dimension_slice.h"
+#include "export.h"
+#include "extension.h"
+#include "guc.h"
 #include "hypertable.h"
+#include "hypertable_cache.h"
+#include "insert_stats.h"
+#include "license_guc.h"
 #include "nodes/chunk_dispatch/chunk_dispatch.h"
 #include "nodes/chunk_dispatch/chunk_insert_state.h"
 #include "subspace_store.h"
@@ -69,24 +90,27 @@
 #endif
 
 /*
- * No more than this many tuples per TSCopyMultiInsertBuffer
- *
- * Caution: Don't make this too big, as we could end up with this many
- * TSCopyMultiInsertBuffer items stored in TSCopyMultiInsertInfo's
- * multiInsertBuffers list.  Increasing this can cause quadratic growth in
- * memory requirements during copies into partitioned tables with a large
- * number of partitions.
+ * Number of tuples a new TSCopyMultiInsertBuffer can hold before it is
+ * flushed. Buffers that fill up are grown up to MAX_BUFFERED_TUPLES, as long
+ * as that many tuples of the observed width and their slots fit into half of
+ * the memory budget (timescaledb.copy_buffer_memory).
  */
-#define MAX_BUFFERED_TUPLES 1000
+#define INITIAL_BUFFERED_TUPLES 1000
+#define MAX_BUFFERED_TUPLES 10000
 
 /*
- * Flush buffers if there are >= this many bytes, as counted by the input
- * size, of tuples stored.
+ * Trim the list of buffers back down to the number of buffers that can each
+ * hold MIN_BUFFER_BATCH tuples of the observed width, with their slots,
+ * within the memory budget, but to at most MAX_PARTITION_BUFFERS.
  */
-#define MAX_BUFFERED_BYTES 65535
-
-/* Trim the list of buffers back down to this number after flushing */
 #define MAX_PARTITION_BUFFERS 32
+#define MIN_BUFFER_BATCH 64
+
+/* Tuple width assumed until the width of buffered tuples is known */
+#define DEFAULT_TUPLE_WIDTH 100
+
+/* Memory of an entry of the slot and line number arrays of a buffer */
+#define BUFFER_ENTRY_SIZE (sizeof(TupleTableSlot *) + sizeof(uint64))
 
 /* Stores multi-insert data related to a single relation in CopyFrom. */
 typedef struct TSCopyMultiInsertBuffer
@@ -97,12 +121,16 @@ typedef struct TSCopyMultiInsertBuffer
 	 * not needed and is wasting a lot of CPU in ResourceOwner.
 	 */
 	TupleDesc tupdesc;
-	TupleTableSlot *slots[MAX_BUFFERED_TUPLES]; /* Array to store tuples */
-	Point *point;								/* The point in space of this buffer */
-	BulkInsertState bistate;					/* BulkInsertState for this buffer */
-	int nused;									/* number of 'slots' containing tuples */
-	uint64 linenos[MAX_BUFFERED_TUPLES];		/* Line # of tuple in copy
-												 * stream */
+	TupleTableSlot **slots;	 /* Array to store tuples */
+	uint64 *linenos;		 /* Line # of tuple in copy stream */
+	int capacity;			 /* Number of tuples the buffer can hold */
+	int nused;				 /* number of 'slots' containing tuples */
+	int bytes;				 /* number of bytes of the tuples in 'slots' */
+	Size overhead;			 /* memory of the buffer besides the tuples */
+	uint64 last_used;		 /* Tuples stored in all buffers when last used */
+	int32 chunk_id;			 /* The chunk of this buffer */
+	Point *point;			 /* The point in space of this buffer */
+	BulkInsertState bistate; /* BulkInsertState for this buffer */
 } TSCopyMultiInsertBuffer;
 
 /*
@@ -123,6 +151,12 @@ typedef struct TSCopyMultiInsertInfo
 								 TSCopyMultiInsertBuffer) */
 	int bufferedTuples;		  /* number of tuples buffered over all buffers */
 	int bufferedBytes;		  /* number of bytes from all buffered tuples */
+	Size overheadBytes;		  /* memory of all buffers besides the tuples */
+	Size budget;			  /* Memory budget for the buffers */
+	uint64 storedTuples;	  /* number of tuples stored in the buffers */
+	uint64 storedBytes;		  /* number of bytes of all stored tuples */
+	uint64 flushes;			  /* number of buffer flushes */
+	uint64 flushedTuples;	  /* number of tuples written by buffer flushes */
 	CopyChunkState *ccstate;  /* Copy chunk state for this TSCopyMultiInsertInfo */
 	EState *estate;			  /* Executor state used for COPY */
 	CommandId mycid;		  /* Command Id used for COPY */
@@ -177,6 +211,7 @@ copy_chunk_state_create(Hypertable *ht, Relation rel, CopyFromFunc from_func, Co
 	ccstate->dispatch = ts_chunk_dispatch_create(ht, estate, 0);
 	ccstate->cstate = cstate;
 	ccstate->scandesc = scandesc;
+	ccstate->block = NULL;
 	ccstate->next_copy_from = from_func;
 	ccstate->where_clause = NULL;
 
@@ -188,14 +223,19 @@ copy_chunk_state_create(Hypertable *ht, Relation rel, CopyFromFunc from_func, Co
  * ResultRelInfo.
  */
 static TSCopyMultiInsertBuffer *
-TSCopyMultiInsertBufferInit(ChunkInsertState *cis, Point *point)
+TSCopyMultiInsertBufferInit(TSCopyMultiInsertInfo *miinfo, ChunkInsertState *cis, Point *point)
 {
 	TSCopyMultiInsertBuffer *buffer;
 
 	buffer = (TSCopyMultiInsertBuffer *) palloc(sizeof(TSCopyMultiInsertBuffer));
-	memset(buffer->slots, 0, sizeof(TupleTableSlot *) * MAX_BUFFERED_TUPLES);
+	buffer->capacity = INITIAL_BUFFERED_TUPLES;
+	buffer->slots = palloc0(sizeof(TupleTableSlot *) * buffer->capacity);
+	buffer->linenos = palloc(sizeof(uint64) * buffer->capacity);
 	buffer->bistate = GetBulkInsertState();
 	buffer->nused = 0;
+	buffer->bytes = 0;
+	buffer->last_used = 0;
+	buffer->chunk_id = cis->chunk_id;
 
 	buffer->point = palloc(POINT_SIZE(point->num_coords));
 	memcpy(buffer->point, point, POINT_SIZE(point->num_coords));
@@ -211,6 +251,10 @@ TSCopyMultiInsertBufferInit(ChunkInsertState *cis, Point *point)
 	buffer->tupdesc = CreateTupleDescCopyConstr(cis->rel->rd_att);
 	Assert(buffer->tupdesc->tdrefcount == -1);
 
+	buffer->overhead = sizeof(TSCopyMultiInsertBuffer) + sizeof(BulkInsertStateData) +
+					   TupleDescSize(buffer->tupdesc) + buffer->capacity * BUFFER_ENTRY_SIZE;
+	miinfo->overheadBytes += buffer->overhead;
+
 	return buffer;
 }
 
@@ -235,7 +279,7 @@ TSCopyMultiInsertInfoGetOrSetupBuffer(TSCopyMultiInsertInfo *miinfo, ChunkInsert
 	/* No insert buffer for this chunk exists, create a new one */
 	if (!found)
 	{
-		entry->buffer = TSCopyMultiInsertBufferInit(cis, point);
+		entry->buffer = TSCopyMultiInsertBufferInit(miinfo, cis, point);
 	}
 
 	return entry->buffer;
@@ -267,6 +311,12 @@ TSCopyMultiInsertInfoInit(TSCopyMultiInsertInfo *miinfo, ResultRelInfo *rri,
 	miinfo->multiInsertBuffers = TSCopyCreateNewInsertBufferHashMap();
 	miinfo->bufferedTuples = 0;
 	miinfo->bufferedBytes = 0;
+	miinfo->overheadBytes = 0;
+	miinfo->budget = (Size) ts_guc_copy_buffer_memory * 1024L;
+	miinfo->storedTuples = 0;
+	miinfo->storedBytes = 0;
+	miinfo->flushes = 0;
+	miinfo->flushedTuples = 0;
 	miinfo->ccstate = ccstate;
 	miinfo->estate = estate;
 	miinfo->mycid = mycid;
@@ -275,16 +325,96 @@ TSCopyMultiInsertInfoInit(TSCopyMultiInsertInfo *miinfo, ResultRelInfo *rri,
 }
 
 /*
- * Returns true if the buffers are full.
+ * Memory used by the buffers, i.e., the buffered tuples, the slots and the
+ * arrays that hold them.
+ */
+static inline Size
+TSCopyMultiInsertInfoMemory(TSCopyMultiInsertInfo *miinfo)
+{
+	return miinfo->bufferedBytes + miinfo->overheadBytes;
+}
+
+/*
+ * Returns true if the buffers exceed the memory budget.
  */
 static inline bool
 TSCopyMultiInsertInfoIsFull(TSCopyMultiInsertInfo *miinfo)
 {
-	if (miinfo->bufferedTuples >= MAX_BUFFERED_TUPLES ||
-		miinfo->bufferedBytes >= MAX_BUFFERED_BYTES)
-		return true;
+	return TSCopyMultiInsertInfoMemory(miinfo) >= miinfo->budget;
+}
 
-	return false;
+/*
+ * Returns true if the buffer cannot hold more tuples.
+ */
+static inline bool
+TSCopyMultiInsertBufferIsFull(TSCopyMultiInsertBuffer *buffer)
+{
+	return buffer->nused >= buffer->capacity;
+}
+
+/*
+ * Average width of the tuples stored in the buffers so far.
+ */
+static inline double
+TSCopyMultiInsertInfoTupleWidth(TSCopyMultiInsertInfo *miinfo)
+{
+	if (miinfo->storedTuples == 0 || miinfo->storedBytes == 0)
+		return DEFAULT_TUPLE_WIDTH;
+
+	return (double) miinfo->storedBytes / miinfo->storedTuples;
+}
+
+/* Memory of a slot of a buffer besides its tuple */
+static inline Size
+TSCopyMultiInsertSlotSize(TupleDesc tupdesc)
+{
+	return sizeof(BufferHeapTupleTableSlot) + tupdesc->natts * (sizeof(Datum) + sizeof(bool));
+}
+
+/*
+ * Grow a buffer that got full, so that more tuples are written with a single
+ * multi-insert next time. The buffer never holds more tuples of the observed
+ * width, with their slots, than fit into half of the memory budget.
+ */
+static void
+TSCopyMultiInsertBufferGrow(TSCopyMultiInsertInfo *miinfo, TSCopyMultiInsertBuffer *buffer)
+{
+	double max_tuples = (miinfo->budget / 2) / (TSCopyMultiInsertInfoTupleWidth(miinfo) +
+												TSCopyMultiInsertSlotSize(buffer->tupdesc) +
+												BUFFER_ENTRY_SIZE);
+	int capacity = (int) Min(Min(max_tuples, MAX_BUFFERED_TUPLES), buffer->capacity * 2.0);
+	Size growth;
+
+	if (capacity <= buffer->capacity)
+		return;
+
+	buffer->slots = repalloc(buffer->slots, sizeof(TupleTableSlot *) * capacity);
+	memset(buffer->slots + buffer->capacity,
+		   0,
+		   sizeof(TupleTableSlot *) * (capacity - buffer->capacity));
+	buffer->linenos = repalloc(buffer->linenos, sizeof(uint64) * capacity);
+
+	growth = (capacity - buffer->capacity) * BUFFER_ENTRY_SIZE;
+	buffer->overhead += growth;
+	miinfo->overheadBytes += growth;
+	buffer->capacity = capacity;
+}
+
+/*
+ * Number of buffers to keep after flushing. Narrow tuples and a large memory
+ * budget allow for more buffers, up to MAX_PARTITION_BUFFERS, which avoids
+ * dropping and recreating buffers when copying into many chunks at a time.
+ */
+static int
+TSCopyMultiInsertInfoMaxBuffers(TSCopyMultiInsertInfo *miinfo)
+{
+	TupleDesc tupdesc = RelationGetDescr(miinfo->ccstate->rel);
+	double buffer_size = INITIAL_BUFFERED_TUPLES * BUFFER_ENTRY_SIZE +
+						 MIN_BUFFER_BATCH * (TSCopyMultiInsertInfoTupleWidth(miinfo) +
+											 TSCopyMultiInsertSlotSize(tupdesc));
+	double max_buffers = miinfo->budget / buffer_size;
+
+	return (int) Max(Min(max_buffers, MAX_PARTITION_BUFFERS), 1);
 }
 
 /*
@@ -305,6 +435,9 @@ TSCopyMultiInsertBufferFlush(TSCopyMultiInsertInfo *miinfo, TSCopyMultiInsertBuf
 	int nused = buffer->nused;
 	TupleTableSlot **slots = buffer->slots;
 
+	if (nused == 0)
+		return buffer->chunk_id;
+
 	/*
 	 * table_multi_insert and reinitialization of the chunk insert state may
 	 * leak memory, so switch to short-lived memory context before calling it.
@@ -357,6 +490,14 @@ TSCopyMultiInsertBufferFlush(TSCopyMultiInsertInfo *miinfo, TSCopyMultiInsertBuf
 	estate->es_result_relation_info = resultRelInfo;
 #endif
 
+	/*
+	 * Chunks created in this transaction, e.g., by this COPY, have no free
+	 * space from other transactions, so skip checking the FSM like for the
+	 * hypertable itself.
+	 */
+	if (resultRelInfo->ri_RelationDesc->rd_createSubid != InvalidSubTransactionId)
+		ti_options |= HEAP_INSERT_SKIP_FSM;
+
 	table_multi_insert(resultRelInfo->ri_RelationDesc,
 					   slots,
 					   nused,
@@ -377,8 +518,11 @@ TSCopyMultiInsertBufferFlush(TSCopyMultiInsertInfo *miinfo, TSCopyMultiInsertBuf
 		 */
 		if (resultRelInfo->ri_NumIndices > 0)
 		{
+			InsertStats *stats = miinfo->ccstate->dispatch->stats;
 			List *recheckIndexes;
+			instr_time start;
 
+			ts_insert_stats_start(stats, &start);
 			recheckIndexes = ExecInsertIndexTuplesCompat(resultRelInfo,
 														 buffer->slots[i],
 														 estate,
@@ -386,6 +530,7 @@ TSCopyMultiInsertBufferFlush(TSCopyMultiInsertInfo *miinfo, TSCopyMultiInsertBuf
 														 false,
 														 NULL,
 														 NIL);
+			ts_insert_stats_end(stats, INSERT_STAGE_INDEX_INSERT, &start);
 
 			ExecARInsertTriggers(estate,
 								 resultRelInfo,
@@ -414,7 +559,12 @@ TSCopyMultiInsertBufferFlush(TSCopyMultiInsertInfo *miinfo, TSCopyMultiInsertBuf
 	}
 
 	/* Mark that all slots are free */
+	miinfo->bufferedTuples -= nused;
+	miinfo->bufferedBytes -= buffer->bytes;
+	miinfo->flushes++;
+	miinfo->flushedTuples += nused;
 	buffer->nused = 0;
+	buffer->bytes = 0;
 
 	/* Chunk could be closed on a subsequent call of ts_chunk_dispatch_get_chunk_insert_state
 	 * (e.g., due to timescaledb.max_open_chunks_per_insert). So, ensure the bulk insert is
@@ -452,101 +602,177 @@ TSCopyMultiInsertBufferCleanup(TSCopyMultiInsertInfo *miinfo, TSCopyMultiInsertB
 	FreeBulkInsertState(buffer->bistate);
 
 	/* Since we only create slots on demand, just drop the non-null ones. */
-	for (i = 0; i < MAX_BUFFERED_TUPLES && buffer->slots[i] != NULL; i++)
+	for (i = 0; i < buffer->capacity && buffer->slots[i] != NULL; i++)
 		ExecDropSingleTupleTableSlot(buffer->slots[i]);
 
+	pfree(buffer->slots);
+	pfree(buffer->linenos);
 	pfree(buffer->point);
 	FreeTupleDesc(buffer->tupdesc);
+	miinfo->overheadBytes -= buffer->overhead;
 	pfree(buffer);
 }
 
 #if PG13_LT
-/* list_sort comparator to sort TSCopyMultiInsertBuffer by usage */
+/* list_sort comparator to sort TSCopyMultiInsertBuffer by last use */
 static int
-TSCmpBuffersByUsage(const void *a, const void *b)
+TSCmpBuffersByLastUse(const void *a, const void *b)
 {
-	int b1 = ((const TSCopyMultiInsertBuffer *) lfirst(*(ListCell **) a))->nused;
-	int b2 = ((const TSCopyMultiInsertBuffer *) lfirst(*(ListCell **) b))->nused;
-
-	Assert(b1 >= 0);
-	Assert(b2 >= 0);
+	uint64 b1 = ((const TSCopyMultiInsertBuffer *) lfirst(*(ListCell **) a))->last_used;
+	uint64 b2 = ((const TSCopyMultiInsertBuffer *) lfirst(*(ListCell **) b))->last_used;
 
 	return (b1 > b2) ? 1 : (b1 == b2) ? 0 : -1;
 }
-#else
-/* list_sort comparator to sort TSCopyMultiInsertBuffer by usage */
+
+/* list_sort comparator to sort TSCopyMultiInsertBuffer by decreasing size */
 static int
-TSCmpBuffersByUsage(const ListCell *a, const ListCell *b)
+TSCmpBuffersBySize(const void *a, const void *b)
 {
-	int b1 = ((const TSCopyMultiInsertBuffer *) lfirst(a))->nused;
-	int b2 = ((const TSCopyMultiInsertBuffer *) lfirst(b))->nused;
+	int b1 = ((const TSCopyMultiInsertBuffer *) lfirst(*(ListCell **) a))->bytes;
+	int b2 = ((const TSCopyMultiInsertBuffer *) lfirst(*(ListCell **) b))->bytes;
 
-	Assert(b1 >= 0);
-	Assert(b2 >= 0);
+	return (b1 < b2) ? 1 : (b1 == b2) ? 0 : -1;
+}
+#else
+/* list_sort comparator to sort TSCopyMultiInsertBuffer by last use */
+static int
+TSCmpBuffersByLastUse(const ListCell *a, const ListCell *b)
+{
+	uint64 b1 = ((const TSCopyMultiInsertBuffer *) lfirst(a))->last_used;
+	uint64 b2 = ((const TSCopyMultiInsertBuffer *) lfirst(b))->last_used;
 
 	return (b1 > b2) ? 1 : (b1 == b2) ? 0 : -1;
 }
+
+/* list_sort comparator to sort TSCopyMultiInsertBuffer by decreasing size */
+static int
+TSCmpBuffersBySize(const ListCell *a, const ListCell *b)
+{
+	int b1 = ((const TSCopyMultiInsertBuffer *) lfirst(a))->bytes;
+	int b2 = ((const TSCopyMultiInsertBuffer *) lfirst(b))->bytes;
+
+	return (b1 < b2) ? 1 : (b1 == b2) ? 0 : -1;
+}
 #endif
 
 /*
- * Flush all buffers by writing the tuples to the chunks. In addition, trim down the
- * amount of multi-insert buffers to MAX_PARTITION_BUFFERS by deleting the least used
- * buffers (the buffers that store least tuples).
+ * Create a list of all buffers.
  */
-static inline void
-TSCopyMultiInsertInfoFlush(TSCopyMultiInsertInfo *miinfo, ChunkInsertState *cur_cis)
+static List *
+TSCopyMultiInsertInfoGetBuffers(TSCopyMultiInsertInfo *miinfo)
 {
 	HASH_SEQ_STATUS status;
 	MultiInsertBufferEntry *entry;
-	int current_multi_insert_buffers;
-	int buffers_to_delete;
-	bool found;
-	int32 flushed_chunk_id;
 	List *buffer_list = NIL;
-	ListCell *lc;
 
-	current_multi_insert_buffers = hash_get_num_entries(miinfo->multiInsertBuffers);
-
-	/* Create a list of buffers that can be sorted by usage */
 	hash_seq_init(&status, miinfo->multiInsertBuffers);
 	for (entry = hash_seq_search(&status); entry != NULL; entry = hash_seq_search(&status))
-	{
 		buffer_list = lappend(buffer_list, entry->buffer);
-	}
 
-	buffers_to_delete = Max(current_multi_insert_buffers - MAX_PARTITION_BUFFERS, 0);
+	return buffer_list;
+}
+
+/*
+ * Trim down the amount of multi-insert buffers to the number of buffers
+ * that fit into the memory budget by deleting the least recently used
+ * buffers. Buffers are also deleted while their slots and arrays take more
+ * than half of the budget, which leaves the other half for tuples.
+ *
+ * The buffer of the current chunk is not deleted because it is likely to be
+ * reused for the next insert.
+ */
+static void
+TSCopyMultiInsertInfoTrim(TSCopyMultiInsertInfo *miinfo, int32 cur_chunk_id)
+{
+	int buffers_to_delete = hash_get_num_entries(miinfo->multiInsertBuffers) -
+							TSCopyMultiInsertInfoMaxBuffers(miinfo);
+	List *buffer_list;
+	ListCell *lc;
+
+	if (buffers_to_delete <= 0 && miinfo->overheadBytes <= miinfo->budget / 2)
+		return;
 
-	/* Sorting is only needed if we want to remove the least used buffers */
-	if (buffers_to_delete > 0)
-		buffer_list = list_sort_compat(buffer_list, TSCmpBuffersByUsage);
+	buffer_list = TSCopyMultiInsertInfoGetBuffers(miinfo);
+	buffer_list = list_sort_compat(buffer_list, TSCmpBuffersByLastUse);
 
-	/* Flush buffers and delete them if needed */
 	foreach (lc, buffer_list)
 	{
 		TSCopyMultiInsertBuffer *buffer = (TSCopyMultiInsertBuffer *) lfirst(lc);
-		flushed_chunk_id = TSCopyMultiInsertBufferFlush(miinfo, buffer);
+		int32 chunk_id = buffer->chunk_id;
+		bool found;
 
-		if (buffers_to_delete > 0)
-		{
-			/*
-			 * Reduce active multi-insert buffers. However, the current used buffer
-			 * should not be deleted because it might reused for the next insert.
-			 */
-			if (cur_cis == NULL || flushed_chunk_id != cur_cis->chunk_id)
-			{
-				TSCopyMultiInsertBufferCleanup(miinfo, buffer);
-				hash_search(miinfo->multiInsertBuffers, &flushed_chunk_id, HASH_REMOVE, &found);
-				Assert(found);
-				buffers_to_delete--;
-			}
-		}
+		if (buffers_to_delete <= 0 && miinfo->overheadBytes <= miinfo->budget / 2)
+			break;
+
+		if (chunk_id == cur_chunk_id)
+			continue;
+
+		TSCopyMultiInsertBufferFlush(miinfo, buffer);
+		TSCopyMultiInsertBufferCleanup(miinfo, buffer);
+		hash_search(miinfo->multiInsertBuffers, &chunk_id, HASH_REMOVE, &found);
+		Assert(found);
+		buffers_to_delete--;
 	}
 
 	list_free(buffer_list);
+}
+
+/*
+ * Flush all buffers by writing the tuples to the chunks. In addition, trim down the
+ * amount of multi-insert buffers.
+ */
+static inline void
+TSCopyMultiInsertInfoFlush(TSCopyMultiInsertInfo *miinfo, ChunkInsertState *cur_cis)
+{
+	/*
+	 * Flushing buffers looks up the chunk insert states of the flushed chunks,
+	 * which can evict cur_cis from the chunk dispatch cache, so remember its
+	 * chunk id up front.
+	 */
+	int32 cur_chunk_id = cur_cis != NULL ? cur_cis->chunk_id : INVALID_CHUNK_ID;
+	List *buffer_list = TSCopyMultiInsertInfoGetBuffers(miinfo);
+	ListCell *lc;
+
+	foreach (lc, buffer_list)
+		TSCopyMultiInsertBufferFlush(miinfo, (TSCopyMultiInsertBuffer *) lfirst(lc));
+
+	list_free(buffer_list);
 
 	/* All buffers have been flushed */
-	miinfo->bufferedTuples = 0;
-	miinfo->bufferedBytes = 0;
+	Assert(miinfo->bufferedTuples == 0);
+	Assert(miinfo->bufferedBytes == 0);
+
+	TSCopyMultiInsertInfoTrim(miinfo, cur_chunk_id);
+}
+
+/*
+ * Make room in the buffers when they exceed the memory budget.
+ *
+ * The largest buffers are flushed until half of the budget is free. Small
+ * buffers keep their tuples, so that they are written with larger
+ * multi-inserts later on, instead of flushing every buffer whenever the
+ * budget is exhausted.
+ */
+static void
+TSCopyMultiInsertInfoMakeRoom(TSCopyMultiInsertInfo *miinfo, ChunkInsertState *cur_cis)
+{
+	int32 cur_chunk_id = cur_cis->chunk_id;
+	List *buffer_list = TSCopyMultiInsertInfoGetBuffers(miinfo);
+	ListCell *lc;
+
+	buffer_list = list_sort_compat(buffer_list, TSCmpBuffersBySize);
+
+	foreach (lc, buffer_list)
+	{
+		if (TSCopyMultiInsertInfoMemory(miinfo) <= miinfo->budget / 2)
+			break;
+
+		TSCopyMultiInsertBufferFlush(miinfo, (TSCopyMultiInsertBuffer *) lfirst(lc));
+	}
+
+	list_free(buffer_list);
+
+	TSCopyMultiInsertInfoTrim(miinfo, cur_chunk_id);
 }
 
 /*
@@ -589,13 +815,15 @@ TSCopyMultiInsertInfoNextFreeSlot(TSCopyMultiInsertInfo *miinfo,
 	int nused = buffer->nused;
 
 	Assert(buffer != NULL);
-	Assert(nused < MAX_BUFFERED_TUPLES);
+	Assert(nused < buffer->capacity);
 
 	if (buffer->slots[nused] == NULL)
 	{
 		const TupleTableSlotOps *tts_cb =
 			table_slot_callbacks(result_relation_info->ri_RelationDesc);
 		buffer->slots[nused] = MakeSingleTupleTableSlot(buffer->tupdesc, tts_cb);
+		buffer->overhead += TSCopyMultiInsertSlotSize(buffer->tupdesc);
+		miinfo->overheadBytes += TSCopyMultiInsertSlotSize(buffer->tupdesc);
 	}
 	return buffer->slots[nused];
 }
@@ -609,6 +837,8 @@ TSCopyMultiInsertInfoStore(TSCopyMultiInsertInfo *miinfo, ResultRelInfo *rri,
 						   TSCopyMultiInsertBuffer *buffer, TupleTableSlot *slot,
 						   CopyFromState cstate)
 {
+	int tuplen;
+
 	Assert(buffer != NULL);
 	Assert(slot == buffer->slots[buffer->nused]);
 
@@ -624,24 +854,21 @@ TSCopyMultiInsertInfoStore(TSCopyMultiInsertInfo *miinfo, ResultRelInfo *rri,
 #endif
 	buffer->linenos[buffer->nused] = lineno;
 
+	/*
+	 * The slot is materialized, so this is the size of the tuple that is
+	 * kept in memory until the buffer is flushed.
+	 */
+	tuplen = ExecFetchSlotHeapTuple(slot, false, NULL)->t_len;
+
 	/* Record this slot as being used */
 	buffer->nused++;
+	buffer->bytes += tuplen;
+	buffer->last_used = ++miinfo->storedTuples;
 
 	/* Update how many tuples are stored and their size */
 	miinfo->bufferedTuples++;
-
-	/*
-	 * Note: There is no reliable way to determine the in-memory size of a virtual
-	 * tuple. So, we perform flushing in PG < 14 only based on the number of buffered
-	 * tuples and not based on the size.
-	 */
-#if PG14_GE
-	if (cstate != NULL)
-	{
-		int tuplen = cstate->line_buf.len;
-		miinfo->bufferedBytes += tuplen;
-	}
-#endif
+	miinfo->bufferedBytes += tuplen;
+	miinfo->storedBytes += tuplen;
 }
 
 static void
@@ -705,116 +932,446 @@ has_other_before_insert_row_trigger_than_ts(ResultRelInfo *resultRelInfo)
 }
 
 /*
- * Use COPY FROM to copy data from file to relation.
+ * Rows read ahead by COPY to be inserted grouped by chunk.
+ *
+ * Rows that do not arrive in time order, e.g., when data is exported per
+ * device, make COPY switch between chunks for almost every row, which spreads
+ * the rows of a chunk over many small multi-inserts. When
+ * timescaledb.copy_sort_memory is set, COPY reads up to that much data ahead
+ * and sorts it by chunk, and by time within each chunk, before inserting it.
+ *
+ * The chunk of a row is the chunk whose insert state is cached for its
+ * point. Rows without an open chunk are grouped by the default slices of
+ * their point instead, which are the slices of the chunk that would be
+ * created for them unless it has to be cut to fit existing chunks.
+ *
+ * The points of the rows are calculated in batches while reading ahead and
+ * kept with the rows, so that they are not calculated again on insert.
+ *
+ * Errors while inserting a row should point to its line rather than to the
+ * last line read ahead. The line number can be set in the COPY state since
+ * PG14. Before that it is private, so the rows are numbered while reading
+ * ahead and an error context callback of our own reports the number of the
+ * row that is inserted, like parallel COPY does.
  */
-static uint64
-copyfrom(CopyChunkState *ccstate, List *range_table, Hypertable *ht, MemoryContext copycontext,
-		 void (*callback)(void *), void *arg)
+#define COPY_SORT_BATCH_SIZE 64
+
+typedef struct CopySortEntry
 {
-	ResultRelInfo *resultRelInfo;
-	ResultRelInfo *saved_resultRelInfo = NULL;
-	EState *estate = ccstate->estate; /* for ExecConstraints() */
-	ExprContext *econtext;
-	TupleTableSlot *singleslot;
-	MemoryContext oldcontext = CurrentMemoryContext;
-	ErrorContextCallback errcallback = {
-		.callback = callback,
-		.arg = arg,
-	};
-	CommandId mycid = GetCurrentCommandId(true);
-	CopyInsertMethod insertMethod;				   /* The insert method for the table */
-	CopyInsertMethod currentTupleInsertMethod;	   /* The insert method of the current tuple */
-	TSCopyMultiInsertInfo multiInsertInfo = { 0 }; /* pacify compiler */
-	int ti_options = 0;							   /* start with default options for insert */
-	BulkInsertState bistate = NULL;
-	uint64 processed = 0;
-	bool has_before_insert_row_trig;
-	bool has_instead_insert_row_trig;
-	ExprState *qualexpr = NULL;
-	ChunkDispatch *dispatch = ccstate->dispatch;
+	HeapTuple tuple;
+	Point *point;
+	uint64 lineno;	/* Input line of the row */
+	int32 chunk_id; /* Chunk of the row, or 0 if it has no open chunk */
+	int64 *slices;	/* Start of the default slices if it has no open chunk */
+	int pos;		/* Position in the input, to keep the sort stable */
+} CopySortEntry;
+
+typedef struct CopySortState
+{
+	MemoryContext mctx;
+	CopySortEntry *entries;
+	int nentries;
+	int maxentries;
+	int next;
+	int num_dimensions;
+	bool done;
+	uint64 lineno;		 /* Input line of the last row read */
+	ExprState *qualexpr; /* WHERE clause of the COPY */
+#if PG14_LT
+	bool reading;			  /* Set while reading ahead */
+	uint64 cur_lineno;		  /* Input line of the row that is inserted */
+	const char *relname;	  /* Relation for the error context */
+	void (*callback)(void *); /* Error context callback of the input */
+	void *arg;
+#endif
+	/* Slots for a batch of rows to calculate the points of */
+	TupleTableSlot *slots[COPY_SORT_BATCH_SIZE];
+} CopySortState;
 
-	Assert(range_table);
+#if PG14_LT
+/*
+ * Error context callback for sorted rows. Errors while reading ahead are
+ * reported by the callback of the input, which knows the current line.
+ */
+static void
+copy_sort_error_callback(void *arg)
+{
+	CopySortState *sort = (CopySortState *) arg;
 
-	if (ccstate->rel->rd_rel->relkind != RELKIND_RELATION)
-	{
-		if (ccstate->rel->rd_rel->relkind == RELKIND_VIEW)
-			ereport(ERROR,
-					(errcode(ERRCODE_WRONG_OBJECT_TYPE),
-					 errmsg("cannot copy to view \"%s\"", RelationGetRelationName(ccstate->rel))));
-		else if (ccstate->rel->rd_rel->relkind == RELKIND_MATVIEW)
-			ereport(ERROR,
-					(errcode(ERRCODE_WRONG_OBJECT_TYPE),
-					 errmsg("cannot copy to materialized view \"%s\"",
-							RelationGetRelationName(ccstate->rel))));
-		else if (ccstate->rel->rd_rel->relkind == RELKIND_FOREIGN_TABLE)
-			ereport(ERROR,
-					(errcode(ERRCODE_WRONG_OBJECT_TYPE),
-					 errmsg("cannot copy to foreign table \"%s\"",
-							RelationGetRelationName(ccstate->rel))));
-		else if (ccstate->rel->rd_rel->relkind == RELKIND_SEQUENCE)
-			ereport(ERROR,
-					(errcode(ERRCODE_WRONG_OBJECT_TYPE),
-					 errmsg("cannot copy to sequence \"%s\"",
-							RelationGetRelationName(ccstate->rel))));
-		else
-			ereport(ERROR,
-					(errcode(ERRCODE_WRONG_OBJECT_TYPE),
-					 errmsg("cannot copy to non-table relation \"%s\"",
-							RelationGetRelationName(ccstate->rel))));
-	}
+	if (sort->reading)
+		sort->callback(sort->arg);
+	else if (sort->cur_lineno > 0)
+		errcontext("COPY %s, line " UINT64_FORMAT, sort->relname, sort->cur_lineno);
+	else
+		errcontext("COPY %s", sort->relname);
+}
+#endif
 
-	/*----------
-	 * Check to see if we can avoid writing WAL
-	 *
-	 * If archive logging/streaming is not enabled *and* either
-	 *	- table was created in same transaction as this COPY
-	 *	- data is being written to relfilenode created in this transaction
-	 * then we can skip writing WAL.  It's safe because if the transaction
-	 * doesn't commit, we'll discard the table (or the new relfilenode file).
-	 * If it does commit, we'll have done the heap_sync at the bottom of this
-	 * routine first.
-	 *
-	 * As mentioned in comments in utils/rel.h, the in-same-transaction test
-	 * is not always set correctly, since in rare cases rd_newRelfilenodeSubid
-	 * can be cleared before the end of the transaction. The exact case is
-	 * when a relation sets a new relfilenode twice in same transaction, yet
-	 * the second one fails in an aborted subtransaction, e.g.
-	 *
-	 * BEGIN;
-	 * TRUNCATE t;
-	 * SAVEPOINT save;
-	 * TRUNCATE t;
-	 * ROLLBACK TO save;
-	 * COPY ...
-	 *
-	 * Also, if the target file is new-in-transaction, we assume that checking
-	 * FSM for free space is a waste of time, even if we must use WAL because
-	 * of archiving.  This could possibly be wrong, but it's unlikely.
-	 *
-	 * The comments for heap_insert and RelationGetBufferForTuple specify that
-	 * skipping WAL logging is only safe if we ensure that our tuples do not
-	 * go into pages containing tuples from any other transactions --- but this
-	 * must be the case if we have a new table or new relfilenode, so we need
-	 * no additional work to enforce that.
-	 *----------
-	 */
-	/* createSubid is creation check, newRelfilenodeSubid is truncation check */
-	if (ccstate->rel->rd_createSubid != InvalidSubTransactionId ||
-#if PG16_LT
-		ccstate->rel->rd_newRelfilenodeSubid != InvalidSubTransactionId)
+static CopySortState *
+copy_sort_state_create(CopyChunkState *ccstate, Hypertable *ht, ExprState *qualexpr)
+{
+	CopySortState *sort = palloc0(sizeof(CopySortState));
+	int i;
+
+	sort->mctx = AllocSetContextCreate(CurrentMemoryContext, "COPY sort", ALLOCSET_DEFAULT_SIZES);
+	sort->num_dimensions = ht->space->num_dimensions;
+	sort->qualexpr = qualexpr;
+#if PG14_GE
+	if (ccstate->cstate != NULL)
+		sort->lineno = ccstate->cstate->cur_lineno;
 #else
-		ccstate->rel->rd_newRelfilelocatorSubid != InvalidSubTransactionId)
-#endif
-	{
-		ti_options |= HEAP_INSERT_SKIP_FSM;
-#if PG13_LT
-		if (!XLogIsNeeded())
-			ti_options |= HEAP_INSERT_SKIP_WAL;
+	sort->relname = RelationGetRelationName(ccstate->rel);
 #endif
-	}
 
-	/*
-	 * We need a ResultRelInfo so we can use the regular executor's
+	for (i = 0; i < COPY_SORT_BATCH_SIZE; i++)
+		sort->slots[i] = MakeSingleTupleTableSlot(RelationGetDescr(ccstate->rel), &TTSOpsHeapTuple);
+
+	return sort;
+}
+
+static void
+copy_sort_state_destroy(CopySortState *sort)
+{
+	int i;
+
+	for (i = 0; i < COPY_SORT_BATCH_SIZE; i++)
+		ExecDropSingleTupleTableSlot(sort->slots[i]);
+
+	MemoryContextDelete(sort->mctx);
+}
+
+static int
+copy_sort_entry_cmp(const void *a, const void *b, void *arg)
+{
+	const CopySortEntry *e1 = (const CopySortEntry *) a;
+	const CopySortEntry *e2 = (const CopySortEntry *) b;
+	int num_dimensions = *((int *) arg);
+	int i;
+
+	if (e1->chunk_id != e2->chunk_id)
+		return (e1->chunk_id < e2->chunk_id) ? -1 : 1;
+
+	if (e1->chunk_id == 0)
+	{
+		for (i = 0; i < num_dimensions; i++)
+		{
+			if (e1->slices[i] != e2->slices[i])
+				return (e1->slices[i] < e2->slices[i]) ? -1 : 1;
+		}
+	}
+
+	if (e1->point->coordinates[0] != e2->point->coordinates[0])
+		return (e1->point->coordinates[0] < e2->point->coordinates[0]) ? -1 : 1;
+
+	return (e1->pos < e2->pos) ? -1 : (e1->pos > e2->pos);
+}
+
+/*
+ * Calculate the points of a batch of rows read ahead and look up their
+ * chunks.
+ */
+static void
+copy_sort_route_batch(CopySortState *sort, CopyChunkState *ccstate, Hypertable *ht,
+					  CopySortEntry *entries, int nrows)
+{
+	Point *points[COPY_SORT_BATCH_SIZE];
+	int i, j;
+
+	ts_hyperspace_calculate_points(ht->space, sort->slots, nrows, points);
+
+	for (i = 0; i < nrows; i++)
+	{
+		CopySortEntry *entry = &entries[i];
+		ChunkInsertState *cis = ts_subspace_store_get(ccstate->dispatch->cache, points[i]);
+
+		entry->point = MemoryContextAlloc(sort->mctx, POINT_SIZE(sort->num_dimensions));
+		memcpy(entry->point, points[i], POINT_SIZE(sort->num_dimensions));
+		entry->chunk_id = (cis != NULL) ? cis->chunk_id : 0;
+		entry->slices = NULL;
+
+		if (cis == NULL)
+		{
+			entry->slices = MemoryContextAlloc(sort->mctx, sizeof(int64) * sort->num_dimensions);
+
+			for (j = 0; j < sort->num_dimensions; j++)
+			{
+				DimensionSlice *slice =
+					ts_dimension_calculate_default_slice(&ht->space->dimensions[j],
+														 points[i]->coordinates[j]);
+
+				entry->slices[j] = slice->fd.range_start;
+			}
+		}
+
+		ExecClearTuple(sort->slots[i]);
+	}
+}
+
+/*
+ * Read rows until the memory budget is used up or the input ends and sort
+ * them. Rows are read into the per-tuple context and copied into the memory
+ * context of the sort state, which is reset for every round.
+ */
+static void
+copy_sort_fill(CopySortState *sort, CopyChunkState *ccstate, Hypertable *ht,
+			   ExprContext *econtext, TupleTableSlot *slot)
+{
+	Size budget = (Size) ts_guc_copy_sort_memory * 1024L;
+	Size bytes = 0;
+
+	MemoryContextReset(sort->mctx);
+	sort->maxentries = 1024;
+	sort->entries = MemoryContextAlloc(sort->mctx, sizeof(CopySortEntry) * sort->maxentries);
+	sort->nentries = 0;
+	sort->next = 0;
+
+#if PG14_GE
+	/* Rows handed out from the previous round changed the line number */
+	if (ccstate->cstate != NULL)
+		ccstate->cstate->cur_lineno = sort->lineno;
+#else
+	sort->reading = true;
+#endif
+
+	while (!sort->done && bytes < budget)
+	{
+		int first = sort->nentries;
+		int nrows = 0;
+
+		while (nrows < COPY_SORT_BATCH_SIZE)
+		{
+			CopySortEntry *entry;
+			MemoryContext oldcontext;
+
+			CHECK_FOR_INTERRUPTS();
+			ResetPerTupleExprContext(ccstate->estate);
+			ExecClearTuple(slot);
+
+			if (!ccstate->next_copy_from(ccstate, econtext, slot->tts_values, slot->tts_isnull))
+			{
+				sort->done = true;
+				break;
+			}
+
+			ExecStoreVirtualTuple(slot);
+#if PG14_LT
+			/* The line number is private before PG14, so use the row number */
+			sort->lineno++;
+#endif
+
+			/* Skip filtered rows before their points are calculated */
+			if (sort->qualexpr != NULL)
+			{
+				econtext->ecxt_scantuple = slot;
+				if (!ExecQual(sort->qualexpr, econtext))
+					continue;
+			}
+
+			if (sort->nentries >= sort->maxentries)
+			{
+				sort->maxentries *= 2;
+				sort->entries = repalloc(sort->entries, sizeof(CopySortEntry) * sort->maxentries);
+			}
+
+			entry = &sort->entries[sort->nentries];
+			entry->pos = sort->nentries;
+			entry->lineno = 0;
+#if PG14_GE
+			if (ccstate->cstate != NULL)
+				entry->lineno = ccstate->cstate->cur_lineno;
+#else
+			entry->lineno = sort->lineno;
+#endif
+
+			/* The values might point into the input, so copy them right away */
+			oldcontext = MemoryContextSwitchTo(sort->mctx);
+			entry->tuple = ExecCopySlotHeapTuple(slot);
+			MemoryContextSwitchTo(oldcontext);
+			ExecStoreHeapTuple(entry->tuple, sort->slots[nrows], false);
+
+			bytes += sizeof(CopySortEntry) + POINT_SIZE(sort->num_dimensions) + HEAPTUPLESIZE +
+					 entry->tuple->t_len;
+			sort->nentries++;
+			nrows++;
+		}
+
+		ResetPerTupleExprContext(ccstate->estate);
+		copy_sort_route_batch(sort, ccstate, ht, &sort->entries[first], nrows);
+	}
+
+#if PG14_GE
+	if (ccstate->cstate != NULL)
+		sort->lineno = ccstate->cstate->cur_lineno;
+#else
+	sort->reading = false;
+#endif
+
+	qsort_arg(sort->entries,
+			  sort->nentries,
+			  sizeof(CopySortEntry),
+			  copy_sort_entry_cmp,
+			  &sort->num_dimensions);
+}
+
+/*
+ * Get the next row in chunk order, and its point, reading ahead when the
+ * sorted rows are used up. This replaces next_copy_from() in the insert
+ * loop.
+ */
+static bool
+copy_sort_next(CopySortState *sort, CopyChunkState *ccstate, Hypertable *ht,
+			   ExprContext *econtext, TupleTableSlot *slot, Point **point)
+{
+	CopySortEntry *entry;
+
+	if (sort->next >= sort->nentries)
+	{
+		if (sort->done)
+			return false;
+
+		copy_sort_fill(sort, ccstate, ht, econtext, slot);
+		ExecClearTuple(slot);
+
+		if (sort->nentries == 0)
+			return false;
+	}
+
+	entry = &sort->entries[sort->next++];
+	heap_deform_tuple(entry->tuple,
+					  RelationGetDescr(ccstate->rel),
+					  slot->tts_values,
+					  slot->tts_isnull);
+	*point = entry->point;
+
+#if PG14_GE
+	/*
+	 * Errors while inserting the row should point to its line, but the line
+	 * buffer holds the last line read ahead.
+	 */
+	if (ccstate->cstate != NULL)
+	{
+		ccstate->cstate->cur_lineno = entry->lineno;
+		ccstate->cstate->line_buf_valid = false;
+	}
+#else
+	sort->cur_lineno = entry->lineno;
+#endif
+
+	return true;
+}
+
+/*
+ * Use COPY FROM to copy data from file to relation.
+ */
+static uint64
+copyfrom(CopyChunkState *ccstate, List *range_table, Hypertable *ht, MemoryContext copycontext,
+		 void (*callback)(void *), void *arg)
+{
+	ResultRelInfo *resultRelInfo;
+	ResultRelInfo *saved_resultRelInfo = NULL;
+	EState *estate = ccstate->estate; /* for ExecConstraints() */
+	ExprContext *econtext;
+	TupleTableSlot *singleslot;
+	MemoryContext oldcontext = CurrentMemoryContext;
+	ErrorContextCallback errcallback = {
+		.callback = callback,
+		.arg = arg,
+	};
+	CommandId mycid = GetCurrentCommandId(true);
+	CopyInsertMethod insertMethod;				   /* The insert method for the table */
+	CopyInsertMethod currentTupleInsertMethod;	   /* The insert method of the current tuple */
+	TSCopyMultiInsertInfo multiInsertInfo = { 0 }; /* pacify compiler */
+	int ti_options = 0;							   /* start with default options for insert */
+	BulkInsertState bistate = NULL;
+	uint64 processed = 0;
+	bool has_before_insert_row_trig;
+	bool has_instead_insert_row_trig;
+	ExprState *qualexpr = NULL;
+	ChunkDispatch *dispatch = ccstate->dispatch;
+	CopySortState *sort = NULL;
+
+	Assert(range_table);
+
+	if (ccstate->rel->rd_rel->relkind != RELKIND_RELATION)
+	{
+		if (ccstate->rel->rd_rel->relkind == RELKIND_VIEW)
+			ereport(ERROR,
+					(errcode(ERRCODE_WRONG_OBJECT_TYPE),
+					 errmsg("cannot copy to view \"%s\"", RelationGetRelationName(ccstate->rel))));
+		else if (ccstate->rel->rd_rel->relkind == RELKIND_MATVIEW)
+			ereport(ERROR,
+					(errcode(ERRCODE_WRONG_OBJECT_TYPE),
+					 errmsg("cannot copy to materialized view \"%s\"",
+							RelationGetRelationName(ccstate->rel))));
+		else if (ccstate->rel->rd_rel->relkind == RELKIND_FOREIGN_TABLE)
+			ereport(ERROR,
+					(errcode(ERRCODE_WRONG_OBJECT_TYPE),
+					 errmsg("cannot copy to foreign table \"%s\"",
+							RelationGetRelationName(ccstate->rel))));
+		else if (ccstate->rel->rd_rel->relkind == RELKIND_SEQUENCE)
+			ereport(ERROR,
+					(errcode(ERRCODE_WRONG_OBJECT_TYPE),
+					 errmsg("cannot copy to sequence \"%s\"",
+							RelationGetRelationName(ccstate->rel))));
+		else
+			ereport(ERROR,
+					(errcode(ERRCODE_WRONG_OBJECT_TYPE),
+					 errmsg("cannot copy to non-table relation \"%s\"",
+							RelationGetRelationName(ccstate->rel))));
+	}
+
+	/*----------
+	 * Check to see if we can avoid writing WAL
+	 *
+	 * If archive logging/streaming is not enabled *and* either
+	 *	- table was created in same transaction as this COPY
+	 *	- data is being written to relfilenode created in this transaction
+	 * then we can skip writing WAL.  It's safe because if the transaction
+	 * doesn't commit, we'll discard the table (or the new relfilenode file).
+	 * If it does commit, we'll have done the heap_sync at the bottom of this
+	 * routine first.
+	 *
+	 * As mentioned in comments in utils/rel.h, the in-same-transaction test
+	 * is not always set correctly, since in rare cases rd_newRelfilenodeSubid
+	 * can be cleared before the end of the transaction. The exact case is
+	 * when a relation sets a new relfilenode twice in same transaction, yet
+	 * the second one fails in an aborted subtransaction, e.g.
+	 *
+	 * BEGIN;
+	 * TRUNCATE t;
+	 * SAVEPOINT save;
+	 * TRUNCATE t;
+	 * ROLLBACK TO save;
+	 * COPY ...
+	 *
+	 * Also, if the target file is new-in-transaction, we assume that checking
+	 * FSM for free space is a waste of time, even if we must use WAL because
+	 * of archiving.  This could possibly be wrong, but it's unlikely.
+	 *
+	 * The comments for heap_insert and RelationGetBufferForTuple specify that
+	 * skipping WAL logging is only safe if we ensure that our tuples do not
+	 * go into pages containing tuples from any other transactions --- but this
+	 * must be the case if we have a new table or new relfilenode, so we need
+	 * no additional work to enforce that.
+	 *----------
+	 */
+	/* createSubid is creation check, newRelfilenodeSubid is truncation check */
+	if (ccstate->rel->rd_createSubid != InvalidSubTransactionId ||
+#if PG16_LT
+		ccstate->rel->rd_newRelfilenodeSubid != InvalidSubTransactionId)
+#else
+		ccstate->rel->rd_newRelfilelocatorSubid != InvalidSubTransactionId)
+#endif
+	{
+		ti_options |= HEAP_INSERT_SKIP_FSM;
+#if PG13_LT
+		if (!XLogIsNeeded())
+			ti_options |= HEAP_INSERT_SKIP_WAL;
+#endif
+	}
+
+	/*
+	 * We need a ResultRelInfo so we can use the regular executor's
 	 * index-entry-making machinery.  (There used to be a huge amount of code
 	 * here that basically duplicated execUtils.c ...)
 	 *
@@ -916,6 +1473,23 @@ copyfrom(CopyChunkState *ccstate, List *range_table, Hypertable *ht, MemoryConte
 								  mycid,
 								  ti_options,
 								  ht);
+
+		if (ts_guc_copy_sort_memory > 0)
+		{
+			sort = copy_sort_state_create(ccstate, ht, qualexpr);
+#if PG14_LT
+			/* Report the lines of sorted rows with a callback of our own */
+			if (error_context_stack == &errcallback)
+			{
+				sort->callback = errcallback.callback;
+				sort->arg = errcallback.arg;
+				errcallback.callback = copy_sort_error_callback;
+				errcallback.arg = sort;
+			}
+#endif
+		}
+
+		dispatch->defer_chunk_indexes = ts_guc_copy_defer_chunk_indexes;
 	}
 
 	for (;;)
@@ -925,6 +1499,7 @@ copyfrom(CopyChunkState *ccstate, List *range_table, Hypertable *ht, MemoryConte
 		Point *point = NULL;
 		ChunkInsertState *cis = NULL;
 		TSCopyMultiInsertBuffer *buffer = NULL;
+		bool found;
 
 		CHECK_FOR_INTERRUPTS();
 
@@ -942,13 +1517,37 @@ copyfrom(CopyChunkState *ccstate, List *range_table, Hypertable *ht, MemoryConte
 
 		ExecClearTuple(myslot);
 
-		if (!ccstate->next_copy_from(ccstate, econtext, myslot->tts_values, myslot->tts_isnull))
+		if (sort != NULL)
+			found = copy_sort_next(sort, ccstate, ht, econtext, myslot, &point);
+		else
+			found = ccstate->next_copy_from(ccstate,
+											econtext,
+											myslot->tts_values,
+											myslot->tts_isnull);
+
+		if (!found)
 			break;
 
 		ExecStoreVirtualTuple(myslot);
 
+		/*
+		 * Filter the tuple before routing it, so that filtered tuples neither
+		 * create chunks nor fail on values that cannot be routed. Rows read
+		 * ahead for sorting were filtered when they were read.
+		 */
+		if (qualexpr != NULL && sort == NULL)
+		{
+			econtext->ecxt_scantuple = myslot;
+			if (!ExecQual(qualexpr, econtext))
+				continue;
+		}
+
 		/* Calculate the tuple's point in the N-dimensional hyperspace */
-		point = ts_hyperspace_calculate_point(ht->space, myslot);
+		if (point == NULL)
+		{
+			point = dispatch->point;
+			ts_hyperspace_fill_point(ht->space, myslot, point);
+		}
 
 		/* Find or create the insert state matching the point */
 		cis = ts_chunk_dispatch_get_chunk_insert_state(dispatch,
@@ -980,8 +1579,19 @@ copyfrom(CopyChunkState *ccstate, List *range_table, Hypertable *ht, MemoryConte
 			 * batching, so rows are visible to triggers etc.
 			 */
 			if (insertMethod == CIM_MULTI_CONDITIONAL)
+			{
 				TSCopyMultiInsertInfoFlush(&multiInsertInfo, cis);
 
+				/* The flush might have closed the chunk, so look it up again */
+				MemoryContextSwitchTo(GetPerTupleMemoryContext(estate));
+				cis = ts_chunk_dispatch_get_chunk_insert_state(dispatch,
+															   point,
+															   myslot,
+															   on_chunk_insert_state_changed,
+															   bistate);
+				MemoryContextSwitchTo(oldcontext);
+			}
+
 			currentTupleInsertMethod = CIM_SINGLE;
 		}
 
@@ -1024,13 +1634,6 @@ copyfrom(CopyChunkState *ccstate, List *range_table, Hypertable *ht, MemoryConte
 			}
 		}
 
-		if (qualexpr != NULL)
-		{
-			econtext->ecxt_scantuple = myslot;
-			if (!ExecQual(qualexpr, econtext))
-				continue;
-		}
-
 		/*
 		 * Set the result relation in the executor state to the target chunk.
 		 * This makes sure that the tuple gets inserted into the correct
@@ -1071,8 +1674,12 @@ copyfrom(CopyChunkState *ccstate, List *range_table, Hypertable *ht, MemoryConte
 			if (resultRelInfo->ri_FdwRoutine == NULL &&
 				resultRelInfo->ri_RelationDesc->rd_att->constr)
 			{
+				instr_time start;
+
 				Assert(resultRelInfo->ri_RangeTableIndex > 0 && estate->es_range_table);
+				ts_insert_stats_start(dispatch->stats, &start);
 				ExecConstraints(resultRelInfo, myslot, estate);
+				ts_insert_stats_end(dispatch->stats, INSERT_STAGE_CONSTRAINT_CHECK, &start);
 			}
 
 			if (currentTupleInsertMethod == CIM_SINGLE)
@@ -1085,6 +1692,10 @@ copyfrom(CopyChunkState *ccstate, List *range_table, Hypertable *ht, MemoryConte
 								   bistate);
 
 				if (resultRelInfo->ri_NumIndices > 0)
+				{
+					instr_time start;
+
+					ts_insert_stats_start(dispatch->stats, &start);
 					recheckIndexes = ExecInsertIndexTuplesCompat(resultRelInfo,
 																 myslot,
 																 estate,
@@ -1092,6 +1703,8 @@ copyfrom(CopyChunkState *ccstate, List *range_table, Hypertable *ht, MemoryConte
 																 false,
 																 NULL,
 																 NIL);
+					ts_insert_stats_end(dispatch->stats, INSERT_STAGE_INDEX_INSERT, &start);
+				}
 				/* AFTER ROW INSERT Triggers */
 				ExecARInsertTriggers(estate,
 									 resultRelInfo,
@@ -1115,17 +1728,24 @@ copyfrom(CopyChunkState *ccstate, List *range_table, Hypertable *ht, MemoryConte
 										   ccstate->cstate);
 
 				/*
-				 * If enough inserts have queued up, then flush all
-				 * buffers out to their tables.
+				 * Write out a buffer as soon as it is full and let it grow,
+				 * so that chunks receiving many tuples get larger
+				 * multi-inserts. If enough inserts have queued up over all
+				 * buffers, then flush the largest buffers out to their tables.
 				 */
-				if (TSCopyMultiInsertInfoIsFull(&multiInsertInfo))
+				if (TSCopyMultiInsertBufferIsFull(buffer))
+				{
+					TSCopyMultiInsertBufferFlush(&multiInsertInfo, buffer);
+					TSCopyMultiInsertBufferGrow(&multiInsertInfo, buffer);
+				}
+				else if (TSCopyMultiInsertInfoIsFull(&multiInsertInfo))
 				{
 					ereport(DEBUG2,
 							(errmsg("flush called with %d bytes and %d buffered tuples",
 									multiInsertInfo.bufferedBytes,
 									multiInsertInfo.bufferedTuples)));
 
-					TSCopyMultiInsertInfoFlush(&multiInsertInfo, cis);
+					TSCopyMultiInsertInfoMakeRoom(&multiInsertInfo, cis);
 				}
 			}
 
@@ -1151,10 +1771,22 @@ copyfrom(CopyChunkState *ccstate, List *range_table, Hypertable *ht, MemoryConte
 
 	/* Flush any remaining buffered tuples */
 	if (insertMethod != CIM_SINGLE)
+	{
 		TSCopyMultiInsertInfoFlushAndCleanup(&multiInsertInfo);
 
-	/* Done, clean up */
-	if (errcallback.previous)
+		if (multiInsertInfo.flushes > 0)
+			ereport(DEBUG1,
+					(errmsg("Flushed multi-insert buffers " UINT64_FORMAT
+							" times with %.1f tuples per flush on average.",
+							multiInsertInfo.flushes,
+							(double) multiInsertInfo.flushedTuples / multiInsertInfo.flushes)));
+	}
+
+	if (sort != NULL)
+		copy_sort_state_destroy(sort);
+
+	/* Done, clean up */
+	if (errcallback.previous)
 		error_context_stack = errcallback.previous;
 
 	FreeBulkInsertState(bistate);
@@ -1327,6 +1959,894 @@ copy_constraints_and_check(ParseState *pstate, Relation rel, List *attnums)
 	PreventCommandIfParallelMode("COPY FROM");
 }
 
+/*
+ * Parallel COPY.
+ *
+ * The leader reads the input and splits the rows into raw fields with
+ * NextCopyFromRawFields(), which keeps quoted or escaped line breaks within
+ * their rows. The raw fields are packed into blocks that are sent to
+ * background workers over shared memory queues. The workers convert the
+ * fields with the input functions of the columns and insert the rows with
+ * copyfrom(), using their own chunk dispatch.
+ *
+ * Each worker inserts a block in a transaction of its own. Chunk creation
+ * takes a self-conflicting lock on the hypertable that is held until the end
+ * of the transaction, so workers that create chunks only wait for each other
+ * for the duration of a block. The flip side is that a failing COPY keeps
+ * the blocks that were already committed.
+ */
+#define PARALLEL_COPY_MAGIC 0x54534350
+
+#define PARALLEL_COPY_KEY_SHARED 1
+#define PARALLEL_COPY_KEY_GUC 2
+#define PARALLEL_COPY_KEY_DATA_QUEUES 3
+#define PARALLEL_COPY_KEY_ERROR_QUEUES 4
+
+/* Amount of raw field data that is sent to a worker as one block */
+#define PARALLEL_COPY_BLOCK_SIZE (1024 * 1024)
+#define PARALLEL_COPY_QUEUE_SIZE (2 * PARALLEL_COPY_BLOCK_SIZE)
+#define PARALLEL_COPY_ERROR_QUEUE_SIZE 16384
+
+#define PARALLEL_COPY_WORKER_MAIN "ts_copy_worker_main"
+
+/* State shared between the leader and the workers of a parallel COPY */
+typedef struct ParallelCopyShared
+{
+	Oid database_id;
+	Oid authenticated_user_id;
+	Oid current_user_id;
+	int sec_context;
+	Oid relid;
+	pg_atomic_uint64 processed; /* Number of rows in committed blocks */
+	pg_atomic_uint32 nfinished; /* Number of workers that got all blocks */
+	int nattnums;
+	AttrNumber attnums[FLEXIBLE_ARRAY_MEMBER];
+} ParallelCopyShared;
+
+/* Leader state of a parallel COPY worker */
+typedef struct ParallelCopyWorker
+{
+	BackgroundWorkerHandle *handle;
+	shm_mq_handle *data_mqh;
+	shm_mq_handle *error_mqh;
+	StringInfoData block; /* Block that is being sent to the worker */
+	bool sending;
+} ParallelCopyWorker;
+
+typedef struct ParallelCopyContext
+{
+	dsm_segment *seg;
+	ParallelCopyShared *shared;
+	ErrorContextCallback *error_context_stack;
+	int nworkers;
+	int next_worker;
+	ParallelCopyWorker *workers;
+} ParallelCopyContext;
+
+/*
+ * A block of rows received by a worker.
+ *
+ * Each row is stored as its line number and its number of fields, followed
+ * by the length (-1 for NULL) and the null-terminated data of each field.
+ */
+typedef struct ParallelCopyBlock
+{
+	const char *data;
+	Size len;
+	Size offset;
+	ParallelCopyShared *shared;
+	const char *relname;
+	uint64 lineno;			 /* Line of the row that is being read */
+	bool reading;			 /* Set while reading a row */
+	const char *cur_attname; /* Column that is being converted */
+	FmgrInfo *in_functions;
+	Oid *typioparams;
+	int num_defaults;
+	int *defmap;
+	ExprState **defexprs;
+} ParallelCopyBlock;
+
+/*
+ * Check if the rows of a COPY can be inserted by parallel workers.
+ *
+ * The workers insert the rows in transactions of their own, so a failing
+ * COPY is not rolled back as a whole and parallel COPY has to be enabled
+ * explicitly. The workers also cannot see anything the current transaction
+ * has written, and statement-level triggers would fire for every block.
+ * Binary input and the options that apply to the fields of specific columns
+ * are left to the serial copy.
+ */
+static bool
+copy_use_parallel_workers(const CopyStmt *stmt, Relation rel, const Hypertable *ht)
+{
+	TriggerDesc *trigdesc = rel->trigdesc;
+	ListCell *lc;
+	int i;
+
+	if (!ts_guc_enable_nonatomic_parallel_copy || ts_guc_max_parallel_copy_workers <= 0 ||
+		hypertable_is_distributed(ht) || stmt->whereClause != NULL)
+		return false;
+
+	if (IsTransactionBlock() || IsSubTransaction() ||
+		TransactionIdIsValid(GetTopTransactionIdIfAny()))
+		return false;
+
+	foreach (lc, stmt->options)
+	{
+		DefElem *defel = lfirst_node(DefElem, lc);
+
+		if (strcmp(defel->defname, "format") == 0 && strcmp(defGetString(defel), "binary") == 0)
+			return false;
+
+		if (strcmp(defel->defname, "force_not_null") == 0 ||
+			strcmp(defel->defname, "force_null") == 0)
+			return false;
+	}
+
+	if (trigdesc != NULL)
+	{
+		for (i = 0; i < trigdesc->numtriggers; i++)
+		{
+			/* Ignore the ts_insert_block trigger */
+			if (strncmp(trigdesc->triggers[i].tgname, INSERT_BLOCKER_NAME, NAMEDATALEN) != 0)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Set up the shared memory of a parallel COPY and launch the workers.
+ *
+ * Returns NULL if no worker could be launched.
+ */
+static ParallelCopyContext *
+parallel_copy_begin(Relation rel, List *attnums, int nworkers)
+{
+	ParallelCopyContext *pcxt;
+	ParallelCopyShared *shared;
+	shm_toc_estimator estimator;
+	shm_toc *toc;
+	Size shared_size;
+	Size guc_size;
+	Size segsize;
+	char *gucstate;
+	char *data_queues;
+	char *error_queues;
+	ListCell *lc;
+	int i;
+
+	shared_size = add_size(offsetof(ParallelCopyShared, attnums),
+						   mul_size(list_length(attnums), sizeof(AttrNumber)));
+	guc_size = EstimateGUCStateSpace();
+
+	shm_toc_initialize_estimator(&estimator);
+	shm_toc_estimate_chunk(&estimator, shared_size);
+	shm_toc_estimate_chunk(&estimator, guc_size);
+	shm_toc_estimate_chunk(&estimator, mul_size(nworkers, PARALLEL_COPY_QUEUE_SIZE));
+	shm_toc_estimate_chunk(&estimator, mul_size(nworkers, PARALLEL_COPY_ERROR_QUEUE_SIZE));
+	shm_toc_estimate_keys(&estimator, 4);
+	segsize = shm_toc_estimate(&estimator);
+
+	pcxt = palloc0(sizeof(ParallelCopyContext));
+	pcxt->workers = palloc0(sizeof(ParallelCopyWorker) * nworkers);
+	pcxt->error_context_stack = error_context_stack;
+	pcxt->seg = dsm_create(segsize, 0);
+	toc = shm_toc_create(PARALLEL_COPY_MAGIC, dsm_segment_address(pcxt->seg), segsize);
+
+	shared = shm_toc_allocate(toc, shared_size);
+	shared->database_id = MyDatabaseId;
+	shared->authenticated_user_id = GetAuthenticatedUserId();
+	GetUserIdAndSecContext(&shared->current_user_id, &shared->sec_context);
+	shared->relid = RelationGetRelid(rel);
+	pg_atomic_init_u64(&shared->processed, 0);
+	pg_atomic_init_u32(&shared->nfinished, 0);
+	shared->nattnums = 0;
+
+	foreach (lc, attnums)
+		shared->attnums[shared->nattnums++] = lfirst_int(lc);
+
+	shm_toc_insert(toc, PARALLEL_COPY_KEY_SHARED, shared);
+	pcxt->shared = shared;
+
+	gucstate = shm_toc_allocate(toc, guc_size);
+	SerializeGUCState(guc_size, gucstate);
+	shm_toc_insert(toc, PARALLEL_COPY_KEY_GUC, gucstate);
+
+	data_queues = shm_toc_allocate(toc, mul_size(nworkers, PARALLEL_COPY_QUEUE_SIZE));
+	shm_toc_insert(toc, PARALLEL_COPY_KEY_DATA_QUEUES, data_queues);
+	error_queues = shm_toc_allocate(toc, mul_size(nworkers, PARALLEL_COPY_ERROR_QUEUE_SIZE));
+	shm_toc_insert(toc, PARALLEL_COPY_KEY_ERROR_QUEUES, error_queues);
+
+	for (i = 0; i < nworkers; i++)
+	{
+		ParallelCopyWorker *worker = &pcxt->workers[i];
+		BackgroundWorker bgw = {
+			.bgw_flags = BGWORKER_SHMEM_ACCESS | BGWORKER_BACKEND_DATABASE_CONNECTION,
+			.bgw_start_time = BgWorkerStart_RecoveryFinished,
+			.bgw_restart_time = BGW_NEVER_RESTART,
+			.bgw_notify_pid = MyProcPid,
+			.bgw_main_arg = UInt32GetDatum(dsm_segment_handle(pcxt->seg)),
+		};
+		shm_mq *data_mq;
+		shm_mq *error_mq;
+
+		/* The queues need to exist before the worker starts */
+		data_mq = shm_mq_create(data_queues + (Size) i * PARALLEL_COPY_QUEUE_SIZE,
+								PARALLEL_COPY_QUEUE_SIZE);
+		shm_mq_set_sender(data_mq, MyProc);
+		error_mq = shm_mq_create(error_queues + (Size) i * PARALLEL_COPY_ERROR_QUEUE_SIZE,
+								 PARALLEL_COPY_ERROR_QUEUE_SIZE);
+		shm_mq_set_receiver(error_mq, MyProc);
+
+		snprintf(bgw.bgw_name,
+				 BGW_MAXLEN,
+				 "TimescaleDB parallel COPY worker for PID %d",
+				 MyProcPid);
+		strlcpy(bgw.bgw_type, "TimescaleDB parallel COPY worker", BGW_MAXLEN);
+		strlcpy(bgw.bgw_library_name, ts_extension_get_so_name(), BGW_MAXLEN);
+		strlcpy(bgw.bgw_function_name, PARALLEL_COPY_WORKER_MAIN, BGW_MAXLEN);
+		memcpy(bgw.bgw_extra, &i, sizeof(i));
+
+		if (!RegisterDynamicBackgroundWorker(&bgw, &worker->handle))
+			break;
+
+		worker->data_mqh = shm_mq_attach(data_mq, pcxt->seg, worker->handle);
+		worker->error_mqh = shm_mq_attach(error_mq, pcxt->seg, worker->handle);
+		initStringInfo(&worker->block);
+		pcxt->nworkers++;
+	}
+
+	if (pcxt->nworkers == 0)
+	{
+		ereport(NOTICE,
+				(errmsg("could not launch parallel COPY workers"),
+				 errdetail("The rows are inserted by a serial COPY instead.")));
+		dsm_detach(pcxt->seg);
+		pfree(pcxt->workers);
+		pfree(pcxt);
+		return NULL;
+	}
+
+	ereport(NOTICE,
+			(errmsg_plural("using %d parallel COPY worker",
+						   "using %d parallel COPY workers",
+						   pcxt->nworkers,
+						   pcxt->nworkers)));
+
+	return pcxt;
+}
+
+/*
+ * Rethrow an error, or print a notice, sent by a worker.
+ */
+static void
+parallel_copy_handle_message(ParallelCopyContext *pcxt, const char *data, Size nbytes)
+{
+	StringInfoData msg;
+	char msgtype;
+
+	initStringInfo(&msg);
+	appendBinaryStringInfo(&msg, data, nbytes);
+	msgtype = pq_getmsgbyte(&msg);
+
+	/* Other messages, like notifications, are ignored */
+	if (msgtype == 'E' || msgtype == 'N')
+	{
+		ErrorContextCallback *save_error_context_stack = error_context_stack;
+		ErrorData edata;
+
+		pq_parse_errornotice(&msg, &edata);
+
+		/* Death of a worker isn't enough justification for suicide */
+		edata.elevel = Min(edata.elevel, ERROR);
+
+		if (edata.context)
+			edata.context = psprintf("%s\n%s", edata.context, _("parallel COPY worker"));
+		else
+			edata.context = pstrdup(_("parallel COPY worker"));
+
+		/* The context of the leader, e.g., its line number, does not apply */
+		error_context_stack = pcxt->error_context_stack;
+		ThrowErrorData(&edata);
+		error_context_stack = save_error_context_stack;
+	}
+
+	pfree(msg.data);
+}
+
+static void
+parallel_copy_check_workers(ParallelCopyContext *pcxt)
+{
+	int i;
+
+	for (i = 0; i < pcxt->nworkers; i++)
+	{
+		ParallelCopyWorker *worker = &pcxt->workers[i];
+
+		while (worker->error_mqh != NULL)
+		{
+			shm_mq_result res;
+			Size nbytes;
+			void *data;
+
+			res = shm_mq_receive(worker->error_mqh, &nbytes, &data, true);
+
+			if (res == SHM_MQ_WOULD_BLOCK)
+				break;
+
+			if (res == SHM_MQ_DETACHED)
+			{
+				shm_mq_detach(worker->error_mqh);
+				worker->error_mqh = NULL;
+				break;
+			}
+
+			parallel_copy_handle_message(pcxt, data, nbytes);
+		}
+	}
+}
+
+/*
+ * Wait for the workers to receive data, send messages or exit.
+ */
+static void
+parallel_copy_wait(ParallelCopyContext *pcxt)
+{
+	(void) WaitLatch(MyLatch, WL_LATCH_SET | WL_EXIT_ON_PM_DEATH, -1L, PG_WAIT_EXTENSION);
+	ResetLatch(MyLatch);
+	CHECK_FOR_INTERRUPTS();
+	parallel_copy_check_workers(pcxt);
+}
+
+/*
+ * Continue to send the block of a worker without waiting.
+ *
+ * Returns true if the worker is not, or no longer, busy receiving a block.
+ */
+static bool
+parallel_copy_continue_send(ParallelCopyContext *pcxt, ParallelCopyWorker *worker)
+{
+	shm_mq_result res;
+
+	if (!worker->sending)
+		return true;
+
+	res = shm_mq_send_compat(worker->data_mqh, worker->block.len, worker->block.data, true);
+
+	if (res == SHM_MQ_WOULD_BLOCK)
+		return false;
+
+	if (res == SHM_MQ_DETACHED)
+	{
+		/* Report the error that made the worker exit, if there is one */
+		parallel_copy_check_workers(pcxt);
+		ereport(ERROR,
+				(errcode(ERRCODE_INTERNAL_ERROR),
+				 errmsg("lost connection to parallel COPY worker")));
+	}
+
+	worker->sending = false;
+	resetStringInfo(&worker->block);
+
+	return true;
+}
+
+/*
+ * Hand a block over to the next worker that is not busy receiving one.
+ *
+ * The block is swapped with the buffer of the worker, so that the data stays
+ * in place until the worker has received all of it, and the caller gets an
+ * empty buffer for the next block.
+ */
+static void
+parallel_copy_send_block(ParallelCopyContext *pcxt, StringInfo block)
+{
+	for (;;)
+	{
+		int i;
+
+		for (i = 0; i < pcxt->nworkers; i++)
+		{
+			int n = (pcxt->next_worker + i) % pcxt->nworkers;
+			ParallelCopyWorker *worker = &pcxt->workers[n];
+
+			if (parallel_copy_continue_send(pcxt, worker))
+			{
+				StringInfoData empty = worker->block;
+
+				worker->block = *block;
+				worker->sending = true;
+				*block = empty;
+				pcxt->next_worker = (n + 1) % pcxt->nworkers;
+				parallel_copy_continue_send(pcxt, worker);
+				return;
+			}
+		}
+
+		parallel_copy_wait(pcxt);
+	}
+}
+
+/*
+ * Send the remaining blocks and wait for the workers to insert them.
+ *
+ * Returns the number of inserted rows.
+ */
+static uint64
+parallel_copy_end(ParallelCopyContext *pcxt)
+{
+	uint64 processed;
+	bool busy;
+	int i;
+
+	for (;;)
+	{
+		busy = false;
+
+		for (i = 0; i < pcxt->nworkers; i++)
+			if (!parallel_copy_continue_send(pcxt, &pcxt->workers[i]))
+				busy = true;
+
+		if (!busy)
+			break;
+
+		parallel_copy_wait(pcxt);
+	}
+
+	/* Detaching from the queues tells the workers that there are no more blocks */
+	for (i = 0; i < pcxt->nworkers; i++)
+	{
+		shm_mq_detach(pcxt->workers[i].data_mqh);
+		pcxt->workers[i].data_mqh = NULL;
+	}
+
+	for (;;)
+	{
+		busy = false;
+
+		for (i = 0; i < pcxt->nworkers; i++)
+		{
+			BgwHandleStatus status;
+			pid_t pid;
+
+			status = GetBackgroundWorkerPid(pcxt->workers[i].handle, &pid);
+
+			if (status == BGWH_STARTED || status == BGWH_NOT_YET_STARTED)
+				busy = true;
+		}
+
+		if (!busy)
+			break;
+
+		parallel_copy_wait(pcxt);
+	}
+
+	/* Report the messages that the workers sent right before exiting */
+	parallel_copy_check_workers(pcxt);
+
+	if (pg_atomic_read_u32(&pcxt->shared->nfinished) != (uint32) pcxt->nworkers)
+		ereport(ERROR,
+				(errcode(ERRCODE_INTERNAL_ERROR),
+				 errmsg("lost connection to parallel COPY worker")));
+
+	processed = pg_atomic_read_u64(&pcxt->shared->processed);
+	dsm_detach(pcxt->seg);
+
+	return processed;
+}
+
+/*
+ * Stop the workers after an error and wait for them to exit, so that no
+ * further blocks are committed.
+ */
+static void
+parallel_copy_terminate(ParallelCopyContext *pcxt)
+{
+	int i;
+
+	for (i = 0; i < pcxt->nworkers; i++)
+	{
+		ParallelCopyWorker *worker = &pcxt->workers[i];
+
+		/* Do not leave a worker waiting for the leader to read its messages */
+		if (worker->error_mqh != NULL)
+		{
+			shm_mq_detach(worker->error_mqh);
+			worker->error_mqh = NULL;
+		}
+
+		TerminateBackgroundWorker(worker->handle);
+	}
+
+	for (i = 0; i < pcxt->nworkers; i++)
+		(void) WaitForBackgroundWorkerShutdown(pcxt->workers[i].handle);
+}
+
+/*
+ * Read the input of a COPY and send it to the workers in blocks of rows.
+ */
+static uint64
+parallel_copyfrom(ParallelCopyContext *pcxt, CopyFromState cstate)
+{
+	ErrorContextCallback errcallback = {
+		.callback = CopyFromErrorCallback,
+		.arg = cstate,
+	};
+	MemoryContext oldcontext = CurrentMemoryContext;
+	MemoryContext rowcontext;
+	StringInfoData block;
+	uint64 lineno = 0;
+	uint64 processed = 0;
+
+	rowcontext =
+		AllocSetContextCreate(CurrentMemoryContext, "parallel COPY row", ALLOCSET_DEFAULT_SIZES);
+	initStringInfo(&block);
+
+	PG_TRY();
+	{
+		errcallback.previous = error_context_stack;
+		error_context_stack = &errcallback;
+
+		for (;;)
+		{
+			MemoryContext rowoldcontext;
+			char **fields;
+			int nfields;
+			int32 nfields32;
+			bool found;
+			int i;
+
+			CHECK_FOR_INTERRUPTS();
+
+			MemoryContextReset(rowcontext);
+			rowoldcontext = MemoryContextSwitchTo(rowcontext);
+			found = NextCopyFromRawFields(cstate, &fields, &nfields);
+			MemoryContextSwitchTo(rowoldcontext);
+
+			if (!found)
+				break;
+
+#if PG14_GE
+			lineno = cstate->cur_lineno;
+#else
+			/* The line number is private before PG14, so use the row number */
+			lineno++;
+#endif
+			nfields32 = nfields;
+			appendBinaryStringInfo(&block, (const char *) &lineno, sizeof(lineno));
+			appendBinaryStringInfo(&block, (const char *) &nfields32, sizeof(nfields32));
+
+			for (i = 0; i < nfields; i++)
+			{
+				int32 len = (fields[i] == NULL) ? -1 : strlen(fields[i]);
+
+				appendBinaryStringInfo(&block, (const char *) &len, sizeof(len));
+
+				if (fields[i] != NULL)
+					appendBinaryStringInfo(&block, fields[i], len + 1);
+			}
+
+			if (block.len >= PARALLEL_COPY_BLOCK_SIZE)
+				parallel_copy_send_block(pcxt, &block);
+		}
+
+		error_context_stack = errcallback.previous;
+
+		if (block.len > 0)
+			parallel_copy_send_block(pcxt, &block);
+
+		processed = parallel_copy_end(pcxt);
+	}
+	PG_CATCH();
+	{
+		/* The blocks that the workers committed are not rolled back, so tell
+		 * how many rows were inserted before the error */
+		ErrorData *edata;
+		char *detail;
+
+		MemoryContextSwitchTo(oldcontext);
+		edata = CopyErrorData();
+		FlushErrorState();
+
+		parallel_copy_terminate(pcxt);
+
+		detail = psprintf("The parallel COPY workers committed " UINT64_FORMAT " rows.",
+						  pg_atomic_read_u64(&pcxt->shared->processed));
+
+		if (edata->detail != NULL)
+			edata->detail = psprintf("%s\n%s", edata->detail, detail);
+		else
+			edata->detail = detail;
+
+		ReThrowError(edata);
+	}
+	PG_END_TRY();
+
+	MemoryContextDelete(rowcontext);
+	pfree(block.data);
+
+	return processed;
+}
+
+/*
+ * Error context callback for the rows of a block in a worker.
+ *
+ * Tuples that are buffered for multi-inserts are written out after reading
+ * further rows, so the line number is only reported while reading a row.
+ */
+static void
+parallel_copy_block_error_callback(void *arg)
+{
+	ParallelCopyBlock *block = (ParallelCopyBlock *) arg;
+
+	if (!block->reading)
+		errcontext("COPY %s", block->relname);
+	else if (block->cur_attname != NULL)
+		errcontext("COPY %s, line " UINT64_FORMAT ", column %s",
+				   block->relname,
+				   block->lineno,
+				   block->cur_attname);
+	else
+		errcontext("COPY %s, line " UINT64_FORMAT, block->relname, block->lineno);
+}
+
+/*
+ * Look up the input functions of the columns and the default expressions of
+ * the columns that are not copied.
+ */
+static void
+parallel_copy_block_init(ParallelCopyBlock *block, Relation rel)
+{
+	TupleDesc tupdesc = RelationGetDescr(rel);
+	int natts = tupdesc->natts;
+	int i;
+
+	block->relname = RelationGetRelationName(rel);
+	block->in_functions = palloc(natts * sizeof(FmgrInfo));
+	block->typioparams = palloc(natts * sizeof(Oid));
+	block->defmap = palloc(natts * sizeof(int));
+	block->defexprs = palloc(natts * sizeof(ExprState *));
+	block->num_defaults = 0;
+
+	for (i = 0; i < natts; i++)
+	{
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, i);
+		bool copied = false;
+		Oid in_func_oid;
+		int j;
+
+		if (attr->attisdropped)
+			continue;
+
+		getTypeInputInfo(attr->atttypid, &in_func_oid, &block->typioparams[i]);
+		fmgr_info(in_func_oid, &block->in_functions[i]);
+
+		for (j = 0; j < block->shared->nattnums; j++)
+			if (block->shared->attnums[j] == attr->attnum)
+				copied = true;
+
+		if (!copied && !attr->attgenerated)
+		{
+			Expr *defexpr = (Expr *) build_column_default(rel, attr->attnum);
+
+			if (defexpr != NULL)
+			{
+				defexpr = expression_planner(defexpr);
+				block->defexprs[block->num_defaults] = ExecInitExpr(defexpr, NULL);
+				block->defmap[block->num_defaults] = i;
+				block->num_defaults++;
+			}
+		}
+	}
+}
+
+/*
+ * Read the next row of a block and convert its fields into a tuple, like
+ * NextCopyFrom() does for the fields it reads.
+ */
+static bool
+next_copy_from_block(CopyChunkState *ccstate, ExprContext *econtext, Datum *values, bool *nulls)
+{
+	ParallelCopyBlock *block = ccstate->block;
+	ParallelCopyShared *shared = block->shared;
+	TupleDesc tupdesc = RelationGetDescr(ccstate->rel);
+	int32 nfields;
+	int i;
+
+	if (block->offset >= block->len)
+		return false;
+
+	block->reading = true;
+	memcpy(&block->lineno, block->data + block->offset, sizeof(block->lineno));
+	block->offset += sizeof(block->lineno);
+	memcpy(&nfields, block->data + block->offset, sizeof(nfields));
+	block->offset += sizeof(nfields);
+
+	MemSet(values, 0, tupdesc->natts * sizeof(Datum));
+	MemSet(nulls, true, tupdesc->natts * sizeof(bool));
+
+	if (shared->nattnums > 0 && nfields > shared->nattnums)
+		ereport(ERROR,
+				(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+				 errmsg("extra data after last expected column")));
+
+	for (i = 0; i < shared->nattnums; i++)
+	{
+		int m = AttrNumberGetAttrOffset(shared->attnums[i]);
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, m);
+		char *string = NULL;
+		int32 len;
+
+		if (i >= nfields)
+			ereport(ERROR,
+					(errcode(ERRCODE_BAD_COPY_FILE_FORMAT),
+					 errmsg("missing data for column \"%s\"", NameStr(attr->attname))));
+
+		memcpy(&len, block->data + block->offset, sizeof(len));
+		block->offset += sizeof(len);
+
+		if (len >= 0)
+		{
+			string = (char *) block->data + block->offset;
+			block->offset += len + 1;
+		}
+
+		block->cur_attname = NameStr(attr->attname);
+		values[m] = InputFunctionCall(&block->in_functions[m],
+									  string,
+									  block->typioparams[m],
+									  attr->atttypmod);
+		nulls[m] = (string == NULL);
+		block->cur_attname = NULL;
+	}
+
+	for (i = 0; i < block->num_defaults; i++)
+		values[block->defmap[i]] =
+			ExecEvalExpr(block->defexprs[i], econtext, &nulls[block->defmap[i]]);
+
+	block->reading = false;
+
+	return true;
+}
+
+/*
+ * Insert the rows of a block in a transaction of its own.
+ */
+static void
+parallel_copy_insert_block(ParallelCopyShared *shared, const char *data, Size len)
+{
+	ParallelCopyBlock block = {
+		.data = data,
+		.len = len,
+		.shared = shared,
+	};
+	ErrorContextCallback errcallback = {
+		.callback = parallel_copy_block_error_callback,
+		.arg = &block,
+	};
+	CopyChunkState *ccstate;
+	ParseState *pstate;
+	Relation rel;
+	Hypertable *ht;
+	Cache *hcache;
+	List *attnums = NIL;
+	uint64 processed;
+	int i;
+
+	StartTransactionCommand();
+	PushActiveSnapshot(GetTransactionSnapshot());
+
+	rel = table_open(shared->relid, RowExclusiveLock);
+	ht = ts_hypertable_cache_get_cache_and_entry(shared->relid, CACHE_FLAG_NONE, &hcache);
+
+	for (i = 0; i < shared->nattnums; i++)
+		attnums = lappend_int(attnums, shared->attnums[i]);
+
+	pstate = make_parsestate(NULL);
+	copy_constraints_and_check(pstate, rel, attnums);
+	parallel_copy_block_init(&block, rel);
+
+	errcallback.previous = error_context_stack;
+	error_context_stack = &errcallback;
+
+	ccstate = copy_chunk_state_create(ht, rel, next_copy_from_block, NULL, NULL);
+	ccstate->block = &block;
+	processed = copyfrom(ccstate, pstate->p_rtable, ht, CurrentMemoryContext, NULL, NULL);
+	copy_chunk_state_destroy(ccstate);
+
+	error_context_stack = errcallback.previous;
+
+	free_parsestate(pstate);
+	table_close(rel, NoLock);
+	ts_cache_release(hcache);
+
+	/* Count the rows of a committed block even if the leader terminates us */
+	HOLD_INTERRUPTS();
+	PopActiveSnapshot();
+	CommitTransactionCommand();
+	pg_atomic_fetch_add_u64(&shared->processed, processed);
+	RESUME_INTERRUPTS();
+}
+
+TS_FUNCTION_INFO_V1(ts_copy_worker_main);
+
+/*
+ * Entrypoint of the background workers of a parallel COPY.
+ */
+Datum
+ts_copy_worker_main(PG_FUNCTION_ARGS)
+{
+	dsm_handle handle = DatumGetUInt32(MyBgworkerEntry->bgw_main_arg);
+	ParallelCopyShared *shared;
+	dsm_segment *seg;
+	shm_toc *toc;
+	shm_mq *mq;
+	shm_mq_handle *mqh;
+	int worker_number;
+
+	memcpy(&worker_number, MyBgworkerEntry->bgw_extra, sizeof(worker_number));
+
+	BackgroundWorkerBlockSignals();
+	pqsignal(SIGTERM, die);
+	BackgroundWorkerUnblockSignals();
+
+	seg = dsm_attach(handle);
+
+	if (seg == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("could not map dynamic shared memory segment")));
+
+	toc = shm_toc_attach(PARALLEL_COPY_MAGIC, dsm_segment_address(seg));
+
+	if (toc == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("invalid magic number in dynamic shared memory segment")));
+
+	/* Send errors and notices to the leader from here on */
+	mq = (shm_mq *) ((char *) shm_toc_lookup(toc, PARALLEL_COPY_KEY_ERROR_QUEUES, false) +
+					 (Size) worker_number * PARALLEL_COPY_ERROR_QUEUE_SIZE);
+	shm_mq_set_sender(mq, MyProc);
+	pq_redirect_to_shm_mq(seg, shm_mq_attach(mq, seg, NULL));
+
+	shared = shm_toc_lookup(toc, PARALLEL_COPY_KEY_SHARED, false);
+	BackgroundWorkerInitializeConnectionByOid(shared->database_id,
+											  shared->authenticated_user_id,
+											  0);
+	ts_license_enable_module_loading();
+
+	/* Parse the input with the settings of the leader, e.g., its DateStyle */
+	StartTransactionCommand();
+	RestoreGUCState(shm_toc_lookup(toc, PARALLEL_COPY_KEY_GUC, false));
+	CommitTransactionCommand();
+
+	SetUserIdAndSecContext(shared->current_user_id, shared->sec_context);
+
+	mq = (shm_mq *) ((char *) shm_toc_lookup(toc, PARALLEL_COPY_KEY_DATA_QUEUES, false) +
+					 (Size) worker_number * PARALLEL_COPY_QUEUE_SIZE);
+	shm_mq_set_receiver(mq, MyProc);
+	mqh = shm_mq_attach(mq, seg, NULL);
+
+	/* Insert blocks until the leader detaches from the queue */
+	for (;;)
+	{
+		Size nbytes;
+		void *data;
+
+		if (shm_mq_receive(mqh, &nbytes, &data, false) != SHM_MQ_SUCCESS)
+			break;
+
+		parallel_copy_insert_block(shared, data, nbytes);
+	}
+
+	pg_atomic_fetch_add_u32(&shared->nfinished, 1);
+
+	PG_RETURN_VOID();
+}
+
 void
 timescaledb_DoCopy(const CopyStmt *stmt, const char *queryString, uint64 *processed, Hypertable *ht)
 {
@@ -1338,6 +2858,7 @@ timescaledb_DoCopy(const CopyStmt *stmt, const char *queryString, uint64 *proces
 	Node *where_clause = NULL;
 	ParseState *pstate;
 	MemoryContext copycontext = NULL;
+	ParallelCopyContext *pcxt = NULL;
 
 	/* Disallow COPY to/from file or program except to superusers. */
 	if (!pipe && !superuser())
@@ -1407,8 +2928,13 @@ timescaledb_DoCopy(const CopyStmt *stmt, const char *queryString, uint64 *proces
 	ccstate = copy_chunk_state_create(ht, rel, next_copy_from, cstate, NULL);
 	ccstate->where_clause = where_clause;
 
+	if (copy_use_parallel_workers(stmt, rel, ht))
+		pcxt = parallel_copy_begin(rel, attnums, ts_guc_max_parallel_copy_workers);
+
 	if (hypertable_is_distributed(ht))
 		*processed = ts_cm_functions->distributed_copy(stmt, ccstate, attnums);
+	else if (pcxt != NULL)
+		*processed = parallel_copyfrom(pcxt, cstate);
 	else
 	{
 #if PG14_GE
@@ -17,6 +17,7 @@
 typedef struct ChunkDispatch ChunkDispatch;
 typedef struct CopyChunkState CopyChunkState;
 typedef struct Hypertable Hypertable;
+typedef struct ParallelCopyBlock ParallelCopyBlock;
 
 typedef bool (*CopyFromFunc)(CopyChunkState *ccstate, ExprContext *econtext, Datum *values,
 							 bool *nulls);
@@ -29,6 +30,7 @@ typedef struct CopyChunkState
 	CopyFromFunc next_copy_from;
 	CopyFromState cstate;
 	TableScanDesc scandesc;
+	ParallelCopyBlock *block;
 	Node *where_clause;
 } CopyChunkState;
 
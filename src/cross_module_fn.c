@@ -25,6 +25,10 @@
 	}
 
 /* bgw policy functions */
+CROSSMODULE_WRAPPER(policy_chunk_precreation_add);
+CROSSMODULE_WRAPPER(policy_chunk_precreation_proc);
+CROSSMODULE_WRAPPER(policy_chunk_precreation_check);
+CROSSMODULE_WRAPPER(policy_chunk_precreation_remove);
 CROSSMODULE_WRAPPER(policy_compression_add);
 CROSSMODULE_WRAPPER(policy_compression_remove);
 CROSSMODULE_WRAPPER(policy_recompression_proc);
@@ -41,6 +45,10 @@ CROSSMODULE_WRAPPER(policy_retention_add);
 CROSSMODULE_WRAPPER(policy_retention_proc);
 CROSSMODULE_WRAPPER(policy_retention_check);
 CROSSMODULE_WRAPPER(policy_retention_remove);
+CROSSMODULE_WRAPPER(policy_staging_add);
+CROSSMODULE_WRAPPER(policy_staging_proc);
+CROSSMODULE_WRAPPER(policy_staging_check);
+CROSSMODULE_WRAPPER(policy_staging_remove);
 
 CROSSMODULE_WRAPPER(job_add);
 CROSSMODULE_WRAPPER(job_delete);
@@ -336,6 +344,14 @@ continuous_agg_call_invalidation_trigger_default(int32 hypertable_id, Relation c
 	pg_unreachable();
 }
 
+static void
+continuous_agg_invalidate_inserted_range_default(int32 hypertable_id, int32 entry_id, int64 lowest,
+												 int64 greatest)
+{
+	error_no_default_fn_community();
+	pg_unreachable();
+}
+
 static Datum
 empty_fn(PG_FUNCTION_ARGS)
 {
@@ -438,6 +454,10 @@ TSDLLEXPORT CrossModuleFunctions ts_cm_functions_default = {
 	.gapfill_timestamptz_timezone_time_bucket = error_no_default_fn_pg_community,
 
 	/* bgw policies */
+	.policy_chunk_precreation_add = error_no_default_fn_pg_community,
+	.policy_chunk_precreation_proc = error_no_default_fn_pg_community,
+	.policy_chunk_precreation_check = error_no_default_fn_pg_community,
+	.policy_chunk_precreation_remove = error_no_default_fn_pg_community,
 	.policy_compression_add = error_no_default_fn_pg_community,
 	.policy_compression_remove = error_no_default_fn_pg_community,
 	.policy_recompression_proc = error_no_default_fn_pg_community,
@@ -454,6 +474,10 @@ TSDLLEXPORT CrossModuleFunctions ts_cm_functions_default = {
 	.policy_retention_proc = error_no_default_fn_pg_community,
 	.policy_retention_check = error_no_default_fn_pg_community,
 	.policy_retention_remove = error_no_default_fn_pg_community,
+	.policy_staging_add = error_no_default_fn_pg_community,
+	.policy_staging_proc = error_no_default_fn_pg_community,
+	.policy_staging_check = error_no_default_fn_pg_community,
+	.policy_staging_remove = error_no_default_fn_pg_community,
 
 	.job_add = error_no_default_fn_pg_community,
 	.job_alter = error_no_default_fn_pg_community,
@@ -481,10 +505,12 @@ TSDLLEXPORT CrossModuleFunctions ts_cm_functions_default = {
 	.process_cagg_viewstmt = process_cagg_viewstmt_default,
 	.continuous_agg_invalidation_trigger = error_no_default_fn_pg_community,
 	.continuous_agg_call_invalidation_trigger = continuous_agg_call_invalidation_trigger_default,
+	.continuous_agg_invalidate_inserted_range = continuous_agg_invalidate_inserted_range_default,
 	.continuous_agg_refresh = error_no_default_fn_pg_community,
 	.continuous_agg_invalidate_raw_ht = continuous_agg_invalidate_raw_ht_all_default,
 	.continuous_agg_invalidate_mat_ht = continuous_agg_invalidate_mat_ht_all_default,
 	.continuous_agg_update_options = continuous_agg_update_options_default,
+	.continuous_agg_route_query = NULL,
 	.invalidation_cagg_log_add_entry = error_no_default_fn_pg_community,
 	.invalidation_hyper_log_add_entry = error_no_default_fn_pg_community,
 	.remote_invalidation_log_delete = NULL,
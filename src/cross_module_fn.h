@@ -40,6 +40,10 @@ typedef struct CrossModuleFunctions
 {
 	void (*add_tsl_telemetry_info)(JsonbParseState **parse_state);
 
+	PGFunction policy_chunk_precreation_add;
+	PGFunction policy_chunk_precreation_proc;
+	PGFunction policy_chunk_precreation_check;
+	PGFunction policy_chunk_precreation_remove;
 	PGFunction policy_compression_add;
 	PGFunction policy_compression_remove;
 	PGFunction policy_recompression_proc;
@@ -56,6 +60,10 @@ typedef struct CrossModuleFunctions
 	PGFunction policy_retention_proc;
 	PGFunction policy_retention_check;
 	PGFunction policy_retention_remove;
+	PGFunction policy_staging_add;
+	PGFunction policy_staging_proc;
+	PGFunction policy_staging_check;
+	PGFunction policy_staging_remove;
 
 	PGFunction policies_add;
 	PGFunction policies_remove;
@@ -110,12 +118,15 @@ typedef struct CrossModuleFunctions
 													 HeapTuple chunk_newtuple, bool update,
 													 bool is_distributed_hypertable_trigger,
 													 int32 parent_hypertable_id);
+	void (*continuous_agg_invalidate_inserted_range)(int32 hypertable_id, int32 entry_id,
+													 int64 lowest, int64 greatest);
 	PGFunction continuous_agg_refresh;
 	void (*continuous_agg_invalidate_raw_ht)(const Hypertable *raw_ht, int64 start, int64 end);
 	void (*continuous_agg_invalidate_mat_ht)(const Hypertable *raw_ht, const Hypertable *mat_ht,
 											 int64 start, int64 end);
 	void (*continuous_agg_update_options)(ContinuousAgg *cagg,
 										  WithClauseResult *with_clause_options);
+	bool (*continuous_agg_route_query)(Query *query);
 	PGFunction invalidation_cagg_log_add_entry;
 	PGFunction invalidation_hyper_log_add_entry;
 	void (*remote_invalidation_log_delete)(int32 raw_hypertable_id,
@@ -957,48 +957,98 @@ ts_point_create(int16 num_dimensions)
 	return p;
 }
 
+static inline int64
+dimension_calculate_coordinate(const Dimension *d, Oid dimtype, TupleTableSlot *slot)
+{
+	Datum datum;
+	bool isnull;
+
+	if (NULL != d->partitioning)
+		datum = ts_partitioning_func_apply_slot(d->partitioning, slot, &isnull);
+	else
+		datum = slot_getattr(slot, d->column_attno, &isnull);
+
+	switch (d->type)
+	{
+		case DIMENSION_TYPE_OPEN:
+			if (isnull)
+				ereport(ERROR,
+						(errcode(ERRCODE_NOT_NULL_VIOLATION),
+						 errmsg("NULL value in column \"%s\" violates not-null constraint",
+								NameStr(d->fd.column_name)),
+						 errhint("Columns used for time partitioning cannot be NULL.")));
+
+			return ts_time_value_to_internal(datum, dimtype);
+		case DIMENSION_TYPE_CLOSED:
+			return (int64) DatumGetInt32(datum);
+		case DIMENSION_TYPE_ANY:
+			break;
+	}
+
+	elog(ERROR, "invalid dimension type when inserting tuple");
+	pg_unreachable();
+}
+
 TSDLLEXPORT Point *
 ts_hyperspace_calculate_point(const Hyperspace *hs, TupleTableSlot *slot)
 {
 	Point *p = ts_point_create(hs->num_dimensions);
+
+	ts_hyperspace_fill_point(hs, slot, p);
+
+	return p;
+}
+
+/*
+ * Calculate the point of a tuple in a point allocated by the caller, so that
+ * the same point can be reused for every tuple of an insert.
+ */
+TSDLLEXPORT void
+ts_hyperspace_fill_point(const Hyperspace *hs, TupleTableSlot *slot, Point *p)
+{
 	int i;
 
+	Assert(p->cardinality == hs->num_dimensions);
+	p->num_coords = 0;
+
 	for (i = 0; i < hs->num_dimensions; i++)
 	{
 		const Dimension *d = &hs->dimensions[i];
-		Datum datum;
-		bool isnull;
-		Oid dimtype;
+		Oid dimtype = IS_OPEN_DIMENSION(d) ? ts_dimension_get_partition_type(d) : InvalidOid;
 
-		if (NULL != d->partitioning)
-			datum = ts_partitioning_func_apply_slot(d->partitioning, slot, &isnull);
-		else
-			datum = slot_getattr(slot, d->column_attno, &isnull);
+		p->coordinates[p->num_coords++] = dimension_calculate_coordinate(d, dimtype, slot);
+	}
+}
 
-		switch (d->type)
-		{
-			case DIMENSION_TYPE_OPEN:
-				dimtype = ts_dimension_get_partition_type(d);
-
-				if (isnull)
-					ereport(ERROR,
-							(errcode(ERRCODE_NOT_NULL_VIOLATION),
-							 errmsg("NULL value in column \"%s\" violates not-null constraint",
-									NameStr(d->fd.column_name)),
-							 errhint("Columns used for time partitioning cannot be NULL.")));
-
-				p->coordinates[p->num_coords++] = ts_time_value_to_internal(datum, dimtype);
-				break;
-			case DIMENSION_TYPE_CLOSED:
-				p->coordinates[p->num_coords++] = (int64) DatumGetInt32(datum);
-				break;
-			case DIMENSION_TYPE_ANY:
-				elog(ERROR, "invalid dimension type when inserting tuple");
-				break;
-		}
+/*
+ * Calculate the points of a batch of tuples.
+ *
+ * The tuples are processed one dimension at a time, so that the dimension is
+ * only resolved once per batch. The points are allocated in one chunk of
+ * memory.
+ */
+TSDLLEXPORT void
+ts_hyperspace_calculate_points(const Hyperspace *hs, TupleTableSlot **slots, int nslots,
+							   Point **points)
+{
+	char *data = palloc0(POINT_SIZE(hs->num_dimensions) * nslots);
+	int i, j;
+
+	for (j = 0; j < nslots; j++)
+	{
+		points[j] = (Point *) (data + POINT_SIZE(hs->num_dimensions) * j);
+		points[j]->cardinality = hs->num_dimensions;
+		points[j]->num_coords = hs->num_dimensions;
 	}
 
-	return p;
+	for (i = 0; i < hs->num_dimensions; i++)
+	{
+		const Dimension *d = &hs->dimensions[i];
+		Oid dimtype = IS_OPEN_DIMENSION(d) ? ts_dimension_get_partition_type(d) : InvalidOid;
+
+		for (j = 0; j < nslots; j++)
+			points[j]->coordinates[i] = dimension_calculate_coordinate(d, dimtype, slots[j]);
+	}
 }
 
 static inline int64
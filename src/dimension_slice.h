@@ -48,7 +48,7 @@ extern DimensionVec *ts_dimension_slice_scan_limit(int32 dimension_id, int64 coo
 extern void ts_dimension_slice_scan_list(int32 dimension_id, int64 coordinate,
 										 List **matching_dimension_slices);
 
-extern DimensionVec *
+extern TSDLLEXPORT DimensionVec *
 ts_dimension_slice_scan_range_limit(int32 dimension_id, StrategyNumber start_strategy,
 									int64 start_value, StrategyNumber end_strategy, int64 end_value,
 									int limit, const ScanTupLock *tuplock);
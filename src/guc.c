@@ -6,6 +6,7 @@
 #include <postgres.h>
 #include <utils/guc.h>
 #include <miscadmin.h>
+#include <postmaster/bgworker_internals.h>
 
 #include "guc.h"
 #include "license_guc.h"
@@ -73,9 +74,16 @@ bool ts_guc_enable_runtime_exclusion = true;
 bool ts_guc_enable_constraint_exclusion = true;
 bool ts_guc_enable_qual_propagation = true;
 bool ts_guc_enable_cagg_reorder_groupby = true;
+TSDLLEXPORT bool ts_guc_enable_cagg_delta_refresh = false;
+TSDLLEXPORT bool ts_guc_enable_cagg_refresh_cascade = false;
+TSDLLEXPORT int ts_guc_cagg_refresh_cascade_max_depth = 10;
+bool ts_guc_enable_cagg_query_routing = false;
+TSDLLEXPORT int ts_guc_cagg_refresh_window_buckets = 0;
 bool ts_guc_enable_now_constify = true;
 bool ts_guc_enable_osm_reads = true;
+bool ts_guc_explain_planning = false;
 TSDLLEXPORT bool ts_guc_enable_dml_decompression = true;
+bool ts_guc_enable_buffered_insert = true;
 TSDLLEXPORT bool ts_guc_enable_transparent_decompression = true;
 TSDLLEXPORT bool ts_guc_enable_decompression_sorted_merge = true;
 bool ts_guc_enable_per_data_node_queries = true;
@@ -86,6 +94,13 @@ TSDLLEXPORT bool ts_guc_enable_bulk_decompression = true;
 TSDLLEXPORT bool ts_guc_enable_skip_scan = true;
 int ts_guc_max_open_chunks_per_insert; /* default is computed at runtime */
 int ts_guc_max_cached_chunks_per_hypertable = 100;
+int ts_guc_max_open_chunks_memory_per_insert = 0;
+int ts_guc_copy_buffer_memory = 1024;
+int ts_guc_max_parallel_copy_workers = 0;
+bool ts_guc_enable_nonatomic_parallel_copy = false;
+int ts_guc_copy_sort_memory = 0;
+bool ts_guc_copy_defer_chunk_indexes = false;
+bool ts_guc_track_insert_stats = false;
 #ifdef USE_TELEMETRY
 TelemetryLevel ts_guc_telemetry_level = TELEMETRY_DEFAULT;
 char *ts_telemetry_cloud = NULL;
@@ -282,6 +297,19 @@ _guc_init(void)
 							 NULL,
 							 NULL);
 
+	DefineCustomBoolVariable("timescaledb.enable_buffered_insert",
+							 "Enable buffered multi-row inserts",
+							 "Buffer the rows of INSERT statements per chunk and write them with "
+							 "multi-row inserts, like COPY does, when no row triggers, RETURNING "
+							 "or ON CONFLICT require inserting them one at a time",
+							 &ts_guc_enable_buffered_insert,
+							 true,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
 	DefineCustomBoolVariable("timescaledb.enable_transparent_decompression",
 							 "Enable transparent decompression",
 							 "Enable transparent decompression when querying hypertable",
@@ -327,6 +355,45 @@ _guc_init(void)
 							 NULL,
 							 NULL);
 
+	DefineCustomBoolVariable("timescaledb.enable_cagg_delta_refresh",
+							 "Enable delta refresh of continuous aggregates",
+							 "Only insert and delete the materialized rows that changed when "
+							 "refreshing a continuous aggregate, instead of replacing all rows "
+							 "in the refreshed range",
+							 &ts_guc_enable_cagg_delta_refresh,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomBoolVariable("timescaledb.enable_cagg_refresh_cascade",
+							 "Enable cascading refresh of continuous aggregates",
+							 "After refreshing a continuous aggregate, refresh the continuous "
+							 "aggregates defined on top of it in the materialized range",
+							 &ts_guc_enable_cagg_refresh_cascade,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomBoolVariable("timescaledb.enable_cagg_query_routing",
+							 "Enable routing of aggregate queries to continuous aggregates",
+							 "Answer aggregate queries on hypertables from a real-time continuous "
+							 "aggregate with the same or finer buckets, if it has the grouping "
+							 "columns and aggregates of the query, and if its materialization has "
+							 "no pending invalidations in the time range of the query",
+							 &ts_guc_enable_cagg_query_routing,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
 	DefineCustomBoolVariable("timescaledb.enable_now_constify",
 							 "Enable now() constify",
 							 "Enable constifying now() in query constraints",
@@ -338,6 +405,18 @@ _guc_init(void)
 							 NULL,
 							 NULL);
 
+	DefineCustomBoolVariable("timescaledb.explain_planning",
+							 "Show hypertable planning statistics in EXPLAIN",
+							 "Report catalog scans, dimension slices, chunk exclusion and "
+							 "planning times per hypertable in EXPLAIN output",
+							 &ts_guc_explain_planning,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
 	DefineCustomBoolVariable("timescaledb.enable_2pc",
 							 "Enable two-phase commit",
 							 "Enable two-phase commit on distributed hypertables",
@@ -539,6 +618,135 @@ _guc_init(void)
 							assign_max_open_chunks_per_insert_hook,
 							NULL);
 
+	DefineCustomIntVariable("timescaledb.max_open_chunks_memory_per_insert",
+							"Maximum memory of open chunks per insert",
+							"Maximum amount of memory used by open chunk tables per insert. "
+							"Least recently used chunks are closed when the limit is exceeded. "
+							"0 means no limit",
+							&ts_guc_max_open_chunks_memory_per_insert,
+							0,
+							0,
+							MAX_KILOBYTES,
+							PGC_USERSET,
+							GUC_UNIT_KB,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomIntVariable("timescaledb.copy_buffer_memory",
+							"Memory budget for COPY buffers",
+							"Maximum amount of memory used by the buffers that COPY keeps for "
+							"multi-inserts into chunks, including the buffered tuples and their "
+							"slots. The buffers of the chunks are sized according to the width "
+							"of the copied tuples within this budget",
+							&ts_guc_copy_buffer_memory,
+							1024,
+							64,
+							MAX_KILOBYTES,
+							PGC_USERSET,
+							GUC_UNIT_KB,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomIntVariable("timescaledb.max_parallel_copy_workers",
+							"Maximum number of parallel COPY workers",
+							"Maximum number of background workers that insert the rows of a COPY "
+							"into a hypertable when non-atomic parallel COPY is enabled. "
+							"0 disables parallel COPY",
+							&ts_guc_max_parallel_copy_workers,
+							0,
+							0,
+							MAX_PARALLEL_WORKER_LIMIT,
+							PGC_USERSET,
+							0,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomBoolVariable("timescaledb.enable_nonatomic_parallel_copy",
+							 "Enable non-atomic parallel COPY",
+							 "Allow COPY into a hypertable to use parallel workers. The workers "
+							 "insert blocks of rows in transactions of their own, so a failing "
+							 "COPY keeps the blocks that were already committed",
+							 &ts_guc_enable_nonatomic_parallel_copy,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomIntVariable("timescaledb.copy_sort_memory",
+							"Memory for grouping COPY rows by chunk",
+							"Amount of memory used to read ahead the rows of a COPY into a "
+							"hypertable, which are sorted by chunk and time before they are "
+							"inserted. 0 inserts the rows in input order",
+							&ts_guc_copy_sort_memory,
+							0,
+							0,
+							MAX_KILOBYTES,
+							PGC_USERSET,
+							GUC_UNIT_KB,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomBoolVariable("timescaledb.copy_defer_chunk_indexes",
+							 "Build the indexes of chunks created by COPY at the end",
+							 "Do not maintain the non-unique indexes of chunks created by a COPY "
+							 "row by row, but build them in bulk at the end of the COPY. Chunks "
+							 "with row triggers are not affected",
+							 &ts_guc_copy_defer_chunk_indexes,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomBoolVariable("timescaledb.track_insert_stats",
+							 "Collect latency statistics of the insert path",
+							 "Time the stages of inserts into hypertables, such as chunk routing "
+							 "and index inserts, and collect them per hypertable",
+							 &ts_guc_track_insert_stats,
+							 false,
+							 PGC_USERSET,
+							 0,
+							 NULL,
+							 NULL,
+							 NULL);
+
+	DefineCustomIntVariable("timescaledb.cagg_refresh_window_buckets",
+							"Buckets per continuous aggregate refresh window",
+							"Refresh continuous aggregates one window after another, each "
+							"covering at most this many buckets of data and committed in its own "
+							"transaction. Zero refreshes all invalidations in a single "
+							"transaction",
+							&ts_guc_cagg_refresh_window_buckets,
+							0,
+							0,
+							INT_MAX,
+							PGC_USERSET,
+							0,
+							NULL,
+							NULL,
+							NULL);
+
+	DefineCustomIntVariable("timescaledb.cagg_refresh_cascade_max_depth",
+							"Maximum depth of cascading continuous aggregate refreshes",
+							"Number of levels of continuous aggregates on top of the refreshed "
+							"one that a cascading refresh reaches",
+							&ts_guc_cagg_refresh_cascade_max_depth,
+							10,
+							1,
+							100,
+							PGC_USERSET,
+							0,
+							NULL,
+							NULL,
+							NULL);
+
 	DefineCustomIntVariable("timescaledb.max_cached_chunks_per_hypertable",
 							"Maximum cached chunks",
 							"Maximum number of chunks stored in the cache",
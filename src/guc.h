@@ -24,9 +24,16 @@ extern bool ts_guc_enable_qual_propagation;
 extern bool ts_guc_enable_runtime_exclusion;
 extern bool ts_guc_enable_constraint_exclusion;
 extern bool ts_guc_enable_cagg_reorder_groupby;
+extern TSDLLEXPORT bool ts_guc_enable_cagg_delta_refresh;
+extern TSDLLEXPORT bool ts_guc_enable_cagg_refresh_cascade;
+extern TSDLLEXPORT int ts_guc_cagg_refresh_cascade_max_depth;
+extern bool ts_guc_enable_cagg_query_routing;
+extern TSDLLEXPORT int ts_guc_cagg_refresh_window_buckets;
 extern bool ts_guc_enable_now_constify;
 extern bool ts_guc_enable_osm_reads;
+extern bool ts_guc_explain_planning;
 extern TSDLLEXPORT bool ts_guc_enable_dml_decompression;
+extern bool ts_guc_enable_buffered_insert;
 extern TSDLLEXPORT bool ts_guc_enable_transparent_decompression;
 extern TSDLLEXPORT bool ts_guc_enable_decompression_sorted_merge;
 extern TSDLLEXPORT bool ts_guc_enable_per_data_node_queries;
@@ -36,6 +43,13 @@ extern TSDLLEXPORT bool ts_guc_enable_skip_scan;
 extern bool ts_guc_restoring;
 extern int ts_guc_max_open_chunks_per_insert;
 extern int ts_guc_max_cached_chunks_per_hypertable;
+extern int ts_guc_copy_buffer_memory;
+extern int ts_guc_max_parallel_copy_workers;
+extern bool ts_guc_enable_nonatomic_parallel_copy;
+extern int ts_guc_copy_sort_memory;
+extern bool ts_guc_copy_defer_chunk_indexes;
+extern bool ts_guc_track_insert_stats;
+extern int ts_guc_max_open_chunks_memory_per_insert;
 
 #ifdef USE_TELEMETRY
 typedef enum TelemetryLevel
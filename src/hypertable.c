@@ -250,7 +250,10 @@ ts_hypertable_from_tupleinfo(const TupleInfo *ti)
 		ts_get_relation_relid(NameStr(h->fd.schema_name), NameStr(h->fd.table_name), true);
 	h->space = ts_dimension_scan(h->fd.id, h->main_table_relid, h->fd.num_dimensions, ti->mctx);
 	h->chunk_cache =
-		ts_subspace_store_init(h->space, ti->mctx, ts_guc_max_cached_chunks_per_hypertable);
+		ts_subspace_store_init("hypertable_chunks",
+							   h->space,
+							   ti->mctx,
+							   ts_guc_max_cached_chunks_per_hypertable);
 	h->chunk_sizing_func = get_chunk_sizing_func_oid(&h->fd);
 	h->data_nodes = ts_hypertable_data_node_scan(h->fd.id, ti->mctx);
 
@@ -1127,6 +1130,101 @@ ts_hypertable_find_chunk_for_point(const Hypertable *h, const Point *point)
 	return cached_chunk;
 }
 
+/*
+ * Create the chunks for a point in all closed (space) dimensions, starting at
+ * the given dimension.
+ *
+ * The point's coordinates in the open dimension must already be set. The end
+ * of the open dimension range of the chunks is returned in range_end (the
+ * smallest one, in case the chunks are not aligned).
+ */
+static int
+hypertable_create_chunks_for_point(const Hypertable *h, Point *point, int dimension_index,
+								   int64 *range_end)
+{
+	const Dimension *dim;
+	int64 value = 0;
+	int num_created = 0;
+
+	if (dimension_index == h->space->num_dimensions)
+	{
+		const Dimension *open_dim = hyperspace_get_open_dimension(h->space, 0);
+		const DimensionSlice *slice;
+		Chunk *chunk = ts_hypertable_find_chunk_for_point(h, point);
+		bool found = true;
+
+		if (chunk == NULL)
+			chunk = ts_hypertable_create_chunk_for_point(h, point, &found);
+
+		slice = ts_hypercube_get_slice_by_dimension_id(chunk->cube, open_dim->fd.id);
+		Assert(slice != NULL);
+
+		if (slice->fd.range_end < *range_end)
+			*range_end = slice->fd.range_end;
+
+		return found ? 0 : 1;
+	}
+
+	dim = &h->space->dimensions[dimension_index];
+
+	if (IS_OPEN_DIMENSION(dim))
+		return hypertable_create_chunks_for_point(h, point, dimension_index + 1, range_end);
+
+	/* Create a chunk for every slice of the closed dimension */
+	for (;;)
+	{
+		DimensionSlice *slice = ts_dimension_calculate_default_slice(dim, value);
+
+		point->coordinates[dimension_index] = value;
+		num_created += hypertable_create_chunks_for_point(h, point, dimension_index + 1, range_end);
+
+		if (slice->fd.range_end == DIMENSION_SLICE_MAXVALUE)
+			break;
+
+		value = slice->fd.range_end;
+	}
+
+	return num_created;
+}
+
+/*
+ * Create all chunks covering the given time in the hypertable's open
+ * (time) dimension, one for each combination of closed (space) dimension
+ * slices, unless they already exist.
+ *
+ * Chunks are created the same way as when inserting data, so the interval of
+ * new chunks is computed by adaptive chunking, if enabled.
+ *
+ * Returns the number of chunks created. The end of the time range covered by
+ * the chunks is returned in range_end, which can be used to create the
+ * chunks for the subsequent time range.
+ */
+int
+ts_hypertable_create_chunks_for_time(const Hypertable *h, int64 time, int64 *range_end)
+{
+	Point *point = ts_point_create(h->space->num_dimensions);
+	int i;
+
+	for (i = 0; i < h->space->num_dimensions; i++)
+	{
+		const Dimension *dim = &h->space->dimensions[i];
+
+		if (IS_OPEN_DIMENSION(dim) && dim != hyperspace_get_open_dimension(h->space, 0))
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("cannot create chunks ahead of time for hypertable \"%s\"",
+							get_rel_name(h->main_table_relid)),
+					 errdetail("The hypertable has more than one open dimension.")));
+
+		point->coordinates[i] = IS_OPEN_DIMENSION(dim) ? time : 0;
+	}
+
+	point->num_coords = h->space->num_dimensions;
+	*range_end = DIMENSION_SLICE_MAXVALUE;
+
+	return hypertable_create_chunks_for_point(h, point, 0, range_end);
+}
+
 bool
 ts_hypertable_has_tablespace(const Hypertable *ht, Oid tspc_oid)
 {
@@ -136,6 +136,8 @@ extern TSDLLEXPORT Chunk *ts_hypertable_find_chunk_for_point(const Hypertable *h
 															 const Point *point);
 extern TSDLLEXPORT Chunk *ts_hypertable_create_chunk_for_point(const Hypertable *h,
 															   const Point *point, bool *found);
+extern TSDLLEXPORT int ts_hypertable_create_chunks_for_time(const Hypertable *h, int64 time,
+															int64 *range_end);
 extern Oid ts_hypertable_relid(RangeVar *rv);
 extern TSDLLEXPORT bool ts_is_hypertable(Oid relid);
 extern bool ts_hypertable_has_tablespace(const Hypertable *ht, Oid tspc_oid);
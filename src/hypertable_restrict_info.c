@@ -23,6 +23,7 @@
 #include "guc.h"
 #include "hypercube.h"
 #include "partitioning.h"
+#include "planner/planning_stats.h"
 #include "scan_iterator.h"
 #include "utils.h"
 
@@ -640,6 +641,14 @@ Chunk **
 ts_hypertable_restrict_info_get_chunks(HypertableRestrictInfo *hri, Hypertable *ht,
 									   unsigned int *num_chunks)
 {
+	PlanningStats *stats = ts_planning_stats_get(ht->fd.id);
+	instr_time start, duration;
+	Chunk **chunks;
+
+	INSTR_TIME_SET_ZERO(start);
+	if (stats != NULL)
+		INSTR_TIME_SET_CURRENT(start);
+
 	/*
 	 * Remove the dimensions for which we don't have a restriction, that is,
 	 * the entire range of the dimension matches. Such dimensions do not
@@ -666,6 +675,9 @@ ts_hypertable_restrict_info_get_chunks(HypertableRestrictInfo *hri, Hypertable *
 		 */
 		chunk_ids = ts_chunk_get_chunk_ids_by_hypertable_id(ht->fd.id);
 
+		if (stats != NULL)
+			stats->chunks_examined += list_length(chunk_ids);
+
 		/*
 		 * If the hypertable has an OSM chunk it would end up in the list
 		 * as well. We need to remove it when OSM reads are disabled via GUC
@@ -684,6 +696,15 @@ ts_hypertable_restrict_info_get_chunks(HypertableRestrictInfo *hri, Hypertable *
 		 * Have some restrictions, enumerate the matching dimension slices.
 		 */
 		List *dimension_vectors = gather_restriction_dimension_vectors(hri);
+
+		if (stats != NULL)
+		{
+			ListCell *lc;
+
+			foreach (lc, dimension_vectors)
+				stats->slices_examined += ((DimensionVec *) lfirst(lc))->num_slices;
+		}
+
 		if (list_length(dimension_vectors) == 0)
 		{
 			/*
@@ -694,8 +715,10 @@ ts_hypertable_restrict_info_get_chunks(HypertableRestrictInfo *hri, Hypertable *
 		}
 		else
 		{
+			int64 *num_examined = stats != NULL ? &stats->chunks_examined : NULL;
+
 			/* Find the chunks matching these dimension slices. */
-			chunk_ids = ts_chunk_id_find_in_subspace(ht, dimension_vectors);
+			chunk_ids = ts_chunk_id_find_in_subspace(ht, dimension_vectors, num_examined);
 		}
 
 		/*
@@ -729,7 +752,16 @@ ts_hypertable_restrict_info_get_chunks(HypertableRestrictInfo *hri, Hypertable *
 	 */
 	chunk_ids = list_sort_compat(chunk_ids, list_int_cmp_compat);
 
-	return ts_chunk_scan_by_chunk_ids(ht->space, chunk_ids, num_chunks);
+	chunks = ts_chunk_scan_by_chunk_ids(ht->space, chunk_ids, num_chunks);
+
+	if (stats != NULL)
+	{
+		INSTR_TIME_SET_CURRENT(duration);
+		INSTR_TIME_SUBTRACT(duration, start);
+		INSTR_TIME_ADD(stats->restrict_info_time, duration);
+	}
+
+	return chunks;
 }
 
 /*
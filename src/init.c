@@ -36,6 +36,12 @@ extern void _cache_invalidate_fini(void);
 extern void _cache_init(void);
 extern void _cache_fini(void);
 
+extern void _cache_stats_init(void);
+extern void _cache_stats_fini(void);
+
+extern void _catalog_init(void);
+extern void _catalog_fini(void);
+
 extern void _planner_init(void);
 extern void _planner_fini(void);
 
@@ -85,7 +91,9 @@ cleanup_on_pg_proc_exit(int code, Datum arg)
 	_planner_fini();
 	_cache_invalidate_fini();
 	_hypertable_cache_fini();
+	_cache_stats_fini();
 	_cache_fini();
+	_catalog_fini();
 }
 
 void
@@ -99,7 +107,9 @@ _PG_init(void)
 	ts_extension_check_server_version();
 	ts_bgw_check_loader_api_version();
 
+	_catalog_init();
 	_cache_init();
+	_cache_stats_init();
 	_hypertable_cache_init();
 	_cache_invalidate_init();
 	_planner_init();
@@ -0,0 +1,359 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#include <postgres.h>
+#include <math.h>
+#include <access/htup_details.h>
+#include <catalog/pg_type.h>
+#include <fmgr.h>
+#include <funcapi.h>
+#include <miscadmin.h>
+#include <port/pg_bitutils.h>
+#include <storage/lwlock.h>
+#include <utils/array.h>
+#include <utils/builtins.h>
+#include <utils/timestamp.h>
+
+#include "insert_stats.h"
+#include "utils.h"
+
+/*
+ * Latency statistics of the insert path.
+ *
+ * When enabled, a statement inserting into a hypertable times the stages of
+ * the insert path in backend-local counters, which are added to the totals
+ * of the hypertable in shared memory when the statement is done. Latencies
+ * are kept in histograms with power-of-two buckets, from which percentiles
+ * are estimated. The statistics are set up by the loader and kept for a
+ * limited number of hypertables, evicting the least recently inserted one
+ * when needed.
+ */
+static InsertStatsShared *insert_stats_shared = NULL;
+
+static const char *stage_names[] = {
+	[INSERT_STAGE_CHUNK_LOOKUP] = "chunk_lookup",
+	[INSERT_STAGE_CHUNK_CREATE] = "chunk_create",
+	[INSERT_STAGE_CONSTRAINT_CHECK] = "constraint_check",
+	[INSERT_STAGE_INDEX_INSERT] = "index_insert",
+	[INSERT_STAGE_COMPRESSED_UNIQUE_CHECK] = "compressed_unique_check",
+	[INSERT_STAGE_CAGG_INVALIDATION] = "cagg_invalidation",
+};
+
+enum Anum_insert_stats
+{
+	Anum_insert_stats_hypertable_id = 1,
+	Anum_insert_stats_stage,
+	Anum_insert_stats_statements,
+	Anum_insert_stats_calls,
+	Anum_insert_stats_total_time,
+	Anum_insert_stats_mean_time,
+	Anum_insert_stats_p50_time,
+	Anum_insert_stats_p90_time,
+	Anum_insert_stats_p99_time,
+	Anum_insert_stats_max_time,
+	Anum_insert_stats_histogram,
+	_Anum_insert_stats_max,
+};
+
+#define Natts_insert_stats (_Anum_insert_stats_max - 1)
+
+static InsertStatsShared *
+insert_stats_get_shared(void)
+{
+	if (insert_stats_shared == NULL)
+	{
+		InsertStatsShared **rendezvous =
+			(InsertStatsShared **) find_rendezvous_variable(RENDEZVOUS_INSERT_STATS);
+
+		/* The loader might be an older version without insert statistics */
+		insert_stats_shared = *rendezvous;
+	}
+
+	return insert_stats_shared;
+}
+
+/*
+ * Start collecting insert statistics for a statement inserting into a
+ * hypertable.
+ */
+InsertStats *
+ts_insert_stats_create(int32 hypertable_id)
+{
+	InsertStats *stats = palloc0(sizeof(InsertStats));
+
+	stats->hypertable_id = hypertable_id;
+
+	return stats;
+}
+
+static void
+insert_stage_counters_add_time(InsertStageCounters *counters, int64 nanoseconds)
+{
+	int bucket = 0;
+
+	if (nanoseconds > 1)
+		bucket = Min(pg_leftmost_one_pos64((uint64) nanoseconds), INSERT_STATS_NUM_BUCKETS - 1);
+
+	counters->calls++;
+	counters->total_time += nanoseconds;
+	counters->max_time = Max(counters->max_time, nanoseconds);
+	counters->buckets[bucket]++;
+}
+
+/*
+ * Add the time elapsed since start to a stage.
+ */
+void
+ts_insert_stats_add(InsertStats *stats, InsertStage stage, const instr_time *start)
+{
+	instr_time duration;
+
+	Assert(stage >= 0 && stage < INSERT_STATS_NUM_STAGES);
+
+	INSTR_TIME_SET_CURRENT(duration);
+	INSTR_TIME_SUBTRACT(duration, *start);
+
+	insert_stage_counters_add_time(&stats->stages[stage],
+								   (int64) (INSTR_TIME_GET_DOUBLE(duration) * 1e9));
+}
+
+static void
+insert_stage_counters_add(InsertStageCounters *total, const InsertStageCounters *counters)
+{
+	int i;
+
+	total->calls += counters->calls;
+	total->total_time += counters->total_time;
+	total->max_time = Max(total->max_time, counters->max_time);
+
+	for (i = 0; i < INSERT_STATS_NUM_BUCKETS; i++)
+		total->buckets[i] += counters->buckets[i];
+}
+
+/*
+ * Find the entry of a hypertable, claiming a free one or the one of the
+ * least recently inserted hypertable if it has none. Must hold the lock in
+ * exclusive mode.
+ */
+static InsertStatsSharedEntry *
+insert_stats_get_entry(InsertStatsShared *shared, int32 hypertable_id)
+{
+	InsertStatsSharedEntry *victim = NULL;
+	int i;
+
+	for (i = 0; i < INSERT_STATS_MAX_ENTRIES; i++)
+	{
+		InsertStatsSharedEntry *entry = &shared->entries[i];
+
+		if (entry->database_id == MyDatabaseId && entry->hypertable_id == hypertable_id)
+			return entry;
+
+		if (!OidIsValid(entry->database_id))
+		{
+			if (victim == NULL || OidIsValid(victim->database_id))
+				victim = entry;
+		}
+		else if (victim == NULL || (OidIsValid(victim->database_id) &&
+									entry->last_statement < victim->last_statement))
+			victim = entry;
+	}
+
+	Assert(victim != NULL);
+	memset(victim, 0, sizeof(InsertStatsSharedEntry));
+	victim->database_id = MyDatabaseId;
+	victim->hypertable_id = hypertable_id;
+
+	return victim;
+}
+
+/*
+ * Add the statistics of a statement to the totals of the hypertable.
+ */
+void
+ts_insert_stats_flush(InsertStats *stats)
+{
+	InsertStatsShared *shared = insert_stats_get_shared();
+	InsertStatsSharedEntry *entry;
+	int i;
+
+	if (shared == NULL)
+		return;
+
+	LWLockAcquire(shared->lock, LW_EXCLUSIVE);
+	entry = insert_stats_get_entry(shared, stats->hypertable_id);
+	entry->statements++;
+	entry->last_statement = GetCurrentTimestamp();
+
+	for (i = 0; i < INSERT_STATS_NUM_STAGES; i++)
+		insert_stage_counters_add(&entry->stages[i], &stats->stages[i]);
+
+	LWLockRelease(shared->lock);
+}
+
+static Datum
+nanoseconds_to_milliseconds(int64 nanoseconds)
+{
+	return Float8GetDatum(nanoseconds / 1000000.0);
+}
+
+/*
+ * Estimate a percentile of the latencies of a stage as the upper bound of
+ * the histogram bucket containing it.
+ */
+static int64
+insert_stage_counters_percentile(const InsertStageCounters *counters, double fraction)
+{
+	int64 rank = (int64) ceil(fraction * counters->calls);
+	int64 count = 0;
+	int i;
+
+	for (i = 0; i < INSERT_STATS_NUM_BUCKETS - 1; i++)
+	{
+		count += counters->buckets[i];
+
+		if (count >= rank)
+			return Min(INT64CONST(1) << (i + 1), counters->max_time);
+	}
+
+	return counters->max_time;
+}
+
+static HeapTuple
+insert_stats_make_tuple(TupleDesc tupdesc, const InsertStatsSharedEntry *entry, InsertStage stage)
+{
+	Datum values[Natts_insert_stats] = { 0 };
+	bool nulls[Natts_insert_stats] = { false };
+	Datum buckets[INSERT_STATS_NUM_BUCKETS];
+	const InsertStageCounters *counters = &entry->stages[stage];
+	int i;
+
+	StaticAssertStmt(lengthof(stage_names) == INSERT_STATS_NUM_STAGES,
+					 "number of stage names does not match number of stages");
+
+	for (i = 0; i < INSERT_STATS_NUM_BUCKETS; i++)
+		buckets[i] = Int64GetDatum(counters->buckets[i]);
+
+	values[AttrNumberGetAttrOffset(Anum_insert_stats_hypertable_id)] =
+		Int32GetDatum(entry->hypertable_id);
+	values[AttrNumberGetAttrOffset(Anum_insert_stats_stage)] =
+		CStringGetTextDatum(stage_names[stage]);
+	values[AttrNumberGetAttrOffset(Anum_insert_stats_statements)] =
+		Int64GetDatum(entry->statements);
+	values[AttrNumberGetAttrOffset(Anum_insert_stats_calls)] = Int64GetDatum(counters->calls);
+	values[AttrNumberGetAttrOffset(Anum_insert_stats_total_time)] =
+		nanoseconds_to_milliseconds(counters->total_time);
+	values[AttrNumberGetAttrOffset(Anum_insert_stats_mean_time)] =
+		nanoseconds_to_milliseconds(counters->total_time / counters->calls);
+	values[AttrNumberGetAttrOffset(Anum_insert_stats_p50_time)] =
+		nanoseconds_to_milliseconds(insert_stage_counters_percentile(counters, 0.50));
+	values[AttrNumberGetAttrOffset(Anum_insert_stats_p90_time)] =
+		nanoseconds_to_milliseconds(insert_stage_counters_percentile(counters, 0.90));
+	values[AttrNumberGetAttrOffset(Anum_insert_stats_p99_time)] =
+		nanoseconds_to_milliseconds(insert_stage_counters_percentile(counters, 0.99));
+	values[AttrNumberGetAttrOffset(Anum_insert_stats_max_time)] =
+		nanoseconds_to_milliseconds(counters->max_time);
+	values[AttrNumberGetAttrOffset(Anum_insert_stats_histogram)] = PointerGetDatum(
+		construct_array(buckets, INSERT_STATS_NUM_BUCKETS, INT8OID, 8, FLOAT8PASSBYVAL, 'd'));
+
+	return heap_form_tuple(tupdesc, values, nulls);
+}
+
+typedef struct InsertStatsRow
+{
+	int entry;
+	InsertStage stage;
+} InsertStatsRow;
+
+typedef struct InsertStatsState
+{
+	InsertStatsSharedEntry *entries;
+	InsertStatsRow *rows;
+} InsertStatsState;
+
+TS_FUNCTION_INFO_V1(ts_insert_stats);
+
+/*
+ * Return the insert statistics of the hypertables in the current database,
+ * with one row for each stage of the insert path that was timed.
+ *
+ * The entries are copied on the first call so that the result is consistent
+ * even if statements finish while it is returned.
+ */
+Datum
+ts_insert_stats(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	InsertStatsState *state;
+	InsertStatsRow *row;
+	HeapTuple tuple;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		InsertStatsShared *shared = insert_stats_get_shared();
+		MemoryContext oldcontext;
+		TupleDesc tupdesc;
+		int num_entries = 0;
+		int num_rows = 0;
+		int i;
+
+		funcctx = SRF_FIRSTCALL_INIT();
+		oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("function returning record called in context "
+							"that cannot accept type record")));
+
+		funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+		state = palloc(sizeof(InsertStatsState));
+		state->entries = palloc(sizeof(InsertStatsSharedEntry) * INSERT_STATS_MAX_ENTRIES);
+
+		if (shared != NULL)
+		{
+			LWLockAcquire(shared->lock, LW_SHARED);
+
+			for (i = 0; i < INSERT_STATS_MAX_ENTRIES; i++)
+			{
+				if (shared->entries[i].database_id == MyDatabaseId)
+					state->entries[num_entries++] = shared->entries[i];
+			}
+
+			LWLockRelease(shared->lock);
+		}
+
+		state->rows = palloc(sizeof(InsertStatsRow) * (num_entries * INSERT_STATS_NUM_STAGES + 1));
+
+		for (i = 0; i < num_entries; i++)
+		{
+			int stage;
+
+			for (stage = 0; stage < INSERT_STATS_NUM_STAGES; stage++)
+			{
+				if (state->entries[i].stages[stage].calls > 0)
+				{
+					state->rows[num_rows].entry = i;
+					state->rows[num_rows].stage = stage;
+					num_rows++;
+				}
+			}
+		}
+
+		funcctx->user_fctx = state;
+		funcctx->max_calls = num_rows;
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	state = funcctx->user_fctx;
+
+	if (funcctx->call_cntr >= funcctx->max_calls)
+		SRF_RETURN_DONE(funcctx);
+
+	row = &state->rows[funcctx->call_cntr];
+	tuple = insert_stats_make_tuple(funcctx->tuple_desc, &state->entries[row->entry], row->stage);
+
+	SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+}
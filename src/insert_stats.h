@@ -0,0 +1,61 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#ifndef TIMESCALEDB_INSERT_STATS_H
+#define TIMESCALEDB_INSERT_STATS_H
+
+#include <postgres.h>
+#include <portability/instr_time.h>
+
+#include "export.h"
+#include "loader/insert_stats.h"
+
+typedef enum InsertStage
+{
+	INSERT_STAGE_CHUNK_LOOKUP = 0,
+	INSERT_STAGE_CHUNK_CREATE,
+	INSERT_STAGE_CONSTRAINT_CHECK,
+	INSERT_STAGE_INDEX_INSERT,
+	INSERT_STAGE_COMPRESSED_UNIQUE_CHECK,
+	INSERT_STAGE_CAGG_INVALIDATION,
+} InsertStage;
+
+/*
+ * Latencies of the insert path collected by a statement for a hypertable.
+ * They are added to the shared statistics of the hypertable when the
+ * statement is done.
+ */
+typedef struct InsertStats
+{
+	int32 hypertable_id;
+	InsertStageCounters stages[INSERT_STATS_NUM_STAGES];
+} InsertStats;
+
+extern TSDLLEXPORT InsertStats *ts_insert_stats_create(int32 hypertable_id);
+extern TSDLLEXPORT void ts_insert_stats_flush(InsertStats *stats);
+extern TSDLLEXPORT void ts_insert_stats_add(InsertStats *stats, InsertStage stage,
+											const instr_time *start);
+
+/*
+ * Start timing a stage. Statistics are disabled if stats is NULL, in which
+ * case timing is a no-op.
+ */
+static inline void
+ts_insert_stats_start(const InsertStats *stats, instr_time *start)
+{
+	if (stats != NULL)
+		INSTR_TIME_SET_CURRENT(*start);
+	else
+		INSTR_TIME_SET_ZERO(*start);
+}
+
+static inline void
+ts_insert_stats_end(InsertStats *stats, InsertStage stage, const instr_time *start)
+{
+	if (stats != NULL)
+		ts_insert_stats_add(stats, stage, start);
+}
+
+#endif /* TIMESCALEDB_INSERT_STATS_H */
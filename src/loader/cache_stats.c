@@ -0,0 +1,57 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+
+#include <postgres.h>
+#include <fmgr.h>
+#include <miscadmin.h>
+#include <storage/lwlock.h>
+#include <storage/shmem.h>
+
+#include "loader/cache_stats.h"
+
+#define CACHE_STATS_SHMEM_NAME "ts_cache_stats_shmem"
+
+/*
+ * Since shared memory can only be setup in a library loaded as
+ * shared_preload_libraries we have to setup the cache statistics here. The
+ * versioned extension finds them through a rendezvous variable.
+ */
+void
+ts_cache_stats_shmem_startup()
+{
+	CacheStatsShared **stats_pointer;
+	CacheStatsShared *stats;
+	bool found;
+
+	LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+	stats = ShmemInitStruct(CACHE_STATS_SHMEM_NAME, sizeof(CacheStatsShared), &found);
+	if (!found)
+	{
+		int i;
+
+		memset(stats, 0, sizeof(CacheStatsShared));
+		stats->lock = &(GetNamedLWLockTranche(CACHE_STATS_LWLOCK_TRANCHE_NAME))->lock;
+
+		for (i = 0; i < CACHE_STATS_MAX_ENTRIES; i++)
+		{
+			pg_atomic_init_u64(&stats->entries[i].hits, 0);
+			pg_atomic_init_u64(&stats->entries[i].misses, 0);
+			pg_atomic_init_u64(&stats->entries[i].evictions, 0);
+			pg_atomic_init_u64(&stats->entries[i].invalidations, 0);
+		}
+	}
+	LWLockRelease(AddinShmemInitLock);
+
+	stats_pointer = (CacheStatsShared **) find_rendezvous_variable(RENDEZVOUS_CACHE_STATS);
+	*stats_pointer = stats;
+}
+
+void
+ts_cache_stats_shmem_alloc()
+{
+	RequestNamedLWLockTranche(CACHE_STATS_LWLOCK_TRANCHE_NAME, 1);
+	RequestAddinShmemSpace(sizeof(CacheStatsShared));
+}
@@ -0,0 +1,46 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+
+#ifndef TIMESCALEDB_LOADER_CACHE_STATS_H
+#define TIMESCALEDB_LOADER_CACHE_STATS_H
+
+#include <postgres.h>
+#include <port/atomics.h>
+#include <storage/lwlock.h>
+
+#define RENDEZVOUS_CACHE_STATS "ts_cache_stats"
+#define CACHE_STATS_LWLOCK_TRANCHE_NAME "ts_cache_stats_lwlock_tranche"
+
+/* Maximum number of distinct caches that statistics are kept for */
+#define CACHE_STATS_MAX_ENTRIES 32
+
+/*
+ * Cache statistics aggregated over all backends.
+ *
+ * The struct is shared by all extension versions loaded in the cluster, so
+ * fields can only be added at the end.
+ */
+typedef struct CacheStatsSharedEntry
+{
+	NameData name;
+	pg_atomic_uint64 hits;
+	pg_atomic_uint64 misses;
+	pg_atomic_uint64 evictions;
+	pg_atomic_uint64 invalidations;
+} CacheStatsSharedEntry;
+
+typedef struct CacheStatsShared
+{
+	/* Protects num_entries and the entry names. Counters are atomic. */
+	LWLock *lock;
+	int num_entries;
+	CacheStatsSharedEntry entries[CACHE_STATS_MAX_ENTRIES];
+} CacheStatsShared;
+
+extern void ts_cache_stats_shmem_startup(void);
+extern void ts_cache_stats_shmem_alloc(void);
+
+#endif /* TIMESCALEDB_LOADER_CACHE_STATS_H */
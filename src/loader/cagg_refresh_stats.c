@@ -0,0 +1,49 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+
+#include <postgres.h>
+#include <fmgr.h>
+#include <miscadmin.h>
+#include <storage/lwlock.h>
+#include <storage/shmem.h>
+
+#include "loader/cagg_refresh_stats.h"
+
+#define CAGG_REFRESH_STATS_SHMEM_NAME "ts_cagg_refresh_stats_shmem"
+
+/*
+ * Refreshes run in background workers as well as in sessions of all
+ * databases, so the statistics are set up by the loader like the cache
+ * statistics.
+ */
+void
+ts_cagg_refresh_stats_shmem_startup()
+{
+	CaggRefreshStatsShared **stats_pointer;
+	CaggRefreshStatsShared *stats;
+	bool found;
+
+	LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+	stats =
+		ShmemInitStruct(CAGG_REFRESH_STATS_SHMEM_NAME, sizeof(CaggRefreshStatsShared), &found);
+	if (!found)
+	{
+		memset(stats, 0, sizeof(CaggRefreshStatsShared));
+		stats->lock = &(GetNamedLWLockTranche(CAGG_REFRESH_STATS_LWLOCK_TRANCHE_NAME))->lock;
+	}
+	LWLockRelease(AddinShmemInitLock);
+
+	stats_pointer =
+		(CaggRefreshStatsShared **) find_rendezvous_variable(RENDEZVOUS_CAGG_REFRESH_STATS);
+	*stats_pointer = stats;
+}
+
+void
+ts_cagg_refresh_stats_shmem_alloc()
+{
+	RequestNamedLWLockTranche(CAGG_REFRESH_STATS_LWLOCK_TRANCHE_NAME, 1);
+	RequestAddinShmemSpace(sizeof(CaggRefreshStatsShared));
+}
@@ -0,0 +1,72 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+
+#ifndef TIMESCALEDB_LOADER_CAGG_REFRESH_STATS_H
+#define TIMESCALEDB_LOADER_CAGG_REFRESH_STATS_H
+
+#include <postgres.h>
+#include <datatype/timestamp.h>
+#include <storage/lwlock.h>
+
+#define RENDEZVOUS_CAGG_REFRESH_STATS "ts_cagg_refresh_stats"
+#define CAGG_REFRESH_STATS_LWLOCK_TRANCHE_NAME "ts_cagg_refresh_stats_lwlock_tranche"
+
+/* Maximum number of continuous aggregates that statistics are kept for */
+#define CAGG_REFRESH_STATS_MAX_ENTRIES 1024
+
+/*
+ * Counters of the work done by refreshes. Durations are in microseconds.
+ */
+typedef struct CaggRefreshCounters
+{
+	int64 ranges;
+	int64 rows_deleted;
+	int64 rows_inserted;
+	int64 raw_rows_read;
+	int64 compressed_batches_read;
+	int64 invalidation_time;
+	int64 delete_time;
+	int64 insert_time;
+	int64 watermark_time;
+	int64 total_time;
+} CaggRefreshCounters;
+
+/*
+ * Refresh statistics of one continuous aggregate.
+ *
+ * The struct is shared by all extension versions loaded in the cluster, so
+ * fields can only be added at the end.
+ */
+typedef struct CaggRefreshStatsSharedEntry
+{
+	/* Entry is unused if the database is invalid */
+	Oid database_id;
+	int32 mat_hypertable_id;
+	int64 refreshes;
+	int64 failed_refreshes;
+	/* Totals over all refreshes and the values of the last refresh */
+	CaggRefreshCounters total;
+	CaggRefreshCounters last;
+	TimestampTz last_start;
+	/* Refresh in progress, if the pid is not zero */
+	int pid;
+	int phase;
+	TimestampTz start;
+	TimestampTz phase_start;
+	CaggRefreshCounters current;
+} CaggRefreshStatsSharedEntry;
+
+typedef struct CaggRefreshStatsShared
+{
+	/* Protects all entries */
+	LWLock *lock;
+	CaggRefreshStatsSharedEntry entries[CAGG_REFRESH_STATS_MAX_ENTRIES];
+} CaggRefreshStatsShared;
+
+extern void ts_cagg_refresh_stats_shmem_startup(void);
+extern void ts_cagg_refresh_stats_shmem_alloc(void);
+
+#endif /* TIMESCALEDB_LOADER_CAGG_REFRESH_STATS_H */
@@ -0,0 +1,48 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+
+#include <postgres.h>
+#include <fmgr.h>
+#include <miscadmin.h>
+#include <storage/lwlock.h>
+#include <storage/shmem.h>
+
+#include "loader/insert_stats.h"
+
+#define INSERT_STATS_SHMEM_NAME "ts_insert_stats_shmem"
+
+/*
+ * Set up the per-hypertable insert statistics in shared memory and publish
+ * them through a rendezvous variable, where the loaded extension version
+ * finds them when a statement flushes its statistics. Entries are keyed by
+ * database and hypertable id since one array serves all databases.
+ */
+void
+ts_insert_stats_shmem_startup()
+{
+	InsertStatsShared **stats_pointer;
+	InsertStatsShared *stats;
+	bool found;
+
+	LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+	stats = ShmemInitStruct(INSERT_STATS_SHMEM_NAME, sizeof(InsertStatsShared), &found);
+	if (!found)
+	{
+		memset(stats, 0, sizeof(InsertStatsShared));
+		stats->lock = &(GetNamedLWLockTranche(INSERT_STATS_LWLOCK_TRANCHE_NAME))->lock;
+	}
+	LWLockRelease(AddinShmemInitLock);
+
+	stats_pointer = (InsertStatsShared **) find_rendezvous_variable(RENDEZVOUS_INSERT_STATS);
+	*stats_pointer = stats;
+}
+
+void
+ts_insert_stats_shmem_alloc()
+{
+	RequestNamedLWLockTranche(INSERT_STATS_LWLOCK_TRANCHE_NAME, 1);
+	RequestAddinShmemSpace(sizeof(InsertStatsShared));
+}
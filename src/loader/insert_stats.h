@@ -0,0 +1,67 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+
+#ifndef TIMESCALEDB_LOADER_INSERT_STATS_H
+#define TIMESCALEDB_LOADER_INSERT_STATS_H
+
+#include <postgres.h>
+#include <datatype/timestamp.h>
+#include <storage/lwlock.h>
+
+#define RENDEZVOUS_INSERT_STATS "ts_insert_stats"
+#define INSERT_STATS_LWLOCK_TRANCHE_NAME "ts_insert_stats_lwlock_tranche"
+
+/* Maximum number of hypertables that statistics are kept for */
+#define INSERT_STATS_MAX_ENTRIES 256
+
+/*
+ * Number of buckets of the latency histograms. Bucket i counts the latencies
+ * from 2^i up to 2^(i+1) nanoseconds, and the last bucket also counts all
+ * longer latencies.
+ */
+#define INSERT_STATS_NUM_BUCKETS 32
+
+/* Number of stages of the insert path that are timed, see InsertStage */
+#define INSERT_STATS_NUM_STAGES 6
+
+/*
+ * Latencies of one stage of the insert path. Times are in nanoseconds.
+ */
+typedef struct InsertStageCounters
+{
+	int64 calls;
+	int64 total_time;
+	int64 max_time;
+	int64 buckets[INSERT_STATS_NUM_BUCKETS];
+} InsertStageCounters;
+
+/*
+ * Insert statistics of one hypertable.
+ *
+ * The struct is shared by all extension versions loaded in the cluster, so
+ * fields can only be added at the end.
+ */
+typedef struct InsertStatsSharedEntry
+{
+	/* Entry is unused if the database is invalid */
+	Oid database_id;
+	int32 hypertable_id;
+	int64 statements;
+	TimestampTz last_statement;
+	InsertStageCounters stages[INSERT_STATS_NUM_STAGES];
+} InsertStatsSharedEntry;
+
+typedef struct InsertStatsShared
+{
+	/* Protects all entries */
+	LWLock *lock;
+	InsertStatsSharedEntry entries[INSERT_STATS_MAX_ENTRIES];
+} InsertStatsShared;
+
+extern void ts_insert_stats_shmem_startup(void);
+extern void ts_insert_stats_shmem_alloc(void);
+
+#endif /* TIMESCALEDB_LOADER_INSERT_STATS_H */
@@ -35,6 +35,9 @@
 #include "loader/bgw_interface.h"
 #include "loader/bgw_launcher.h"
 #include "loader/bgw_message_queue.h"
+#include "loader/cache_stats.h"
+#include "loader/cagg_refresh_stats.h"
+#include "loader/insert_stats.h"
 #include "loader/lwlocks.h"
 #include "loader/seclabel.h"
 
@@ -671,6 +674,9 @@ timescaledb_shmem_startup_hook(void)
 	ts_bgw_message_queue_shmem_startup();
 	ts_lwlocks_shmem_startup();
 	ts_function_telemetry_shmem_startup();
+	ts_cache_stats_shmem_startup();
+	ts_cagg_refresh_stats_shmem_startup();
+	ts_insert_stats_shmem_startup();
 }
 
 /*
@@ -690,6 +696,9 @@ timescaledb_shmem_request_hook(void)
 	ts_bgw_message_queue_alloc();
 	ts_lwlocks_shmem_alloc();
 	ts_function_telemetry_shmem_alloc();
+	ts_cache_stats_shmem_alloc();
+	ts_cagg_refresh_stats_shmem_alloc();
+	ts_insert_stats_shmem_alloc();
 }
 
 static void
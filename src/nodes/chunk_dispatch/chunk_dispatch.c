@@ -4,7 +4,11 @@
  * LICENSE-APACHE for a copy of the license.
  */
 #include <postgres.h>
+#include <access/genam.h>
+#include <access/tableam.h>
 #include <access/xact.h>
+#include <catalog/index.h>
+#include <executor/executor.h>
 #include <nodes/nodes.h>
 #include <nodes/extensible.h>
 #include <nodes/makefuncs.h>
@@ -13,6 +17,7 @@
 #include <utils/rel.h>
 #include <utils/syscache.h>
 #include <catalog/pg_type.h>
+#include <commands/explain.h>
 
 #include "compat/compat.h"
 #include "chunk_dispatch.h"
@@ -21,11 +26,23 @@
 #include "subspace_store.h"
 #include "dimension.h"
 #include "guc.h"
+#include "insert_stats.h"
 #include "nodes/hypertable_modify.h"
 #include "ts_catalog/chunk_data_node.h"
+#include "utils.h"
 
 static Node *chunk_dispatch_state_create(CustomScan *cscan);
 
+/*
+ * Approximate the memory used by a chunk insert state with the memory
+ * allocated in its memory context at the time it is added to the cache.
+ */
+static Size
+chunk_insert_state_size(void *cis)
+{
+	return ts_memory_context_allocated(((ChunkInsertState *) cis)->mctx);
+}
+
 ChunkDispatch *
 ts_chunk_dispatch_create(Hypertable *ht, EState *estate, int eflags)
 {
@@ -36,17 +53,83 @@ ts_chunk_dispatch_create(Hypertable *ht, EState *estate, int eflags)
 	cd->eflags = eflags;
 	cd->hypertable_result_rel_info = NULL;
 	cd->cache =
-		ts_subspace_store_init(ht->space, estate->es_query_cxt, ts_guc_max_open_chunks_per_insert);
+		ts_subspace_store_init("chunk_insert_states",
+							   ht->space,
+							   estate->es_query_cxt,
+							   ts_guc_max_open_chunks_per_insert);
+	ts_subspace_store_set_memory_limit(cd->cache,
+									   (Size) ts_guc_max_open_chunks_memory_per_insert * 1024L,
+									   chunk_insert_state_size);
 	cd->prev_cis = NULL;
 	cd->prev_cis_oid = InvalidOid;
+	cd->point = MemoryContextAlloc(estate->es_query_cxt, POINT_SIZE(ht->space->num_dimensions));
+	cd->point->cardinality = ht->space->num_dimensions;
+	cd->point->num_coords = 0;
+	cd->fast_path_tuples = 0;
+
+	if (ts_guc_track_insert_stats && (eflags & EXEC_FLAG_EXPLAIN_ONLY) == 0)
+		cd->stats = ts_insert_stats_create(ht->fd.id);
 
 	return cd;
 }
 
+/*
+ * Build the indexes that were not maintained for the chunks created by the
+ * statement.
+ *
+ * The indexes are rebuilt from the heap of the chunk like with REINDEX, which
+ * sorts the tuples once instead of inserting them one by one, and uses
+ * parallel workers as configured with max_parallel_maintenance_workers.
+ */
+static void
+chunk_dispatch_build_deferred_indexes(ChunkDispatch *dispatch)
+{
+	ListCell *lc;
+#if PG14_LT
+	int options = 0;
+#else
+	ReindexParams params = { 0 };
+	ReindexParams *options = &params;
+#endif
+
+	foreach (lc, dispatch->deferred_index_chunks)
+	{
+		Relation rel = table_open(lfirst_oid(lc), ShareLock);
+		char relpersistence = rel->rd_rel->relpersistence;
+		List *indexlist = RelationGetIndexList(rel);
+		ListCell *lc_index;
+
+		table_close(rel, NoLock);
+
+		foreach (lc_index, indexlist)
+		{
+			Oid indexrelid = lfirst_oid(lc_index);
+			Relation indexrel = index_open(indexrelid, AccessShareLock);
+			bool deferred =
+				!indexrel->rd_index->indisunique && !indexrel->rd_index->indisexclusion;
+
+			index_close(indexrel, NoLock);
+
+			if (deferred)
+				reindex_index(indexrelid, false, relpersistence, options);
+		}
+
+		list_free(indexlist);
+	}
+
+	CommandCounterIncrement();
+}
+
 void
 ts_chunk_dispatch_destroy(ChunkDispatch *chunk_dispatch)
 {
 	ts_subspace_store_free(chunk_dispatch->cache);
+
+	if (chunk_dispatch->deferred_index_chunks != NIL)
+		chunk_dispatch_build_deferred_indexes(chunk_dispatch);
+
+	if (chunk_dispatch->stats != NULL)
+		ts_insert_stats_flush(chunk_dispatch->stats);
 }
 
 static void
@@ -55,6 +138,26 @@ destroy_chunk_insert_state(void *cis)
 	ts_chunk_insert_state_destroy((ChunkInsertState *) cis);
 }
 
+/*
+ * Check if a point is within the chunk of a chunk insert state.
+ */
+static inline bool
+chunk_insert_state_contains_point(const ChunkInsertState *cis, const Point *point)
+{
+	int i;
+
+	Assert(cis->num_slices == point->cardinality);
+
+	for (i = 0; i < point->cardinality; i++)
+	{
+		if (point->coordinates[i] < cis->range_start[i] ||
+			point->coordinates[i] >= cis->range_end[i])
+			return false;
+	}
+
+	return true;
+}
+
 /*
  * Get the chunk insert state for the chunk that matches the given point in the
  * partitioned hyperspace.
@@ -68,6 +171,7 @@ ts_chunk_dispatch_get_chunk_insert_state(ChunkDispatch *dispatch, Point *point,
 	bool cis_changed = true;
 	bool found = true;
 	Chunk *chunk = NULL;
+	instr_time start;
 
 	/* Direct inserts into internal compressed hypertable is not supported.
 	 * For compression chunks are created explicitly by compress_chunk and
@@ -77,7 +181,23 @@ ts_chunk_dispatch_get_chunk_insert_state(ChunkDispatch *dispatch, Point *point,
 	if (dispatch->hypertable->fd.compression_state == HypertableInternalCompressionTable)
 		elog(ERROR, "direct insert into internal compressed hypertable is not supported");
 
-	cis = ts_subspace_store_get(dispatch->cache, point);
+	ts_insert_stats_start(dispatch->stats, &start);
+
+	/*
+	 * Tuples inserted in time order mostly go to the same chunk as the
+	 * previous tuple, so check the previous chunk before looking up the chunk
+	 * in the cache. The previous chunk insert state is the most recently used
+	 * entry of the cache and is reset when it is evicted. It still counts as
+	 * a cache hit so that the cache statistics cover all tuples.
+	 */
+	if (dispatch->prev_cis != NULL && chunk_insert_state_contains_point(dispatch->prev_cis, point))
+	{
+		cis = dispatch->prev_cis;
+		dispatch->fast_path_tuples++;
+		ts_subspace_store_count_hit(dispatch->cache);
+	}
+	else
+		cis = ts_subspace_store_get(dispatch->cache, point);
 
 	/*
 	 * The chunk search functions may leak memory, so switch to a temporary
@@ -134,6 +254,24 @@ ts_chunk_dispatch_get_chunk_insert_state(ChunkDispatch *dispatch, Point *point,
 
 		cis = ts_chunk_insert_state_create(chunk, dispatch);
 
+		/*
+		 * Defer the indexes of chunks created by the statement, also when the
+		 * chunk insert state of such a chunk is closed and created again.
+		 */
+		if (dispatch->defer_chunk_indexes)
+		{
+			if (!found && ts_chunk_insert_state_defer_indexes(cis))
+			{
+				MemoryContext query_context = MemoryContextSwitchTo(dispatch->estate->es_query_cxt);
+
+				dispatch->deferred_index_chunks =
+					lappend_oid(dispatch->deferred_index_chunks, chunk->table_id);
+				MemoryContextSwitchTo(query_context);
+			}
+			else if (list_member_oid(dispatch->deferred_index_chunks, chunk->table_id))
+				ts_chunk_insert_state_defer_indexes(cis);
+		}
+
 		/*
 		 * We might have been blocked by a compression operation
 		 * while trying to fetch the above lock so lets update the
@@ -153,6 +291,10 @@ ts_chunk_dispatch_get_chunk_insert_state(ChunkDispatch *dispatch, Point *point,
 		cis_changed = false;
 	}
 
+	ts_insert_stats_end(dispatch->stats,
+						found ? INSERT_STAGE_CHUNK_LOOKUP : INSERT_STAGE_CHUNK_CREATE,
+						&start);
+
 	if (found)
 	{
 		if (cis->chunk_compressed && cis->chunk_data_nodes == NIL)
@@ -171,7 +313,9 @@ ts_chunk_dispatch_get_chunk_insert_state(ChunkDispatch *dispatch, Point *point,
 				 */
 				if (chunk == NULL)
 					chunk = ts_hypertable_find_chunk_for_point(dispatch->hypertable, point);
+				ts_insert_stats_start(dispatch->stats, &start);
 				ts_cm_functions->decompress_batches_for_insert(cis, chunk, slot);
+				ts_insert_stats_end(dispatch->stats, INSERT_STAGE_COMPRESSED_UNIQUE_CHECK, &start);
 				OnConflictAction onconflict_action =
 					chunk_dispatch_get_on_conflict_action(dispatch);
 				/* mark rows visible */
@@ -191,6 +335,17 @@ ts_chunk_dispatch_get_chunk_insert_state(ChunkDispatch *dispatch, Point *point,
 
 	MemoryContextSwitchTo(old_context);
 
+	/* Track the inserted time range for continuous aggregate invalidation */
+	if (cis->cagg_inval_capture)
+	{
+		int64 value = point->coordinates[cis->cagg_inval_dimension];
+
+		if (value < cis->cagg_inval_lowest)
+			cis->cagg_inval_lowest = value;
+		if (value > cis->cagg_inval_greatest)
+			cis->cagg_inval_greatest = value;
+	}
+
 	if (cis_changed && on_chunk_changed)
 		on_chunk_changed(cis, data);
 
@@ -200,6 +355,58 @@ ts_chunk_dispatch_get_chunk_insert_state(ChunkDispatch *dispatch, Point *point,
 	return cis;
 }
 
+/*
+ * Buffer a tuple of an INSERT for a multi-insert into its chunk.
+ *
+ * The tuple is copied into a slot of the chunk insert state. All buffered
+ * tuples are written out once the limits for the buffered tuples are
+ * reached.
+ */
+void
+ts_chunk_dispatch_buffer_tuple(ChunkDispatch *dispatch, ChunkInsertState *cis,
+							   TupleTableSlot *slot)
+{
+	TupleTableSlot *buffered_slot;
+	Size tuple_len;
+	MemoryContext old_context = MemoryContextSwitchTo(cis->mctx);
+
+	if (cis->buffered_slots == NULL)
+		cis->buffered_slots = palloc0(sizeof(TupleTableSlot *) * MAX_BUFFERED_INSERT_TUPLES);
+
+	if (cis->buffered_slots[cis->nbuffered] == NULL)
+		cis->buffered_slots[cis->nbuffered] = table_slot_create(cis->rel, NULL);
+
+	buffered_slot = cis->buffered_slots[cis->nbuffered];
+	ExecCopySlot(buffered_slot, slot);
+	tuple_len = ExecFetchSlotHeapTuple(buffered_slot, false, NULL)->t_len;
+
+	MemoryContextSwitchTo(dispatch->estate->es_query_cxt);
+
+	if (cis->nbuffered == 0)
+		dispatch->buffered_cis = lappend(dispatch->buffered_cis, cis);
+
+	MemoryContextSwitchTo(old_context);
+
+	cis->nbuffered++;
+	cis->buffered_bytes += tuple_len;
+	dispatch->buffered_tuples++;
+	dispatch->buffered_bytes += tuple_len;
+
+	if (dispatch->buffered_tuples >= MAX_BUFFERED_INSERT_TUPLES ||
+		dispatch->buffered_bytes >= MAX_BUFFERED_INSERT_BYTES)
+		ts_chunk_dispatch_flush(dispatch);
+}
+
+/*
+ * Write out the tuples buffered for all chunks.
+ */
+void
+ts_chunk_dispatch_flush(ChunkDispatch *dispatch)
+{
+	while (dispatch->buffered_cis != NIL)
+		ts_chunk_insert_state_flush(linitial(dispatch->buffered_cis));
+}
+
 static CustomScanMethods chunk_dispatch_plan_methods = {
 	.CustomName = "ChunkDispatch",
 	.CreateCustomScanState = chunk_dispatch_state_create,
@@ -400,10 +607,12 @@ chunk_dispatch_exec(CustomScanState *node)
 		}
 	}
 	/* Calculate the tuple's point in the N-dimensional hyperspace */
-	point = ts_hyperspace_calculate_point(ht->space, (newslot ? newslot : slot));
+	point = dispatch->point;
+	ts_hyperspace_fill_point(ht->space, (newslot ? newslot : slot), point);
 
 #else
-	point = ts_hyperspace_calculate_point(ht->space, slot);
+	point = dispatch->point;
+	ts_hyperspace_fill_point(ht->space, slot, point);
 #endif
 
 	/* Save the main table's (hypertable's) ResultRelInfo */
@@ -464,12 +673,36 @@ chunk_dispatch_rescan(CustomScanState *node)
 	ExecReScan(substate);
 }
 
+static void
+chunk_dispatch_explain(CustomScanState *node, List *ancestors, ExplainState *es)
+{
+	ChunkDispatchState *state = (ChunkDispatchState *) node;
+	const SubspaceStoreStats *stats;
+
+	if (!es->analyze || state->dispatch == NULL)
+		return;
+
+	stats = ts_subspace_store_stats(state->dispatch->cache);
+
+	/* Only show evictions in text format when they happened, so that regular
+	 * EXPLAIN ANALYZE output is unaffected */
+	if (stats->evictions > 0 || es->format != EXPLAIN_FORMAT_TEXT)
+		ExplainPropertyInteger("Chunks evicted", NULL, stats->evictions, es);
+
+	if (state->dispatch->fast_path_tuples > 0 || es->format != EXPLAIN_FORMAT_TEXT)
+		ExplainPropertyInteger("Tuples routed to previous chunk",
+							   NULL,
+							   state->dispatch->fast_path_tuples,
+							   es);
+}
+
 static CustomExecMethods chunk_dispatch_state_methods = {
 	.CustomName = "ChunkDispatchState",
 	.BeginCustomScan = chunk_dispatch_begin,
 	.EndCustomScan = chunk_dispatch_end,
 	.ExecCustomScan = chunk_dispatch_exec,
 	.ReScanCustomScan = chunk_dispatch_rescan,
+	.ExplainCustomScan = chunk_dispatch_explain,
 };
 
 /*
@@ -19,6 +19,13 @@
 #include "subspace_store.h"
 #include "chunk_insert_state.h"
 
+/*
+ * Limits for the tuples of an INSERT buffered across all chunks before they
+ * are written out.
+ */
+#define MAX_BUFFERED_INSERT_TUPLES 1000
+#define MAX_BUFFERED_INSERT_BYTES 65535
+
 /*
  * ChunkDispatch keeps cached state needed to dispatch tuples to chunks. It is
  * separate from any plan and executor nodes, since it is used both for INSERT
@@ -40,6 +47,27 @@ typedef struct ChunkDispatch
 	ResultRelInfo *hypertable_result_rel_info;
 	ChunkInsertState *prev_cis;
 	Oid prev_cis_oid;
+
+	/* Point reused for every tuple routed by the dispatch */
+	struct Point *point;
+	/* Number of tuples routed to the previous chunk without a lookup */
+	uint64 fast_path_tuples;
+
+	/* Chunk insert states with tuples buffered for a multi-insert */
+	List *buffered_cis;
+	int buffered_tuples;
+	Size buffered_bytes;
+
+	/*
+	 * Do not maintain the non-unique indexes of chunks created by the
+	 * statement, but build them when the dispatch is destroyed at the end of
+	 * the statement. The chunks with deferred indexes are kept in the list.
+	 */
+	bool defer_chunk_indexes;
+	List *deferred_index_chunks;
+
+	/* Latency statistics of the statement, or NULL if they are not tracked */
+	struct InsertStats *stats;
 } ChunkDispatch;
 
 typedef struct ChunkDispatchPath
@@ -89,6 +117,10 @@ extern ChunkInsertState *
 ts_chunk_dispatch_get_chunk_insert_state(ChunkDispatch *dispatch, Point *p, TupleTableSlot *slot,
 										 const on_chunk_changed_func on_chunk_changed, void *data);
 
+extern void ts_chunk_dispatch_buffer_tuple(ChunkDispatch *dispatch, ChunkInsertState *cis,
+										   TupleTableSlot *slot);
+extern void ts_chunk_dispatch_flush(ChunkDispatch *dispatch);
+
 extern TSDLLEXPORT Path *ts_chunk_dispatch_path_create(PlannerInfo *root, ModifyTablePath *mtpath,
 													   Index hypertable_rti, int subpath_index);
 
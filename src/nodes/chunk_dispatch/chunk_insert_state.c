@@ -5,8 +5,12 @@
  */
 #include <postgres.h>
 #include <access/attnum.h>
+#include <access/tableam.h>
 #include <access/xact.h>
+#include <catalog/pg_trigger.h>
 #include <catalog/pg_type.h>
+#include <commands/trigger.h>
+#include <executor/executor.h>
 #include <executor/tuptable.h>
 #include <foreign/fdwapi.h>
 #include <miscadmin.h>
@@ -32,6 +36,7 @@
 #include "ts_catalog/continuous_agg.h"
 #include "chunk_index.h"
 #include "indexing.h"
+#include "insert_stats.h"
 #include <utils/inval.h>
 
 /* Just like ExecPrepareExpr except that it doesn't switch to the query memory context */
@@ -537,7 +542,15 @@ adjust_projections(ChunkInsertState *cis, ChunkDispatch *dispatch, Oid rowtype)
 	TupleConversionMap *chunk_map = NULL;
 	OnConflictAction onconflict_action = chunk_dispatch_get_on_conflict_action(dispatch);
 
-	if (chunk_dispatch_has_returning(dispatch))
+	/*
+	 * The RETURNING projection of the hypertable, copied to the chunk's result
+	 * relation info, works as is when the chunk's tuple descriptor matches the
+	 * hypertable's, which is the common case. Only build a new projection for
+	 * chunks that need their tuples converted.
+	 */
+	if (chunk_dispatch_has_returning(dispatch) &&
+		(cis->hyper_to_chunk_map != NULL ||
+		 RelationGetForm(chunk_rel)->relkind != RELKIND_RELATION))
 	{
 		/*
 		 * We need the opposite map from cis->hyper_to_chunk_map. The map needs
@@ -568,6 +581,95 @@ adjust_projections(ChunkInsertState *cis, ChunkDispatch *dispatch, Oid rowtype)
 	}
 }
 
+/*
+ * Capture continuous aggregate invalidations in the insert path.
+ *
+ * The invalidation trigger on a chunk fires for every inserted row only to
+ * track the lowest and greatest inserted time value. The chunk dispatch
+ * already computes the time value of each row to route it, so we remove the
+ * trigger from the chunk's result relation and track the range in the chunk
+ * insert state instead. The range is added to the invalidations of the
+ * transaction when the chunk insert state is destroyed.
+ *
+ * The trigger is kept when a BEFORE ROW trigger can change the time value of
+ * a row after it was routed, and for ON CONFLICT DO UPDATE, which fires the
+ * trigger for updated rows.
+ */
+static void
+setup_cagg_invalidation_capture(ChunkInsertState *state, ChunkDispatch *dispatch,
+								const Chunk *chunk, OnConflictAction onconflict_action)
+{
+	ResultRelInfo *relinfo = state->result_relation_info;
+	TriggerDesc *tg = relinfo->ri_TrigDesc;
+	const Hyperspace *hs = dispatch->hypertable->space;
+	Trigger *trigger = NULL;
+	int dimension;
+	int i;
+
+	if (tg == NULL || tg->trig_insert_before_row || onconflict_action == ONCONFLICT_UPDATE ||
+		chunk->relkind != RELKIND_RELATION)
+		return;
+
+	for (i = 0; i < tg->numtriggers; i++)
+	{
+		if (strcmp(tg->triggers[i].tgname, CAGGINVAL_TRIGGER_NAME) == 0)
+		{
+			trigger = &tg->triggers[i];
+			break;
+		}
+	}
+
+	/* Leave triggers that are disabled or only fire for replicas to the trigger manager */
+	if (trigger == NULL || trigger->tgnargs < 1 || trigger->tgenabled != TRIGGER_FIRES_ON_ORIGIN ||
+		SessionReplicationRole == SESSION_REPLICATION_ROLE_REPLICA)
+		return;
+
+	for (dimension = 0; dimension < hs->num_dimensions; dimension++)
+	{
+		if (hs->dimensions[dimension].type == DIMENSION_TYPE_OPEN)
+			break;
+	}
+
+	if (dimension == hs->num_dimensions)
+		return;
+
+	state->cagg_inval_capture = true;
+	state->cagg_inval_dimension = dimension;
+	state->cagg_inval_hypertable_id = atoi(trigger->tgargs[0]);
+	/* Triggers on data nodes log invalidations for the parent hypertable */
+	state->cagg_inval_entry_id =
+		trigger->tgnargs > 1 ? atoi(trigger->tgargs[1]) : state->cagg_inval_hypertable_id;
+	state->cagg_inval_lowest = PG_INT64_MAX;
+	state->cagg_inval_greatest = PG_INT64_MIN;
+
+	/*
+	 * Remove the trigger from the result relation's copy of the trigger
+	 * descriptor. No trigger has fired yet, so the per-trigger executor state
+	 * of the result relation is still unused.
+	 */
+	tg->numtriggers--;
+	memmove(&tg->triggers[i], &tg->triggers[i + 1], (tg->numtriggers - i) * sizeof(Trigger));
+
+	tg->trig_insert_after_row = false;
+	tg->trig_update_after_row = false;
+	tg->trig_delete_after_row = false;
+
+	for (i = 0; i < tg->numtriggers; i++)
+	{
+		int16 tgtype = tg->triggers[i].tgtype;
+
+		if (!TRIGGER_FOR_ROW(tgtype) || !TRIGGER_FOR_AFTER(tgtype))
+			continue;
+
+		tg->trig_insert_after_row |= TRIGGER_FOR_INSERT(tgtype);
+		tg->trig_update_after_row |= TRIGGER_FOR_UPDATE(tgtype);
+		tg->trig_delete_after_row |= TRIGGER_FOR_DELETE(tgtype);
+	}
+
+	if (tg->numtriggers == 0)
+		relinfo->ri_TrigDesc = NULL;
+}
+
 /*
  * Create new insert chunk state.
  *
@@ -605,6 +707,7 @@ ts_chunk_insert_state_create(const Chunk *chunk, ChunkDispatch *dispatch)
 	state->rel = rel;
 	state->result_relation_info = relinfo;
 	state->estate = dispatch->estate;
+	state->dispatch = dispatch;
 	ts_set_compression_status(state, chunk);
 
 	if (relinfo->ri_RelationDesc->rd_rel->relhasindex && relinfo->ri_IndexRelationDescs == NULL)
@@ -630,6 +733,8 @@ ts_chunk_insert_state_create(const Chunk *chunk, ChunkDispatch *dispatch)
 			elog(ERROR, "statement trigger on chunk table not supported");
 	}
 
+	setup_cagg_invalidation_capture(state, dispatch, chunk, onconflict_action);
+
 	parent_rel = table_open(dispatch->hypertable->main_table_relid, AccessShareLock);
 
 	/* Set tuple conversion map, if tuple needs conversion. We don't want to
@@ -655,6 +760,15 @@ ts_chunk_insert_state_create(const Chunk *chunk, ChunkDispatch *dispatch)
 	table_close(parent_rel, AccessShareLock);
 
 	state->chunk_id = chunk->fd.id;
+	state->num_slices = chunk->cube->num_slices;
+	state->range_start = palloc(sizeof(int64) * chunk->cube->num_slices);
+	state->range_end = palloc(sizeof(int64) * chunk->cube->num_slices);
+
+	for (int i = 0; i < chunk->cube->num_slices; i++)
+	{
+		state->range_start[i] = chunk->cube->slices[i]->fd.range_start;
+		state->range_end[i] = chunk->cube->slices[i]->fd.range_end;
+	}
 
 	if (chunk->relkind == RELKIND_FOREIGN_TABLE)
 	{
@@ -712,6 +826,44 @@ ts_chunk_insert_state_create(const Chunk *chunk, ChunkDispatch *dispatch)
 	return state;
 }
 
+/*
+ * Stop maintaining the non-unique indexes of the chunk for the tuples of the
+ * statement, so that they can be built in bulk at the end of the statement.
+ *
+ * This is only done for chunks created by the statement, since their indexes
+ * cannot be used by anyone else before the statement ends. Unique and
+ * exclusion indexes are still maintained to check their constraints for
+ * every tuple. Chunks with row triggers are left alone since the triggers
+ * might query the chunk.
+ *
+ * Returns true if the insertion into any index was deferred.
+ */
+bool
+ts_chunk_insert_state_defer_indexes(ChunkInsertState *state)
+{
+	ResultRelInfo *rri = state->result_relation_info;
+	TriggerDesc *tg = rri->ri_TrigDesc;
+	bool deferred = false;
+	int i;
+
+	if (tg != NULL &&
+		(tg->trig_insert_before_row || tg->trig_insert_after_row || tg->trig_insert_instead_row))
+		return false;
+
+	for (i = 0; i < rri->ri_NumIndices; i++)
+	{
+		IndexInfo *ii = rri->ri_IndexRelationInfo[i];
+
+		if (ii->ii_Unique || ii->ii_ExclusionOps != NULL)
+			continue;
+
+		ii->ii_ReadyForInserts = false;
+		deferred = true;
+	}
+
+	return deferred;
+}
+
 void
 ts_set_compression_status(ChunkInsertState *state, const Chunk *chunk)
 {
@@ -720,6 +872,63 @@ ts_set_compression_status(ChunkInsertState *state, const Chunk *chunk)
 		state->chunk_partial = ts_chunk_is_partial(chunk);
 }
 
+/*
+ * Write the tuples buffered for the chunk with a multi-insert and insert
+ * their index entries.
+ *
+ * Tuples are only buffered for chunks without row triggers, so there are no
+ * AFTER ROW triggers to fire here.
+ */
+void
+ts_chunk_insert_state_flush(ChunkInsertState *state)
+{
+	ResultRelInfo *rri = state->result_relation_info;
+	ChunkDispatch *dispatch = state->dispatch;
+	EState *estate = state->estate;
+	MemoryContext oldcontext;
+
+	if (state->nbuffered == 0)
+		return;
+
+	/* table_multi_insert may leak memory, so use the per-tuple memory context */
+	oldcontext = MemoryContextSwitchTo(GetPerTupleMemoryContext(estate));
+	table_multi_insert(state->rel,
+					   state->buffered_slots,
+					   state->nbuffered,
+					   estate->es_output_cid,
+					   0,
+					   NULL);
+	MemoryContextSwitchTo(oldcontext);
+
+	for (int i = 0; i < state->nbuffered; i++)
+	{
+		if (rri->ri_NumIndices > 0)
+		{
+			List *recheckIndexes;
+			instr_time start;
+
+			ts_insert_stats_start(dispatch->stats, &start);
+			recheckIndexes = ExecInsertIndexTuplesCompat(rri,
+														 state->buffered_slots[i],
+														 estate,
+														 false,
+														 false,
+														 NULL,
+														 NIL);
+			ts_insert_stats_end(dispatch->stats, INSERT_STAGE_INDEX_INSERT, &start);
+			list_free(recheckIndexes);
+		}
+
+		ExecClearTuple(state->buffered_slots[i]);
+	}
+
+	dispatch->buffered_tuples -= state->nbuffered;
+	dispatch->buffered_bytes -= state->buffered_bytes;
+	dispatch->buffered_cis = list_delete_ptr(dispatch->buffered_cis, state);
+	state->nbuffered = 0;
+	state->buffered_bytes = 0;
+}
+
 extern void
 ts_chunk_insert_state_destroy(ChunkInsertState *state)
 {
@@ -734,9 +943,34 @@ ts_chunk_insert_state_destroy(ChunkInsertState *state)
 		CacheInvalidateRelcacheByRelid(chunk_relid);
 	}
 
+	if (state->cagg_inval_capture && state->cagg_inval_lowest <= state->cagg_inval_greatest)
+	{
+		instr_time start;
+
+		ts_insert_stats_start(state->dispatch->stats, &start);
+		ts_cm_functions->continuous_agg_invalidate_inserted_range(state->cagg_inval_hypertable_id,
+																  state->cagg_inval_entry_id,
+																  state->cagg_inval_lowest,
+																  state->cagg_inval_greatest);
+		ts_insert_stats_end(state->dispatch->stats, INSERT_STAGE_CAGG_INVALIDATION, &start);
+	}
+
 	if (rri->ri_FdwRoutine && !rri->ri_usesFdwDirectModify && rri->ri_FdwRoutine->EndForeignModify)
 		rri->ri_FdwRoutine->EndForeignModify(state->estate, rri);
 
+	/* The chunk can be closed while tuples are still buffered for it */
+	ts_chunk_insert_state_flush(state);
+
+	/* Make sure the next tuple is not routed to this chunk without a lookup */
+	if (state->dispatch->prev_cis == state)
+		state->dispatch->prev_cis = NULL;
+
+	if (state->buffered_slots != NULL)
+	{
+		for (int i = 0; i < MAX_BUFFERED_INSERT_TUPLES && state->buffered_slots[i] != NULL; i++)
+			ExecDropSingleTupleTableSlot(state->buffered_slots[i]);
+	}
+
 	destroy_on_conflict_state(state);
 	ExecCloseIndices(state->result_relation_info);
 
@@ -16,6 +16,7 @@
 #include "cross_module_fn.h"
 
 typedef struct TSCopyMultiInsertBuffer TSCopyMultiInsertBuffer;
+typedef struct ChunkDispatch ChunkDispatch;
 
 typedef struct ChunkInsertState
 {
@@ -53,19 +54,48 @@ typedef struct ChunkInsertState
 	TupleConversionMap *hyper_to_chunk_map;
 	MemoryContext mctx;
 	EState *estate;
+	ChunkDispatch *dispatch;
 	List *chunk_data_nodes; /* List of data nodes for the chunk (ChunkDataNode objects) */
 	int32 chunk_id;
 	Oid user_id;
 
+	/*
+	 * Range of the chunk's slice in each dimension, in the order of the
+	 * dimensions of the hyperspace. Used to route tuples to the chunk without
+	 * a lookup as long as they stay within it.
+	 */
+	int16 num_slices;
+	int64 *range_start;
+	int64 *range_end;
+
 	/* for tracking compressed chunks */
 	bool chunk_compressed;
 	bool chunk_partial;
-} ChunkInsertState;
 
-typedef struct ChunkDispatch ChunkDispatch;
+	/*
+	 * Continuous aggregate invalidations tracked by the insert path instead
+	 * of the per-row invalidation trigger on the chunk.
+	 */
+	bool cagg_inval_capture;
+	int cagg_inval_dimension; /* Index of the open dimension in the hyperspace */
+	int32 cagg_inval_hypertable_id;
+	int32 cagg_inval_entry_id;
+	int64 cagg_inval_lowest;
+	int64 cagg_inval_greatest;
+
+	/*
+	 * Tuples of an INSERT buffered for a multi-insert into the chunk. The
+	 * slots are created on demand and reused after each flush.
+	 */
+	TupleTableSlot **buffered_slots;
+	int nbuffered;
+	Size buffered_bytes;
+} ChunkInsertState;
 
 extern ChunkInsertState *ts_chunk_insert_state_create(const Chunk *chunk, ChunkDispatch *dispatch);
 extern void ts_chunk_insert_state_destroy(ChunkInsertState *state);
+extern void ts_chunk_insert_state_flush(ChunkInsertState *state);
+extern bool ts_chunk_insert_state_defer_indexes(ChunkInsertState *state);
 
 OnConflictAction chunk_dispatch_get_on_conflict_action(const ChunkDispatch *dispatch);
 void ts_set_compression_status(ChunkInsertState *state, const Chunk *chunk);
@@ -27,6 +27,7 @@
 #include "guc.h"
 #include "hypertable_cache.h"
 #include "hypertable_modify.h"
+#include "insert_stats.h"
 #include "nodes/chunk_append/chunk_append.h"
 #include "ts_catalog/hypertable_data_node.h"
 
@@ -56,6 +57,9 @@ static bool ExecOnConflictUpdate(ModifyTableContext *context, ResultRelInfo *res
 static void ExecCheckTupleVisible(EState *estate, Relation rel, TupleTableSlot *slot);
 static void ExecCheckTIDVisible(EState *estate, ResultRelInfo *relinfo, ItemPointer tid,
 								TupleTableSlot *tempSlot);
+static bool chunk_insert_state_can_buffer(const ChunkInsertState *cis);
+static void ExecBufferInsert(ModifyTableContext *context, ChunkInsertState *cis,
+							 TupleTableSlot *slot, bool canSetTag);
 #endif
 
 static List *
@@ -142,6 +146,10 @@ hypertable_modify_begin(CustomScanState *node, EState *estate, int eflags)
 	if (estate->es_auxmodifytables && linitial(estate->es_auxmodifytables) == mtstate)
 		linitial(estate->es_auxmodifytables) = node;
 
+	/* Transition tables capture every inserted tuple */
+	if (mtstate->mt_transition_capture != NULL)
+		state->buffered_insert = false;
+
 		/*
 		 * Find all ChunkDispatchState subnodes and set their parent
 		 * ModifyTableState node
@@ -295,6 +303,7 @@ hypertable_modify_state_create(CustomScan *cscan)
 	 * Get the list of data nodes to insert on.
 	 */
 	state->serveroids = lsecond(cscan->custom_private);
+	state->buffered_insert = intVal(lthird(cscan->custom_private)) && ts_guc_enable_buffered_insert;
 
 	/*
 	 * Get the FDW routine for the first data node. It should be the same for
@@ -475,6 +484,7 @@ hypertable_modify_plan_create(PlannerInfo *root, RelOptInfo *rel, CustomPath *be
 	CustomScan *cscan = makeNode(CustomScan);
 	ModifyTable *mt = linitial_node(ModifyTable, custom_plans);
 	FdwRoutine *fdwroutine = NULL;
+	bool buffered_insert;
 
 	cscan->methods = &hypertable_modify_plan_methods;
 	cscan->custom_plans = custom_plans;
@@ -584,6 +594,19 @@ hypertable_modify_plan_create(PlannerInfo *root, RelOptInfo *rel, CustomPath *be
 	 */
 	cscan->custom_private = list_make2(mt->arbiterIndexes, hmpath->serveroids);
 
+	/*
+	 * Tuples of an INSERT can be buffered for multi-inserts into the chunks
+	 * unless every tuple has to be processed on its own, for RETURNING, ON
+	 * CONFLICT or WITH CHECK OPTION. Volatile functions other than nextval()
+	 * might read the hypertable and expect to see the previously inserted
+	 * tuples, like for COPY.
+	 */
+	buffered_insert = mt->operation == CMD_INSERT && mt->onConflictAction == ONCONFLICT_NONE &&
+					  mt->returningLists == NIL && mt->withCheckOptionLists == NIL &&
+					  hmpath->serveroids == NIL &&
+					  !contain_volatile_functions_not_nextval((Node *) root->parse);
+	cscan->custom_private = lappend(cscan->custom_private, makeInteger(buffered_insert));
+
 	return &cscan->scan.plan;
 }
 
@@ -983,7 +1006,22 @@ ExecModifyTable(CustomScanState *cs_node, PlanState *pstate)
 				if (unlikely(!resultRelInfo->ri_projectNewInfoValid))
 					ExecInitInsertProjection(node, resultRelInfo);
 				slot = ExecGetInsertNewTuple(resultRelInfo, context.planSlot);
-				slot = ExecInsert(&context, cds->rri, slot, node->canSetTag);
+				if (ht_state->buffered_insert &&
+					chunk_insert_state_can_buffer(cds->dispatch->prev_cis))
+				{
+					ExecBufferInsert(&context, cds->dispatch->prev_cis, slot, node->canSetTag);
+					slot = NULL;
+				}
+				else
+				{
+					/* Row triggers of the chunk might read tuples that are still buffered */
+					ts_chunk_dispatch_flush(cds->dispatch);
+					slot = ExecInsert(&context,
+									  cds->rri,
+									  slot,
+									  node->canSetTag,
+									  cds->dispatch->stats);
+				}
 				break;
 			case CMD_UPDATE:
 				/* Initialize projection info if first time for this table */
@@ -1054,6 +1092,9 @@ ExecModifyTable(CustomScanState *cs_node, PlanState *pstate)
 	/*
 	 * Insert remaining tuples for batch insert.
 	 */
+	if (cds != NULL)
+		ts_chunk_dispatch_flush(cds->dispatch);
+
 	relinfos = estate->es_opened_result_relations;
 
 	if (ht_state->comp_chunks_processed)
@@ -1488,7 +1529,7 @@ ExecGetUpdateNewTuple(ResultRelInfo *relinfo, TupleTableSlot *planSlot, TupleTab
  */
 TupleTableSlot *
 ExecInsert(ModifyTableContext *context, ResultRelInfo *resultRelInfo, TupleTableSlot *slot,
-		   bool canSetTag)
+		   bool canSetTag, InsertStats *stats)
 {
 	ModifyTableState *mtstate = context->mtstate;
 	EState *estate = context->estate;
@@ -1500,6 +1541,7 @@ ExecInsert(ModifyTableContext *context, ResultRelInfo *resultRelInfo, TupleTable
 	ModifyTable *node = (ModifyTable *) mtstate->ps.plan;
 	OnConflictAction onconflict = node->onConflictAction;
 	MemoryContext oldContext;
+	instr_time start;
 
 	Assert(!mtstate->mt_partition_tuple_routing);
 
@@ -1684,7 +1726,11 @@ ExecInsert(ModifyTableContext *context, ResultRelInfo *resultRelInfo, TupleTable
 		 * Check the constraints of the tuple.
 		 */
 		if (resultRelationDesc->rd_att->constr)
+		{
+			ts_insert_stats_start(stats, &start);
 			ExecConstraints(resultRelInfo, slot, estate);
+			ts_insert_stats_end(stats, INSERT_STAGE_CONSTRAINT_CHECK, &start);
+		}
 
 		/*
 		 * Also check the tuple against the partition constraint, if there is
@@ -1790,6 +1836,7 @@ ExecInsert(ModifyTableContext *context, ResultRelInfo *resultRelInfo, TupleTable
 										   specToken);
 
 			/* insert index entries for tuple */
+			ts_insert_stats_start(stats, &start);
 			recheckIndexes = ExecInsertIndexTuples(resultRelInfo,
 												   slot,
 												   estate,
@@ -1797,6 +1844,7 @@ ExecInsert(ModifyTableContext *context, ResultRelInfo *resultRelInfo, TupleTable
 												   true,
 												   &specConflict,
 												   arbiterIndexes);
+			ts_insert_stats_end(stats, INSERT_STAGE_INDEX_INSERT, &start);
 
 			/* adjust the tuple's state accordingly */
 			table_tuple_complete_speculative(resultRelationDesc, slot, specToken, !specConflict);
@@ -1830,8 +1878,12 @@ ExecInsert(ModifyTableContext *context, ResultRelInfo *resultRelInfo, TupleTable
 
 			/* insert index entries for tuple */
 			if (resultRelInfo->ri_NumIndices > 0)
+			{
+				ts_insert_stats_start(stats, &start);
 				recheckIndexes =
 					ExecInsertIndexTuples(resultRelInfo, slot, estate, false, false, NULL, NIL);
+				ts_insert_stats_end(stats, INSERT_STAGE_INDEX_INSERT, &start);
+			}
 		}
 	}
 
@@ -1894,6 +1946,67 @@ ExecInsert(ModifyTableContext *context, ResultRelInfo *resultRelInfo, TupleTable
 	return result;
 }
 
+/*
+ * Check if tuples for a chunk can be buffered for a multi-insert.
+ *
+ * Row triggers need to see every tuple when it is inserted, and foreign
+ * table chunks and compressed chunks have their own insert paths.
+ */
+static bool
+chunk_insert_state_can_buffer(const ChunkInsertState *cis)
+{
+	const ResultRelInfo *rri = cis->result_relation_info;
+	const TriggerDesc *trigdesc = rri->ri_TrigDesc;
+
+	if (cis->chunk_compressed || rri->ri_FdwRoutine != NULL)
+		return false;
+
+	return trigdesc == NULL ||
+		   (!trigdesc->trig_insert_before_row && !trigdesc->trig_insert_after_row &&
+			!trigdesc->trig_insert_instead_row && !trigdesc->trig_insert_new_table);
+}
+
+/*
+ * Buffer a tuple for a multi-insert into a chunk instead of inserting it
+ * right away.
+ *
+ * This is the part of ExecInsert for a plain insert into a heap without row
+ * triggers, RETURNING, ON CONFLICT and WITH CHECK OPTION: the tuple's
+ * generated columns are computed and its constraints are checked before it
+ * is buffered. The table and index inserts happen when the buffered tuples
+ * are flushed.
+ */
+static void
+ExecBufferInsert(ModifyTableContext *context, ChunkInsertState *cis, TupleTableSlot *slot,
+				 bool canSetTag)
+{
+	EState *estate = context->estate;
+	ResultRelInfo *resultRelInfo = cis->result_relation_info;
+	Relation resultRelationDesc = resultRelInfo->ri_RelationDesc;
+	instr_time start;
+
+	if (resultRelationDesc->rd_rel->relhasindex && resultRelInfo->ri_IndexRelationDescs == NULL)
+		ExecOpenIndices(resultRelInfo, false);
+
+	slot->tts_tableOid = RelationGetRelid(resultRelationDesc);
+
+	if (resultRelationDesc->rd_att->constr &&
+		resultRelationDesc->rd_att->constr->has_generated_stored)
+		ExecComputeStoredGenerated(resultRelInfo, estate, slot, CMD_INSERT);
+
+	if (resultRelationDesc->rd_att->constr)
+	{
+		ts_insert_stats_start(cis->dispatch->stats, &start);
+		ExecConstraints(resultRelInfo, slot, estate);
+		ts_insert_stats_end(cis->dispatch->stats, INSERT_STAGE_CONSTRAINT_CHECK, &start);
+	}
+
+	ts_chunk_dispatch_buffer_tuple(cis->dispatch, cis, slot);
+
+	if (canSetTag)
+		(estate->es_processed)++;
+}
+
 /* ----------------------------------------------------------------
  *		ExecBatchInsert
  *
@@ -30,6 +30,8 @@ typedef struct HypertableModifyState
 	bool comp_chunks_processed;
 	Snapshot snapshot;
 	FdwRoutine *fdwroutine;
+	/* Buffer the tuples of an INSERT for multi-inserts into the chunks */
+	bool buffered_insert;
 } HypertableModifyState;
 
 extern void ts_hypertable_modify_fixup_tlist(Plan *plan);
@@ -39,7 +41,7 @@ extern List *ts_replace_rowid_vars(PlannerInfo *root, List *tlist, int varno);
 
 #if PG14_GE
 extern TupleTableSlot *ExecInsert(ModifyTableContext *context, ResultRelInfo *resultRelInfo,
-								  TupleTableSlot *slot, bool canSetTag);
+								  TupleTableSlot *slot, bool canSetTag, struct InsertStats *stats);
 #endif
 
 #endif /* TIMESCALEDB_HYPERTABLE_MODIFY_H */
@@ -17,6 +17,7 @@
 #include <utils/cash.h>
 #include <utils/catcache.h>
 #include <utils/date.h>
+#include <utils/fmgroids.h>
 #include <utils/inet.h>
 #include <utils/jsonb.h>
 #include <utils/lsyscache.h>
@@ -206,8 +207,29 @@ ts_partitioning_info_create(const char *schema, const char *partfunc, const char
 	{
 		TypeCacheEntry *tce = lookup_type_cache(columntype, TYPECACHE_HASH_FLAGS);
 
-		if (!OidIsValid(tce->hash_proc) && ts_partitioning_func_is_closed_default(schema, partfunc))
-			elog(ERROR, "could not find hash function for type %s", format_type_be(columntype));
+		if (ts_partitioning_func_is_closed_default(schema, partfunc))
+		{
+			if (!OidIsValid(tce->hash_proc))
+				elog(ERROR, "could not find hash function for type %s", format_type_be(columntype));
+
+			pinfo->partfunc.tce = tce;
+
+			switch (tce->hash_proc)
+			{
+				case F_HASHINT2:
+					pinfo->partfunc.hash = PARTITIONING_FUNC_HASH_INT2;
+					break;
+				case F_HASHINT4:
+					pinfo->partfunc.hash = PARTITIONING_FUNC_HASH_INT4;
+					break;
+				case F_HASHINT8:
+					pinfo->partfunc.hash = PARTITIONING_FUNC_HASH_INT8;
+					break;
+				default:
+					pinfo->partfunc.hash = PARTITIONING_FUNC_HASH_TYPE;
+					break;
+			}
+		}
 	}
 
 	partitioning_func_set_func_fmgr(&pinfo->partfunc, columntype, dimtype);
@@ -233,6 +255,49 @@ ts_partitioning_info_create(const char *schema, const char *partfunc, const char
 	return pinfo;
 }
 
+/*
+ * Compute the hash of the default partitioning function without calling it.
+ *
+ * This must give the same result as ts_get_partition_hash().
+ */
+static Datum
+partitioning_func_hash(PartitioningFunc *pf, Oid collation, Datum value)
+{
+	uint32 hash;
+
+	switch (pf->hash)
+	{
+		case PARTITIONING_FUNC_HASH_INT2:
+			hash = DatumGetUInt32(hash_uint32((int32) DatumGetInt16(value)));
+			break;
+		case PARTITIONING_FUNC_HASH_INT4:
+			hash = DatumGetUInt32(hash_uint32(DatumGetInt32(value)));
+			break;
+		case PARTITIONING_FUNC_HASH_INT8:
+		{
+			/* Same as hashint8() */
+			int64 val = DatumGetInt64(value);
+			uint32 lohalf = (uint32) val;
+			uint32 hihalf = (uint32) (val >> 32);
+
+			lohalf ^= (val >= 0) ? hihalf : ~hihalf;
+			hash = DatumGetUInt32(hash_uint32(lohalf));
+			break;
+		}
+		default:
+			Assert(pf->hash == PARTITIONING_FUNC_HASH_TYPE);
+
+			if (!OidIsValid(collation))
+				collation = pf->tce->typcollation;
+
+			hash = DatumGetUInt32(FunctionCall1Coll(&pf->tce->hash_proc_finfo, collation, value));
+			break;
+	}
+
+	/* Only positive numbers */
+	return Int32GetDatum((int32) (hash & 0x7fffffff));
+}
+
 /*
  * Apply a dimension's partitioning function to a value.
  *
@@ -245,6 +310,9 @@ ts_partitioning_func_apply(PartitioningInfo *pinfo, Oid collation, Datum value)
 	LOCAL_FCINFO(fcinfo, 1);
 	Datum result;
 
+	if (pinfo->partfunc.hash != PARTITIONING_FUNC_CALL)
+		return partitioning_func_hash(&pinfo->partfunc, collation, value);
+
 	InitFunctionCallInfoData(*fcinfo, &pinfo->partfunc.func_fmgr, 1, collation, NULL, NULL);
 
 	FC_SET_ARG(fcinfo, 0, value);
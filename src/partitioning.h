@@ -23,6 +23,21 @@
 #define DEFAULT_PARTITIONING_FUNC_SCHEMA INTERNAL_SCHEMA_NAME
 #define DEFAULT_PARTITIONING_FUNC_NAME "get_partition_hash"
 
+/*
+ * How the partitioning function is applied. The default partitioning
+ * function only calls the hash function of the column type, so it is
+ * bypassed for the integer hash functions, which are computed inline, and
+ * for other hash functions, which are called directly.
+ */
+typedef enum PartitioningFuncHash
+{
+	PARTITIONING_FUNC_CALL = 0,
+	PARTITIONING_FUNC_HASH_INT2,
+	PARTITIONING_FUNC_HASH_INT4,
+	PARTITIONING_FUNC_HASH_INT8,
+	PARTITIONING_FUNC_HASH_TYPE,
+} PartitioningFuncHash;
+
 typedef struct PartitioningFunc
 {
 	NameData schema;
@@ -34,6 +49,10 @@ typedef struct PartitioningFunc
 	 * partitioning column's text representation.
 	 */
 	FmgrInfo func_fmgr;
+
+	PartitioningFuncHash hash;
+	/* Type cache entry of the column for PARTITIONING_FUNC_HASH_TYPE */
+	TypeCacheEntry *tce;
 } PartitioningFunc;
 
 typedef struct PartitioningInfo
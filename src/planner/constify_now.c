@@ -16,6 +16,8 @@
 #include "hypertable.h"
 #include "hypertable_cache.h"
 #include "planner.h"
+#include "planning_stats.h"
+#include "scanner.h"
 
 /*
  * This implements an optimization to allow now() expression to be
@@ -58,7 +60,7 @@ is_valid_now_func(Node *node)
 }
 
 static bool
-is_valid_now_expr(OpExpr *op, List *rtable)
+is_valid_now_expr(OpExpr *op, List *rtable, int32 *hypertable_id)
 {
 	int flags = CACHE_FLAG_MISSING_OK | CACHE_FLAG_NOCREATE;
 	/* Var > or Var >= */
@@ -105,6 +107,8 @@ is_valid_now_expr(OpExpr *op, List *rtable)
 	if (!dim || dim->fd.column_type != TIMESTAMPTZOID || dim->column_attno != var->varattno)
 		return false;
 
+	*hypertable_id = dim->fd.hypertable_id;
+
 	/* Var > now() or Var >= now() */
 	if (is_valid_now_func(lsecond(op->args)))
 		return true;
@@ -222,6 +226,45 @@ constify_now_expr(PlannerInfo *root, OpExpr *op)
 	}
 }
 
+/*
+ * Check and constify a single now() expression. Returns NULL if the
+ * expression is not eligible for constification.
+ *
+ * If planning statistics are collected, the time spent is accounted to the
+ * hypertable the expression restricts.
+ */
+static OpExpr *
+constify_now_opexpr(PlannerInfo *root, List *rtable, OpExpr *op)
+{
+	bool instrument = ts_planning_stats_is_active();
+	int32 hypertable_id = INVALID_HYPERTABLE_ID;
+	OpExpr *result = NULL;
+	instr_time start, duration;
+	int64 scan_count = 0;
+
+	INSTR_TIME_SET_ZERO(start);
+	if (instrument)
+	{
+		scan_count = ts_scanner_get_scan_count();
+		INSTR_TIME_SET_CURRENT(start);
+	}
+
+	if (is_valid_now_expr(op, rtable, &hypertable_id))
+		result = constify_now_expr(root, op);
+
+	if (instrument && result != NULL)
+	{
+		PlanningStats *stats = ts_planning_stats_get(hypertable_id);
+
+		INSTR_TIME_SET_CURRENT(duration);
+		INSTR_TIME_SUBTRACT(duration, start);
+		INSTR_TIME_ADD(stats->constify_now_time, duration);
+		stats->catalog_scans += ts_scanner_get_scan_count() - scan_count;
+	}
+
+	return result;
+}
+
 Node *
 ts_constify_now(PlannerInfo *root, List *rtable, Node *node)
 {
@@ -230,13 +273,16 @@ ts_constify_now(PlannerInfo *root, List *rtable, Node *node)
 	switch (nodeTag(node))
 	{
 		case T_OpExpr:
-			if (is_valid_now_expr(castNode(OpExpr, node), rtable))
+		{
+			OpExpr *constified = constify_now_opexpr(root, rtable, castNode(OpExpr, node));
+
+			if (constified != NULL)
 			{
-				List *args =
-					list_make2(copyObject(node), constify_now_expr(root, castNode(OpExpr, node)));
+				List *args = list_make2(copyObject(node), constified);
 				return (Node *) makeBoolExpr(AND_EXPR, args, -1);
 			}
 			break;
+		}
 		case T_BoolExpr:
 		{
 			List *additions = NIL;
@@ -249,10 +295,13 @@ ts_constify_now(PlannerInfo *root, List *rtable, Node *node)
 
 			foreach (lc, be->args)
 			{
-				if (IsA(lfirst(lc), OpExpr) && is_valid_now_expr(lfirst_node(OpExpr, lc), rtable))
+				if (IsA(lfirst(lc), OpExpr))
 				{
-					OpExpr *op = lfirst_node(OpExpr, lc);
-					additions = lappend(additions, constify_now_expr(root, op));
+					OpExpr *constified =
+						constify_now_opexpr(root, rtable, lfirst_node(OpExpr, lc));
+
+					if (constified != NULL)
+						additions = lappend(additions, constified);
 				}
 			}
 
@@ -57,6 +57,8 @@
 #include "partitioning.h"
 #include "partialize.h"
 #include "planner.h"
+#include "planning_stats.h"
+#include "scanner.h"
 #include "time_utils.h"
 
 typedef struct CollectQualCtx
@@ -1311,8 +1313,8 @@ ts_plan_expand_timebucket_annotate(PlannerInfo *root, RelOptInfo *rel)
 
 /* Inspired by expand_inherited_rtentry but expands
  * a hypertable chunks into an append relation. */
-void
-ts_plan_expand_hypertable_chunks(Hypertable *ht, PlannerInfo *root, RelOptInfo *rel)
+static void
+expand_hypertable_chunks(Hypertable *ht, PlannerInfo *root, RelOptInfo *rel, PlanningStats *stats)
 {
 	TimescaleDBPrivate *priv = rel->fdw_private;
 	RangeTblEntry *rte = rt_fetch(rel->relid, root->parse->rtable);
@@ -1362,6 +1364,9 @@ ts_plan_expand_hypertable_chunks(Hypertable *ht, PlannerInfo *root, RelOptInfo *
 	/* Can have zero chunks. */
 	Assert(num_chunks == 0 || chunks != NULL);
 
+	if (stats != NULL)
+		stats->chunks_expanded += num_chunks;
+
 	for (unsigned int i = 0; i < num_chunks; i++)
 	{
 		inh_oids = lappend_oid(inh_oids, chunks[i]->table_id);
@@ -1519,6 +1524,31 @@ ts_plan_expand_hypertable_chunks(Hypertable *ht, PlannerInfo *root, RelOptInfo *
 	}
 }
 
+void
+ts_plan_expand_hypertable_chunks(Hypertable *ht, PlannerInfo *root, RelOptInfo *rel)
+{
+	PlanningStats *stats = ts_planning_stats_get(ht->fd.id);
+	instr_time start, duration;
+	int64 scan_count;
+
+	if (stats == NULL)
+	{
+		expand_hypertable_chunks(ht, root, rel, NULL);
+		return;
+	}
+
+	scan_count = ts_scanner_get_scan_count();
+	INSTR_TIME_SET_CURRENT(start);
+
+	expand_hypertable_chunks(ht, root, rel, stats);
+
+	INSTR_TIME_SET_CURRENT(duration);
+	INSTR_TIME_SUBTRACT(duration, start);
+	INSTR_TIME_ADD(stats->expand_time, duration);
+	stats->catalog_scans += ts_scanner_get_scan_count() - scan_count;
+	stats->expansions++;
+}
+
 void
 propagate_join_quals(PlannerInfo *root, RelOptInfo *rel, CollectQualCtx *ctx)
 {
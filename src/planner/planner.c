@@ -59,6 +59,7 @@
 #include "nodes/hypertable_modify.h"
 #include "partitioning.h"
 #include "planner/planner.h"
+#include "planner/planning_stats.h"
 #include "utils.h"
 
 #include "compat/compat.h"
@@ -301,6 +302,8 @@ typedef struct
 	 * to use the cursor fetcher so that these scans can be interleaved.
 	 */
 	int num_distributed_tables;
+	/* Whether the query was routed to a continuous aggregate */
+	bool routed_to_cagg;
 } PreprocessQueryContext;
 
 /*
@@ -318,6 +321,8 @@ typedef struct
  * 3. Reordering of GROUP BY clauses for continuous aggregates.
  *
  * 4. Constifying now() expressions for primary time dimension.
+ *
+ * 5. Routing aggregate queries on hypertables to continuous aggregates.
  */
 static bool
 preprocess_query(Node *node, PreprocessQueryContext *context)
@@ -359,6 +364,14 @@ preprocess_query(Node *node, PreprocessQueryContext *context)
 		Index rti = 1;
 		bool ret;
 
+		/*
+		 * Only the top-level query is routed, so that queries of continuous
+		 * aggregates, e.g., during a refresh, are never routed to themselves.
+		 */
+		if (query == context->rootquery && ts_guc_enable_optimizations &&
+			ts_guc_enable_cagg_query_routing && ts_cm_functions->continuous_agg_route_query != NULL)
+			context->routed_to_cagg = ts_cm_functions->continuous_agg_route_query(query);
+
 		foreach (lc, query->rtable)
 		{
 			RangeTblEntry *rte = lfirst_node(RangeTblEntry, lc);
@@ -594,6 +607,15 @@ timescaledb_planner(Query *parse, int cursor_opts, ParamListInfo bound_params)
 			 */
 			ts_hypertable_modify_fixup_tlist(stmt->planTree);
 
+			/*
+			 * A query is only routed to a continuous aggregate if the
+			 * materialization is up-to-date, which can change with every
+			 * transaction. Cached plans of routed queries are therefore
+			 * replanned by later transactions.
+			 */
+			if (context.routed_to_cagg)
+				stmt->transientPlan = true;
+
 			foreach (lc, stmt->subplans)
 			{
 				Plan *subplan = (Plan *) lfirst(lc);
@@ -1734,6 +1756,8 @@ _planner_init(void)
 
 	prev_create_upper_paths_hook = create_upper_paths_hook;
 	create_upper_paths_hook = timescaledb_create_upper_paths_hook;
+
+	_planning_stats_init();
 }
 
 void
@@ -1744,4 +1768,6 @@ _planner_fini(void)
 	set_join_pathlist_hook = prev_set_join_pathlist_hook;
 	get_relation_info_hook = prev_get_relation_info_hook;
 	create_upper_paths_hook = prev_create_upper_paths_hook;
+
+	_planning_stats_fini();
 }
@@ -0,0 +1,287 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#include <postgres.h>
+#include <commands/explain.h>
+#include <executor/instrument.h>
+#include <lib/stringinfo.h>
+#include <tcop/tcopprot.h>
+#include <utils/builtins.h>
+#include <utils/lsyscache.h>
+#include <utils/memutils.h>
+
+#include "compat/compat.h"
+#include "extension.h"
+#include "guc.h"
+#include "hypertable.h"
+#include "planning_stats.h"
+
+/*
+ * Per-statement collection of hypertable planning statistics.
+ *
+ * Collection is only active while EXPLAIN plans a statement with
+ * timescaledb.explain_planning enabled. Outside of that window
+ * ts_planning_stats_get() returns NULL and the instrumented code paths skip
+ * all bookkeeping, so the overhead for regular queries is a single branch.
+ */
+static bool planning_stats_active = false;
+static List *planning_stats = NIL;
+static MemoryContext planning_stats_mcxt = NULL;
+
+static ExplainOneQuery_hook_type prev_explain_one_query_hook = NULL;
+
+bool
+ts_planning_stats_is_active(void)
+{
+	return planning_stats_active;
+}
+
+/*
+ * Get the statistics entry for a hypertable, creating it if necessary.
+ *
+ * Returns NULL if statistics are not being collected.
+ */
+PlanningStats *
+ts_planning_stats_get(int32 hypertable_id)
+{
+	PlanningStats *stats;
+	MemoryContext oldmcxt;
+	ListCell *lc;
+
+	if (!planning_stats_active)
+		return NULL;
+
+	foreach (lc, planning_stats)
+	{
+		stats = lfirst(lc);
+
+		if (stats->hypertable_id == hypertable_id)
+			return stats;
+	}
+
+	oldmcxt = MemoryContextSwitchTo(planning_stats_mcxt);
+	stats = palloc0(sizeof(PlanningStats));
+	stats->hypertable_id = hypertable_id;
+	INSTR_TIME_SET_ZERO(stats->restrict_info_time);
+	INSTR_TIME_SET_ZERO(stats->constify_now_time);
+	INSTR_TIME_SET_ZERO(stats->expand_time);
+	planning_stats = lappend(planning_stats, stats);
+	MemoryContextSwitchTo(oldmcxt);
+
+	return stats;
+}
+
+static void
+planning_stats_start(void)
+{
+	planning_stats = NIL;
+	planning_stats_mcxt = CurrentMemoryContext;
+	planning_stats_active = true;
+}
+
+static void
+planning_stats_stop(void)
+{
+	planning_stats_active = false;
+}
+
+static void
+planning_stats_reset(void)
+{
+	planning_stats_active = false;
+	planning_stats = NIL;
+	planning_stats_mcxt = NULL;
+}
+
+static void
+explain_property_time(const char *label, instr_time time, ExplainState *es)
+{
+	ExplainPropertyFloat(label, "ms", 1000.0 * INSTR_TIME_GET_DOUBLE(time), 3, es);
+}
+
+/*
+ * Print the collected statistics as a separate group following the plan.
+ *
+ * Timings are only printed when the summary is requested, in line with how
+ * EXPLAIN prints the total planning time. This keeps the output stable for
+ * EXPLAIN without ANALYZE.
+ */
+static void
+planning_stats_explain(ExplainState *es)
+{
+	ListCell *lc;
+
+	if (planning_stats == NIL)
+		return;
+
+	ExplainOpenGroup("Hypertable Planning", NULL, true, es);
+
+	if (es->format == EXPLAIN_FORMAT_TEXT)
+	{
+		appendStringInfoSpaces(es->str, es->indent * 2);
+		appendStringInfoString(es->str, "Hypertable Planning:\n");
+		es->indent++;
+	}
+
+	ExplainOpenGroup("Hypertables", "Hypertables", false, es);
+
+	foreach (lc, planning_stats)
+	{
+		PlanningStats *stats = lfirst(lc);
+		Oid relid = ts_hypertable_id_to_relid(stats->hypertable_id, false);
+		char *relname = get_rel_name(relid);
+		char *nspname = get_namespace_name(get_rel_namespace(relid));
+
+		ExplainOpenGroup("Hypertable", NULL, true, es);
+
+		if (es->format == EXPLAIN_FORMAT_TEXT)
+		{
+			appendStringInfoSpaces(es->str, es->indent * 2);
+			appendStringInfo(es->str,
+							 "Hypertable: %s\n",
+							 quote_qualified_identifier(nspname, relname));
+			es->indent++;
+		}
+		else
+		{
+			ExplainPropertyText("Schema", nspname, es);
+			ExplainPropertyText("Hypertable", relname, es);
+		}
+
+		ExplainPropertyInteger("Expansions", NULL, stats->expansions, es);
+		ExplainPropertyInteger("Catalog Scans", NULL, stats->catalog_scans, es);
+		ExplainPropertyInteger("Dimension Slices Examined", NULL, stats->slices_examined, es);
+		ExplainPropertyInteger("Chunks Examined", NULL, stats->chunks_examined, es);
+		ExplainPropertyInteger("Chunks After Exclusion", NULL, stats->chunks_expanded, es);
+
+		if (es->summary)
+		{
+			explain_property_time("Chunk Exclusion Time", stats->restrict_info_time, es);
+			explain_property_time("Now Constify Time", stats->constify_now_time, es);
+			explain_property_time("Expansion Time", stats->expand_time, es);
+		}
+
+		if (es->format == EXPLAIN_FORMAT_TEXT)
+			es->indent--;
+
+		ExplainCloseGroup("Hypertable", NULL, true, es);
+	}
+
+	ExplainCloseGroup("Hypertables", "Hypertables", false, es);
+
+	if (es->format == EXPLAIN_FORMAT_TEXT)
+		es->indent--;
+
+	ExplainCloseGroup("Hypertable Planning", NULL, true, es);
+}
+
+/*
+ * Plan and explain a query the same way ExplainOneQuery() does when no hook
+ * is installed, but stop collecting statistics once planning is done so that
+ * planning done at execution time (e.g., by functions called in EXPLAIN
+ * ANALYZE) is not attributed to the explained statement.
+ */
+static void
+explain_one_query(Query *query, int cursorOptions, IntoClause *into, ExplainState *es,
+				  const char *queryString, ParamListInfo params, QueryEnvironment *queryEnv)
+{
+	PlannedStmt *plan;
+	instr_time planstart, planduration;
+#if PG13_GE
+	BufferUsage bufusage_start, bufusage;
+
+	if (es->buffers)
+		bufusage_start = pgBufferUsage;
+#endif
+
+	INSTR_TIME_SET_CURRENT(planstart);
+
+#if PG13_GE
+	plan = pg_plan_query(query, queryString, cursorOptions, params);
+#else
+	plan = pg_plan_query(query, cursorOptions, params);
+#endif
+
+	INSTR_TIME_SET_CURRENT(planduration);
+	INSTR_TIME_SUBTRACT(planduration, planstart);
+
+	planning_stats_stop();
+
+#if PG13_GE
+	if (es->buffers)
+	{
+		memset(&bufusage, 0, sizeof(BufferUsage));
+		BufferUsageAccumDiff(&bufusage, &bufusage_start);
+	}
+
+	ExplainOnePlan(plan,
+				   into,
+				   es,
+				   queryString,
+				   params,
+				   queryEnv,
+				   &planduration,
+				   (es->buffers ? &bufusage : NULL));
+#else
+	ExplainOnePlan(plan, into, es, queryString, params, queryEnv, &planduration);
+#endif
+}
+
+static void
+timescaledb_explain_one_query(Query *query, int cursorOptions, IntoClause *into, ExplainState *es,
+							  const char *queryString, ParamListInfo params,
+							  QueryEnvironment *queryEnv)
+{
+	/* Nested EXPLAINs, e.g., in functions run by EXPLAIN ANALYZE, are not
+	 * instrumented */
+	bool collect =
+		ts_guc_explain_planning && planning_stats_mcxt == NULL && ts_extension_is_loaded();
+
+	if (collect)
+		planning_stats_start();
+
+	PG_TRY();
+	{
+		if (prev_explain_one_query_hook != NULL)
+			prev_explain_one_query_hook(query,
+										cursorOptions,
+										into,
+										es,
+										queryString,
+										params,
+										queryEnv);
+		else
+			explain_one_query(query, cursorOptions, into, es, queryString, params, queryEnv);
+
+		if (collect)
+		{
+			planning_stats_stop();
+			planning_stats_explain(es);
+		}
+	}
+	PG_CATCH();
+	{
+		if (collect)
+			planning_stats_reset();
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+
+	if (collect)
+		planning_stats_reset();
+}
+
+void
+_planning_stats_init(void)
+{
+	prev_explain_one_query_hook = ExplainOneQuery_hook;
+	ExplainOneQuery_hook = timescaledb_explain_one_query;
+}
+
+void
+_planning_stats_fini(void)
+{
+	ExplainOneQuery_hook = prev_explain_one_query_hook;
+}
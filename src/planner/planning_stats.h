@@ -0,0 +1,50 @@
+/*
+ * This file and its contents are licensed under the Apache License 2.0.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-APACHE for a copy of the license.
+ */
+#ifndef TIMESCALEDB_PLANNING_STATS_H
+#define TIMESCALEDB_PLANNING_STATS_H
+
+#include <postgres.h>
+#include <portability/instr_time.h>
+
+/*
+ * Plan-time instrumentation of hypertable expansion.
+ *
+ * When timescaledb.explain_planning is enabled, EXPLAIN collects these
+ * counters for every hypertable that is planned as part of the explained
+ * statement and prints them after the plan.
+ */
+typedef struct PlanningStats
+{
+	int32 hypertable_id;
+	/* Number of times the hypertable was expanded by the planner */
+	int expansions;
+	/* Catalog scans done while expanding and constifying now() */
+	int64 catalog_scans;
+	/* Dimension slices matching the restrictions */
+	int64 slices_examined;
+	/*
+	 * Chunks looked at by plan-time chunk exclusion. With restrictions, these
+	 * are the chunks having a dimension slice that matches some restriction,
+	 * since chunks without matching slices are never read from the catalog.
+	 */
+	int64 chunks_examined;
+	/* Chunks remaining after plan-time chunk exclusion */
+	int64 chunks_expanded;
+	/* Time spent in ts_hypertable_restrict_info_get_chunks() */
+	instr_time restrict_info_time;
+	/* Time spent constifying now() expressions */
+	instr_time constify_now_time;
+	/* Total time spent expanding and locking chunks */
+	instr_time expand_time;
+} PlanningStats;
+
+extern bool ts_planning_stats_is_active(void);
+extern PlanningStats *ts_planning_stats_get(int32 hypertable_id);
+
+extern void _planning_stats_init(void);
+extern void _planning_stats_fini(void);
+
+#endif /* TIMESCALEDB_PLANNING_STATS_H */
@@ -4467,6 +4467,39 @@ process_ddl_sql_drop(EventTriggerDropObject *obj)
 	}
 }
 
+/*
+ * Check if a utility statement leaves the definition of all relations
+ * unchanged. Statements like DO and CALL can run other utility statements,
+ * but these pass through the hook themselves.
+ */
+static bool
+utility_keeps_relations(const Node *parsetree)
+{
+	switch (nodeTag(parsetree))
+	{
+		case T_CallStmt:
+		case T_CheckPointStmt:
+		case T_ClosePortalStmt:
+		case T_CopyStmt:
+		case T_DeallocateStmt:
+		case T_DeclareCursorStmt:
+		case T_DoStmt:
+		case T_ExecuteStmt:
+		case T_ExplainStmt:
+		case T_FetchStmt:
+		case T_ListenStmt:
+		case T_NotifyStmt:
+		case T_PrepareStmt:
+		case T_TransactionStmt:
+		case T_UnlistenStmt:
+		case T_VariableSetStmt:
+		case T_VariableShowStmt:
+			return true;
+		default:
+			return false;
+	}
+}
+
 /*
  * ProcessUtility hook for DDL commands that have not yet been processed by
  * PostgreSQL.
@@ -4502,6 +4535,7 @@ timescaledb_ddl_command_start(PlannedStmt *pstmt, const char *query_string,
 	};
 
 	bool altering_timescaledb = false;
+	bool keep_catalog_relations = utility_keeps_relations(args.parsetree);
 	DDLResult result;
 
 	args.parse_state->p_sourcetext = query_string;
@@ -4513,6 +4547,13 @@ timescaledb_ddl_command_start(PlannedStmt *pstmt, const char *query_string,
 		altering_timescaledb = (strcmp(stmt->extname, EXTENSION_NAME) == 0);
 	}
 
+	/*
+	 * Cached catalog relations cannot be dropped or altered, so don't keep
+	 * them open while running utility statements that might do that.
+	 */
+	if (!keep_catalog_relations)
+		ts_catalog_relation_handles_disable();
+
 	/*
 	 * We don't want to load the extension if we just got the command to alter
 	 * it.
@@ -4520,6 +4561,9 @@ timescaledb_ddl_command_start(PlannedStmt *pstmt, const char *query_string,
 	if (altering_timescaledb || !ts_extension_is_loaded())
 	{
 		prev_ProcessUtility(&args);
+
+		if (!keep_catalog_relations)
+			ts_catalog_relation_handles_enable();
 		return;
 	}
 
@@ -4539,6 +4583,9 @@ timescaledb_ddl_command_start(PlannedStmt *pstmt, const char *query_string,
 
 	if (result == DDL_CONTINUE)
 		prev_ProcessUtility(&args);
+
+	if (!keep_catalog_relations)
+		ts_catalog_relation_handles_enable();
 }
 
 static void
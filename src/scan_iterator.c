@@ -4,6 +4,10 @@
  * LICENSE-APACHE for a copy of the license.
  */
 #include <postgres.h>
+#include <catalog/pg_collation.h>
+#include <catalog/pg_type.h>
+#include <utils/array.h>
+#include <utils/lsyscache.h>
 
 #include "scan_iterator.h"
 
@@ -53,6 +57,47 @@ ts_scan_iterator_scan_key_init(ScanIterator *iterator, AttrNumber attributeNumbe
 	MemoryContextSwitchTo(oldmcxt);
 }
 
+/*
+ * Initialize a scan key that matches any of the given values.
+ *
+ * This allows fetching the tuples for many keys in a single pass over an
+ * index instead of restarting the scan for every key. Note that the tuples
+ * are returned in index order and not in the order of the given values.
+ * Only index scans support this kind of scan key.
+ */
+TSDLLEXPORT void
+ts_scan_iterator_scan_key_init_array(ScanIterator *iterator, AttrNumber attributeNumber,
+									 StrategyNumber strategy, RegProcedure procedure,
+									 Oid element_type, const Datum *values, int num_values)
+{
+	MemoryContext oldmcxt;
+	ArrayType *array;
+	int16 typlen;
+	bool typbyval;
+	char typalign;
+
+	Assert(OidIsValid(iterator->ctx.index));
+	Assert(iterator->ctx.scankey == NULL || iterator->ctx.scankey == iterator->scankey);
+	iterator->ctx.scankey = iterator->scankey;
+
+	if (iterator->ctx.nkeys >= EMBEDDED_SCAN_KEY_SIZE)
+		elog(ERROR, "cannot scan more than %d keys", EMBEDDED_SCAN_KEY_SIZE);
+
+	/* The array must live as long as the scan key */
+	oldmcxt = MemoryContextSwitchTo(iterator->ctx.internal.scan_mcxt);
+	get_typlenbyvalalign(element_type, &typlen, &typbyval, &typalign);
+	array = construct_array((Datum *) values, num_values, element_type, typlen, typbyval, typalign);
+	ScanKeyEntryInitialize(&iterator->scankey[iterator->ctx.nkeys++],
+						   SK_SEARCHARRAY,
+						   attributeNumber,
+						   strategy,
+						   InvalidOid,
+						   C_COLLATION_OID,
+						   procedure,
+						   PointerGetDatum(array));
+	MemoryContextSwitchTo(oldmcxt);
+}
+
 TSDLLEXPORT void
 ts_scan_iterator_rescan(ScanIterator *iterator)
 {
@@ -106,6 +106,11 @@ void TSDLLEXPORT ts_scan_iterator_close(ScanIterator *iterator);
 void TSDLLEXPORT ts_scan_iterator_scan_key_init(ScanIterator *iterator, AttrNumber attributeNumber,
 												StrategyNumber strategy, RegProcedure procedure,
 												Datum argument);
+void TSDLLEXPORT ts_scan_iterator_scan_key_init_array(ScanIterator *iterator,
+													  AttrNumber attributeNumber,
+													  StrategyNumber strategy,
+													  RegProcedure procedure, Oid element_type,
+													  const Datum *values, int num_values);
 
 /*
  * Reset the scan to use a new scan key.
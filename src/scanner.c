@@ -16,6 +16,7 @@
 #include <utils/snapmgr.h>
 
 #include "scanner.h"
+#include "ts_catalog/catalog.h"
 
 enum ScannerType
 {
@@ -36,11 +37,40 @@ typedef struct Scanner
 	void (*closescan)(ScannerCtx *ctx);
 } Scanner;
 
+/*
+ * Catalog relations are opened through the catalog's cache of relations
+ * to avoid a relcache lookup for every scan. Other relations are opened
+ * normally.
+ */
+static Relation
+scanner_table_open(ScannerCtx *ctx)
+{
+	Relation rel = ts_catalog_relation_open_cached(ctx->table, ctx->lockmode);
+
+	ctx->internal.tablerel_cached = (rel != NULL);
+
+	if (rel == NULL)
+		rel = table_open(ctx->table, ctx->lockmode);
+
+	return rel;
+}
+
+static void
+scanner_table_close(ScannerCtx *ctx)
+{
+	LOCKMODE lockmode = (ctx->flags & SCANNER_F_KEEPLOCK) ? NoLock : ctx->lockmode;
+
+	if (ctx->internal.tablerel_cached)
+		ts_catalog_relation_close_cached(ctx->tablerel, lockmode);
+	else
+		table_close(ctx->tablerel, lockmode);
+}
+
 /* Functions implementing heap scans */
 static Relation
 table_scanner_open(ScannerCtx *ctx)
 {
-	ctx->tablerel = table_open(ctx->table, ctx->lockmode);
+	ctx->tablerel = scanner_table_open(ctx);
 	return ctx->tablerel;
 }
 
@@ -78,17 +108,20 @@ table_scanner_endscan(ScannerCtx *ctx)
 static void
 table_scanner_close(ScannerCtx *ctx)
 {
-	LOCKMODE lockmode = (ctx->flags & SCANNER_F_KEEPLOCK) ? NoLock : ctx->lockmode;
-
-	table_close(ctx->tablerel, lockmode);
+	scanner_table_close(ctx);
 }
 
 /* Functions implementing index scans */
 static Relation
 index_scanner_open(ScannerCtx *ctx)
 {
-	ctx->tablerel = table_open(ctx->table, ctx->lockmode);
-	ctx->indexrel = index_open(ctx->index, ctx->lockmode);
+	ctx->tablerel = scanner_table_open(ctx);
+	ctx->indexrel = ts_catalog_relation_open_cached(ctx->index, ctx->lockmode);
+	ctx->internal.indexrel_cached = (ctx->indexrel != NULL);
+
+	if (ctx->indexrel == NULL)
+		ctx->indexrel = index_open(ctx->index, ctx->lockmode);
+
 	return ctx->indexrel;
 }
 
@@ -132,9 +165,24 @@ index_scanner_endscan(ScannerCtx *ctx)
 static void
 index_scanner_close(ScannerCtx *ctx)
 {
-	LOCKMODE lockmode = (ctx->flags & SCANNER_F_KEEPLOCK) ? NoLock : ctx->lockmode;
-	index_close(ctx->indexrel, ctx->lockmode);
-	table_close(ctx->tablerel, lockmode);
+	if (ctx->internal.indexrel_cached)
+		ts_catalog_relation_close_cached(ctx->indexrel, ctx->lockmode);
+	else
+		index_close(ctx->indexrel, ctx->lockmode);
+
+	scanner_table_close(ctx);
+}
+
+/*
+ * Number of scans started or restarted by this backend. Used to attribute
+ * catalog scans to, e.g., the planning of a hypertable.
+ */
+static int64 scan_count = 0;
+
+int64
+ts_scanner_get_scan_count(void)
+{
+	return scan_count;
 }
 
 /*
@@ -182,6 +230,7 @@ ts_scanner_rescan(ScannerCtx *ctx, const ScanKey scankey)
 	oldmcxt = MemoryContextSwitchTo(ctx->internal.scan_mcxt);
 	scanner->rescan(ctx);
 	MemoryContextSwitchTo(oldmcxt);
+	scan_count++;
 }
 
 static void
@@ -304,6 +353,7 @@ ts_scanner_start_scan(ScannerCtx *ctx)
 
 	scanner = scanner_ctx_get_scanner(ctx);
 	scanner->beginscan(ctx);
+	scan_count++;
 
 	tuple_desc = RelationGetDescr(ctx->tablerel);
 
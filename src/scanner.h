@@ -91,6 +91,9 @@ typedef struct InternalScannerCtx
 	 * functions aren't called on, e.g., a per-tuple context.
 	 */
 	MemoryContext scan_mcxt;
+	/* Relations were opened through the catalog's cache of relations */
+	bool tablerel_cached;
+	bool indexrel_cached;
 	bool registered_snapshot;
 	bool started;
 	bool ended;
@@ -161,5 +164,6 @@ extern TSDLLEXPORT HeapTuple ts_scanner_fetch_heap_tuple(const TupleInfo *ti, bo
 														 bool *should_free);
 extern TSDLLEXPORT TupleDesc ts_scanner_get_tupledesc(const TupleInfo *ti);
 extern TSDLLEXPORT void *ts_scanner_alloc_result(const TupleInfo *ti, Size size);
+extern TSDLLEXPORT int64 ts_scanner_get_scan_count(void);
 
 #endif /* TIMESCALEDB_SCANNER_H */
@@ -4,8 +4,11 @@
  * LICENSE-APACHE for a copy of the license.
  */
 #include <postgres.h>
+#include <lib/ilist.h>
 #include <utils/memutils.h>
 
+#include "cache_stats.h"
+#include "debug_assert.h"
 #include "dimension.h"
 #include "dimension_slice.h"
 #include "dimension_vector.h"
@@ -17,14 +20,22 @@
  * root of a tree is a DimensionVec representing the different DimensionSlices
  * for the first dimension. Each of the DimensionSlices of the
  * first dimension point to a DimensionVec of the second dimension. This recurses
- * for the N dimensions. The leaf DimensionSlice points to the data being stored.
+ * for the N dimensions. The leaf DimensionSlice points to a
+ * SubspaceStoreLeaf that wraps the data being stored.
  *
+ * All leaves are also kept in a list ordered by recency of use. When the
+ * store grows beyond its limits, the least recently used leaves are evicted
+ * one at a time.
+ *
+ * Consecutive lookups usually hit the same leaf, e.g., when inserting rows
+ * in time order, so the leaf found by the last lookup is remembered along
+ * with the ranges of its slices, and checked before walking the tree.
  * */
 
 typedef struct SubspaceStoreInternalNode
 {
 	DimensionVec *vector;
-	uint16 descendants;
+	int descendants;
 	bool last_internal_node;
 } SubspaceStoreInternalNode;
 
@@ -32,11 +43,48 @@ typedef struct SubspaceStore
 {
 	MemoryContext mcxt;
 	uint16 num_dimensions;
-	/* limit growth of store by  limiting number of slices in first dimension,	0 for no limit */
-	uint16 max_items;
-	SubspaceStoreInternalNode *origin; /* origin of the tree */
+	/* limit growth of store by limiting number of leaf objects, 0 for no limit */
+	int max_items;
+	/* limit growth of store by limiting the size of leaf objects, 0 for no limit */
+	Size max_bytes;
+	Size num_bytes;
+	Size (*object_size)(void *object);
+	dlist_head lru; /* leaves, most recently used first */
+	SubspaceStoreStats stats;
+	/* Statistics shared by all stores with the same name */
+	CacheStatsEntry *backend_stats;
+	MemoryContextCallback stats_callback;
+	SubspaceStoreInternalNode *origin;   /* origin of the tree */
+	struct SubspaceStoreLeaf *last_leaf; /* leaf found by the last lookup */
 } SubspaceStore;
 
+typedef struct SubspaceStoreLeaf
+{
+	dlist_node lru_node;
+	SubspaceStore *store;
+	void *object;
+	void (*object_free)(void *);
+	Size size;
+	/* range start of the slice in each dimension, used to find the leaf on
+	 * eviction, followed by the range end of the slice in each dimension */
+	int64 coordinates[FLEXIBLE_ARRAY_MEMBER];
+} SubspaceStoreLeaf;
+
+static inline bool
+subspace_store_leaf_contains(const SubspaceStoreLeaf *leaf, const Point *target)
+{
+	int i;
+
+	for (i = 0; i < target->cardinality; i++)
+	{
+		if (target->coordinates[i] < leaf->coordinates[i] ||
+			target->coordinates[i] >= leaf->coordinates[target->cardinality + i])
+			return false;
+	}
+
+	return true;
+}
+
 static inline SubspaceStoreInternalNode *
 subspace_store_internal_node_create(bool last_internal_node)
 {
@@ -55,25 +103,113 @@ subspace_store_internal_node_free(void *node)
 	pfree(node);
 }
 
-static size_t
-subspace_store_internal_node_descendants(SubspaceStoreInternalNode *node, int index)
+static void
+subspace_store_leaf_free(void *ptr)
+{
+	SubspaceStoreLeaf *leaf = ptr;
+
+	if (leaf->store->last_leaf == leaf)
+		leaf->store->last_leaf = NULL;
+
+	dlist_delete(&leaf->lru_node);
+	Assert(leaf->store->num_bytes >= leaf->size);
+	leaf->store->num_bytes -= leaf->size;
+	leaf->store->backend_stats->num_elements--;
+	leaf->store->backend_stats->memory_bytes -= leaf->size;
+
+	if (leaf->object_free != NULL)
+		leaf->object_free(leaf->object);
+
+	pfree(leaf);
+}
+
+/*
+ * Remove the leaf at the given coordinates from the subtree rooted at node.
+ *
+ * Internal nodes that become empty are removed along with the leaf.
+ */
+static void
+subspace_store_internal_node_remove(SubspaceStoreInternalNode *node, const int64 *coordinates)
+{
+	DimensionSlice *slice = ts_dimension_vec_find_slice(node->vector, coordinates[0]);
+	int i;
+
+	Assert(slice != NULL);
+	Assert(node->descendants > 0);
+	node->descendants--;
+
+	if (!node->last_internal_node)
+	{
+		SubspaceStoreInternalNode *child = slice->storage;
+
+		subspace_store_internal_node_remove(child, coordinates + 1);
+
+		if (child->descendants > 0)
+			return;
+	}
+
+	for (i = 0; i < node->vector->num_slices; i++)
+	{
+		if (node->vector->slices[i] == slice)
+			break;
+	}
+
+	Assert(i < node->vector->num_slices);
+	ts_dimension_vec_remove_slice(&node->vector, i);
+}
+
+/*
+ * Evict least recently used leaves until the store is within its limits.
+ *
+ * The most recently used leaf is never evicted, so a single object that is
+ * larger than the memory limit can still be stored.
+ */
+static void
+subspace_store_evict(SubspaceStore *subspace_store)
 {
-	const DimensionSlice *slice = ts_dimension_vec_get(node->vector, index);
+	while (subspace_store->origin->descendants > 1 &&
+		   ((subspace_store->max_items > 0 &&
+			 subspace_store->origin->descendants > subspace_store->max_items) ||
+			(subspace_store->max_bytes > 0 &&
+			 subspace_store->num_bytes > subspace_store->max_bytes)))
+	{
+		SubspaceStoreLeaf *leaf =
+			dlist_tail_element(SubspaceStoreLeaf, lru_node, &subspace_store->lru);
+
+		subspace_store_internal_node_remove(subspace_store->origin, leaf->coordinates);
+		subspace_store->stats.evictions++;
+		subspace_store->backend_stats->evictions++;
+	}
+}
 
-	if (slice == NULL)
-		return 0;
+/*
+ * Remove the objects that are still in the store from the cache statistics
+ * when the store is freed along with its memory context, which is how most
+ * stores end their life.
+ */
+static void
+subspace_store_stats_release(void *arg)
+{
+	SubspaceStore *subspace_store = arg;
 
-	if (node->last_internal_node)
-		return 1;
+	if (subspace_store->origin == NULL)
+		return;
 
-	return ((SubspaceStoreInternalNode *) slice->storage)->descendants;
+	subspace_store->backend_stats->num_elements -= subspace_store->origin->descendants;
+	subspace_store->backend_stats->memory_bytes -= subspace_store->num_bytes;
 }
 
 SubspaceStore *
-ts_subspace_store_init(const Hyperspace *space, MemoryContext mcxt, int16 max_items)
+ts_subspace_store_init(const char *name, const Hyperspace *space, MemoryContext mcxt,
+					   int max_items)
 {
-	MemoryContext old = MemoryContextSwitchTo(mcxt);
-	SubspaceStore *sst = palloc(sizeof(SubspaceStore));
+	MemoryContext old;
+	SubspaceStore *sst;
+
+	Ensure(max_items >= 0, "invalid maximum number of items %d in subspace store", max_items);
+
+	old = MemoryContextSwitchTo(mcxt);
+	sst = palloc(sizeof(SubspaceStore));
 
 	/*
 	 * make sure that the first dimension is a time dimension, otherwise the
@@ -85,22 +221,51 @@ ts_subspace_store_init(const Hyperspace *space, MemoryContext mcxt, int16 max_it
 	sst->num_dimensions = space->num_dimensions;
 	/* max_items = 0 is treated as unlimited */
 	sst->max_items = max_items;
+	sst->max_bytes = 0;
+	sst->num_bytes = 0;
+	sst->object_size = NULL;
+	dlist_init(&sst->lru);
+	memset(&sst->stats, 0, sizeof(sst->stats));
+	sst->backend_stats = ts_cache_stats_get_entry(name);
+	sst->stats_callback.func = subspace_store_stats_release;
+	sst->stats_callback.arg = sst;
+	MemoryContextRegisterResetCallback(mcxt, &sst->stats_callback);
 	sst->mcxt = mcxt;
+	sst->last_leaf = NULL;
 	MemoryContextSwitchTo(old);
 	return sst;
 }
 
+/*
+ * Limit the total size of the objects in the store.
+ *
+ * The size of an object is computed by the object_size function when the
+ * object is added to the store. A max_bytes of 0 means no limit.
+ */
+void
+ts_subspace_store_set_memory_limit(SubspaceStore *subspace_store, Size max_bytes,
+								   Size (*object_size)(void *object))
+{
+	Assert(max_bytes == 0 || object_size != NULL);
+	subspace_store->max_bytes = max_bytes;
+	subspace_store->object_size = object_size;
+	subspace_store->backend_stats->track_memory = (object_size != NULL);
+}
+
 void
 ts_subspace_store_add(SubspaceStore *subspace_store, const Hypercube *hypercube, void *object,
 					  void (*object_free)(void *))
 {
 	SubspaceStoreInternalNode *node = subspace_store->origin;
+	SubspaceStoreLeaf *leaf;
 	DimensionSlice *last = NULL;
 	MemoryContext old = MemoryContextSwitchTo(subspace_store->mcxt);
 	int i;
 
 	Assert(hypercube->num_slices == subspace_store->num_dimensions);
 
+	leaf = palloc(sizeof(SubspaceStoreLeaf) + sizeof(int64) * 2 * hypercube->num_slices);
+
 	for (i = 0; i < hypercube->num_slices; i++)
 	{
 		const DimensionSlice *target = hypercube->slices[i];
@@ -121,9 +286,6 @@ ts_subspace_store_add(SubspaceStore *subspace_store, const Hypercube *hypercube,
 			node = last->storage;
 		}
 
-		Assert(subspace_store->max_items == 0 ||
-			   node->descendants <= (size_t) subspace_store->max_items);
-
 		/*
 		 * We only call this function on a cache miss, so number of leaves
 		 * will definitely increase see `Assert(last != NULL && last->storage
@@ -134,37 +296,6 @@ ts_subspace_store_add(SubspaceStore *subspace_store, const Hypercube *hypercube,
 		Assert(0 == node->vector->num_slices ||
 			   node->vector->slices[0]->fd.dimension_id == target->fd.dimension_id);
 
-		/* Do we have enough space to store the object? */
-		if (subspace_store->max_items > 0 && node->descendants > subspace_store->max_items)
-		{
-			/*
-			 * Always delete the slice corresponding to the earliest time
-			 * range. In the normal case that inserts are performed in
-			 * time-order this is the one least likely to be reused. (Note
-			 * that we made sure that the first dimension is a time dimension
-			 * when creating the subspace_store). If out-of-order inserts are
-			 * become significant we may wish to change this to something more
-			 * sophisticated like LRU.
-			 */
-			size_t items_removed = subspace_store_internal_node_descendants(node, i);
-
-			/*
-			 * descendants at the root is inclusive of the descendants at the
-			 * children, so if we have an overflow it must be in the time dim
-			 */
-			Assert(i == 0);
-
-			Assert(subspace_store->max_items + 1 == node->descendants);
-
-			ts_dimension_vec_remove_slice(&node->vector, i);
-
-			/*
-			 * Note we would have to do this to ancestors if this was not the
-			 * root.
-			 */
-			node->descendants -= items_removed;
-		}
-
 		match = ts_dimension_vec_find_slice(node->vector, target->fd.range_start);
 
 		/* Do we have a slot in this vector for the new object? */
@@ -182,27 +313,61 @@ ts_subspace_store_add(SubspaceStore *subspace_store, const Hypercube *hypercube,
 			match = copy;
 		}
 
-		Assert(subspace_store->max_items == 0 ||
-			   node->descendants <= (size_t) subspace_store->max_items);
-
+		leaf->coordinates[i] = match->fd.range_start;
+		leaf->coordinates[hypercube->num_slices + i] = match->fd.range_end;
 		last = match;
 		/* internal slices point to the next SubspaceStoreInternalNode */
 		node = last->storage;
 	}
 
 	Assert(last != NULL && last->storage == NULL);
-	last->storage = object; /* at the end we store the object */
-	last->storage_free = object_free;
+	leaf->store = subspace_store;
+	leaf->object = object;
+	leaf->object_free = object_free;
+	leaf->size = subspace_store->object_size != NULL ? subspace_store->object_size(object) : 0;
+	subspace_store->num_bytes += leaf->size;
+	subspace_store->backend_stats->num_elements++;
+	subspace_store->backend_stats->memory_bytes += leaf->size;
+	dlist_push_head(&subspace_store->lru, &leaf->lru_node);
+
+	/* at the end we store the object */
+	last->storage = leaf;
+	last->storage_free = subspace_store_leaf_free;
+
+	subspace_store_evict(subspace_store);
 	MemoryContextSwitchTo(old);
 }
 
-void *
-ts_subspace_store_get(const SubspaceStore *subspace_store, const Point *target)
+/*
+ * Walk the tree to find the leaf for the subspace that a point is in.
+ */
+static SubspaceStoreLeaf *
+subspace_store_find_leaf(SubspaceStore *subspace_store, const Point *target)
 {
 	int i;
 	DimensionVec *vec = subspace_store->origin->vector;
 	DimensionSlice *match = NULL;
 
+	for (i = 0; i < target->cardinality; i++)
+	{
+		match = ts_dimension_vec_find_slice(vec, target->coordinates[i]);
+
+		if (NULL == match)
+			return NULL;
+
+		if (i < target->cardinality - 1)
+			vec = ((SubspaceStoreInternalNode *) match->storage)->vector;
+	}
+	Assert(match != NULL);
+
+	return match->storage;
+}
+
+void *
+ts_subspace_store_get(SubspaceStore *subspace_store, const Point *target)
+{
+	SubspaceStoreLeaf *leaf = subspace_store->last_leaf;
+
 	Assert(target->cardinality == subspace_store->num_dimensions);
 
 	/* The internal compressed hypertable has no dimensions as
@@ -211,24 +376,54 @@ ts_subspace_store_get(const SubspaceStore *subspace_store, const Point *target)
 	if (subspace_store->num_dimensions == 0)
 		return NULL;
 
-	for (i = 0; i < target->cardinality; i++)
+	if (leaf == NULL || !subspace_store_leaf_contains(leaf, target))
 	{
-		match = ts_dimension_vec_find_slice(vec, target->coordinates[i]);
+		leaf = subspace_store_find_leaf(subspace_store, target);
 
-		if (NULL == match)
+		if (NULL == leaf)
+		{
+			subspace_store->stats.misses++;
+			subspace_store->backend_stats->misses++;
 			return NULL;
+		}
 
-		vec = ((SubspaceStoreInternalNode *) match->storage)->vector;
+		subspace_store->last_leaf = leaf;
 	}
-	Assert(match != NULL);
-	return match->storage;
+
+	subspace_store->stats.hits++;
+	subspace_store->backend_stats->hits++;
+
+	/* Mark as most recently used */
+	if (dlist_head_node(&subspace_store->lru) != &leaf->lru_node)
+		dlist_move_head(&subspace_store->lru, &leaf->lru_node);
+
+	return leaf->object;
 }
 
+/*
+ * Count a hit for an object that the caller found without calling
+ * ts_subspace_store_get, e.g., because it kept the object of the previous
+ * lookup, so that the statistics reflect all lookups in the store.
+ */
+void
+ts_subspace_store_count_hit(SubspaceStore *subspace_store)
+{
+	subspace_store->stats.hits++;
+	subspace_store->backend_stats->hits++;
+}
+
+/*
+ * Free all objects in the store.
+ *
+ * The store itself is freed with its memory context since the context still
+ * references it through the reset callback.
+ */
 void
 ts_subspace_store_free(SubspaceStore *subspace_store)
 {
 	subspace_store_internal_node_free(subspace_store->origin);
-	pfree(subspace_store);
+	subspace_store->origin = NULL;
+	subspace_store->last_leaf = NULL;
 }
 
 MemoryContext
@@ -236,3 +431,9 @@ ts_subspace_store_mcxt(const SubspaceStore *subspace_store)
 {
 	return subspace_store->mcxt;
 }
+
+const SubspaceStoreStats *
+ts_subspace_store_stats(const SubspaceStore *subspace_store)
+{
+	return &subspace_store->stats;
+}
@@ -19,18 +19,30 @@ typedef struct Hypercube Hypercube;
 typedef struct Point Point;
 typedef struct SubspaceStore SubspaceStore;
 
-extern SubspaceStore *ts_subspace_store_init(const Hyperspace *space, MemoryContext mcxt,
-											 int16 max_items);
+typedef struct SubspaceStoreStats
+{
+	int64 hits;
+	int64 misses;
+	int64 evictions;
+} SubspaceStoreStats;
+
+extern SubspaceStore *ts_subspace_store_init(const char *name, const Hyperspace *space,
+											 MemoryContext mcxt, int max_items);
+extern void ts_subspace_store_set_memory_limit(SubspaceStore *subspace_store, Size max_bytes,
+											   Size (*object_size)(void *object));
 
 /* Store an object associate with the subspace represented by a hypercube */
 extern void ts_subspace_store_add(SubspaceStore *subspace_store, const Hypercube *hypercube,
 								  void *object, void (*object_free)(void *));
 
-/* Get the object stored for the subspace that a point is in.
+/* Get the object stored for the subspace that a point is in and mark it as
+ * the most recently used object.
  * Return the object stored or NULL if this subspace is not in the store.
  */
-extern void *ts_subspace_store_get(const SubspaceStore *subspace_store, const Point *target);
+extern void *ts_subspace_store_get(SubspaceStore *subspace_store, const Point *target);
+extern void ts_subspace_store_count_hit(SubspaceStore *subspace_store);
 extern void ts_subspace_store_free(SubspaceStore *subspace_store);
 extern MemoryContext ts_subspace_store_mcxt(const SubspaceStore *subspace_store);
+extern const SubspaceStoreStats *ts_subspace_store_stats(const SubspaceStore *subspace_store);
 
 #endif /* TIMESCALEDB_SUBSPACE_STORE_H */
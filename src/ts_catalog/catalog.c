@@ -12,9 +12,13 @@
 #include <utils/regproc.h>
 #include <utils/syscache.h>
 #include <utils/inval.h>
+#include <utils/rel.h>
+#include <utils/resowner.h>
+#include <access/relation.h>
 #include <access/xact.h>
 #include <access/htup_details.h>
 #include <miscadmin.h>
+#include <storage/lmgr.h>
 #include <commands/dbcommands.h>
 #include <commands/sequence.h>
 
@@ -536,6 +540,19 @@ ts_catalog_get(void)
 
 		s_catalog.functions[i].function_id = funclist->oid;
 	}
+
+	for (i = 0; i < _MAX_CATALOG_TABLES; i++)
+	{
+		int j;
+
+		s_catalog.relids[s_catalog.num_relids++] = s_catalog.tables[i].id;
+
+		for (j = 0; j < _MAX_TABLE_INDEXES; j++)
+			if (OidIsValid(s_catalog.tables[i].index_ids[j]))
+				s_catalog.relids[s_catalog.num_relids++] = s_catalog.tables[i].index_ids[j];
+	}
+
+	qsort(s_catalog.relids, s_catalog.num_relids, sizeof(Oid), oid_cmp);
 	s_catalog.initialized = true;
 
 	return &s_catalog;
@@ -550,6 +567,216 @@ ts_catalog_reset(void)
 	ts_cache_invalidate_set_proxy_tables(InvalidOid, InvalidOid);
 }
 
+/*
+ * Transaction-scoped cache of open catalog relations.
+ *
+ * Catalog tables and their indexes are opened for every scan, and hot paths
+ * like chunk lookups on insert do many small scans per statement. Instead of
+ * looking up the relation in the relcache for every scan, keep the catalog
+ * relations that were opened in the current transaction referenced until the
+ * end of the transaction.
+ *
+ * Opening a cached relation still takes the requested lock, which also
+ * processes pending invalidations so that the cached relation is up to date.
+ * The references are owned by the top-level transaction.
+ *
+ * A relation that is referenced cannot be dropped or altered, so unused
+ * relations are released, and the cache is disabled, while utility
+ * statements run. Relations in use by an ongoing scan are kept until the end
+ * of the transaction.
+ *
+ * Handles are indexed by the position of the relation in the sorted array of
+ * catalog relids, so that both checking whether a relation is a catalog
+ * relation and finding its handle is a binary search.
+ */
+typedef struct CatalogRelationHandle
+{
+	Relation rel;
+	int usecount;
+} CatalogRelationHandle;
+
+static CatalogRelationHandle catalog_relation_handles[_MAX_CATALOG_RELATIONS];
+static int catalog_num_relation_handles = 0;
+static int catalog_relation_handles_disabled = 0;
+static bool catalog_relation_handles_xact_ending = false;
+
+/*
+ * Get the position of a relation in the sorted array of catalog relids, or -1
+ * if it is not a catalog relation.
+ */
+static int
+catalog_relation_position(Oid relid)
+{
+	Oid *found = bsearch(&relid, s_catalog.relids, s_catalog.num_relids, sizeof(Oid), oid_cmp);
+
+	return found == NULL ? -1 : found - s_catalog.relids;
+}
+
+/*
+ * Open a catalog table or index using the cache of relation handles.
+ *
+ * Returns NULL if the relation is not a catalog relation or the cache cannot
+ * be used, in which case the relation should be opened normally. A relation
+ * returned by this function must be closed with
+ * ts_catalog_relation_close_cached().
+ */
+Relation
+ts_catalog_relation_open_cached(Oid relid, LOCKMODE lockmode)
+{
+	CatalogRelationHandle *handle;
+	int position;
+
+	if (!catalog_is_valid(&s_catalog) || catalog_relation_handles_disabled > 0 ||
+		catalog_relation_handles_xact_ending || !IsTransactionState() ||
+		TopTransactionResourceOwner == NULL)
+		return NULL;
+
+	position = catalog_relation_position(relid);
+
+	if (position < 0)
+		return NULL;
+
+	handle = &catalog_relation_handles[position];
+
+	if (handle->rel == NULL)
+	{
+		ResourceOwner oldowner;
+
+		/* Take the lock before opening, like relation_open() */
+		if (lockmode != NoLock)
+			LockRelationOid(relid, lockmode);
+
+		oldowner = CurrentResourceOwner;
+		CurrentResourceOwner = TopTransactionResourceOwner;
+		handle->rel = relation_open(relid, NoLock);
+		handle->usecount = 0;
+		CurrentResourceOwner = oldowner;
+		catalog_num_relation_handles++;
+	}
+	else if (RelationGetRelid(handle->rel) != relid)
+	{
+		/* The catalog was reset in this transaction, so don't mix relations */
+		return NULL;
+	}
+	else if (lockmode != NoLock)
+		LockRelationOid(relid, lockmode);
+
+	handle->usecount++;
+
+	return handle->rel;
+}
+
+void
+ts_catalog_relation_close_cached(Relation rel, LOCKMODE lockmode)
+{
+	int position = catalog_relation_position(RelationGetRelid(rel));
+
+	if (position >= 0 && catalog_relation_handles[position].rel == rel)
+	{
+		Assert(catalog_relation_handles[position].usecount > 0);
+		catalog_relation_handles[position].usecount--;
+	}
+
+	if (lockmode != NoLock)
+		UnlockRelationOid(RelationGetRelid(rel), lockmode);
+}
+
+/*
+ * Release the cached relations. If only_unused is set, relations that are
+ * in use by a scan are kept.
+ */
+static void
+catalog_relation_handles_release(bool only_unused)
+{
+	ResourceOwner oldowner = CurrentResourceOwner;
+	int i;
+
+	CurrentResourceOwner = TopTransactionResourceOwner;
+
+	for (i = 0; i < _MAX_CATALOG_RELATIONS && catalog_num_relation_handles > 0; i++)
+	{
+		CatalogRelationHandle *handle = &catalog_relation_handles[i];
+
+		if (handle->rel == NULL || (only_unused && handle->usecount > 0))
+			continue;
+
+		RelationClose(handle->rel);
+		handle->rel = NULL;
+		catalog_num_relation_handles--;
+	}
+
+	CurrentResourceOwner = oldowner;
+}
+
+/*
+ * Disable the cache of relation handles while running utility statements.
+ * Calls must be paired with ts_catalog_relation_handles_enable(), but the
+ * cache is enabled again at the end of the transaction in case of errors.
+ */
+void
+ts_catalog_relation_handles_disable(void)
+{
+	if (catalog_num_relation_handles > 0)
+		catalog_relation_handles_release(true);
+
+	catalog_relation_handles_disabled++;
+}
+
+void
+ts_catalog_relation_handles_enable(void)
+{
+	if (catalog_relation_handles_disabled > 0)
+		catalog_relation_handles_disabled--;
+}
+
+static void
+catalog_relation_handles_xact_end(XactEvent event, void *arg)
+{
+	switch (event)
+	{
+		case XACT_EVENT_PRE_COMMIT:
+		case XACT_EVENT_PARALLEL_PRE_COMMIT:
+		case XACT_EVENT_PRE_PREPARE:
+			/*
+			 * Release the references before the resource owner complains
+			 * about leaked references. Other callbacks might still scan the
+			 * catalog, so don't cache any more relations in this
+			 * transaction.
+			 */
+			catalog_relation_handles_release(false);
+			catalog_relation_handles_xact_ending = true;
+			break;
+		case XACT_EVENT_ABORT:
+		case XACT_EVENT_PARALLEL_ABORT:
+			/* The references are released by the resource owner */
+			MemSet(catalog_relation_handles, 0, sizeof(catalog_relation_handles));
+			catalog_num_relation_handles = 0;
+			catalog_relation_handles_disabled = 0;
+			catalog_relation_handles_xact_ending = false;
+			break;
+		case XACT_EVENT_COMMIT:
+		case XACT_EVENT_PARALLEL_COMMIT:
+		case XACT_EVENT_PREPARE:
+			Assert(catalog_num_relation_handles == 0);
+			catalog_num_relation_handles = 0;
+			catalog_relation_handles_disabled = 0;
+			catalog_relation_handles_xact_ending = false;
+			break;
+	}
+}
+
+void
+_catalog_init(void)
+{
+	RegisterXactCallback(catalog_relation_handles_xact_end, NULL);
+}
+
+void
+_catalog_fini(void)
+{
+	UnregisterXactCallback(catalog_relation_handles_xact_end, NULL);
+}
+
 static CatalogTable
 catalog_get_table(Catalog *catalog, Oid relid)
 {
@@ -1317,6 +1317,9 @@ typedef enum Anum_compression_chunk_size_pkey
  * This needs to be bumped in case of new catalog tables that have more indexes.
  */
 #define _MAX_TABLE_INDEXES 5
+
+/* The maximum number of catalog tables and indexes */
+#define _MAX_CATALOG_RELATIONS (_MAX_CATALOG_TABLES * (_MAX_TABLE_INDEXES + 1))
 /************************************
  *
  * Remote txn table of 2pc commits
@@ -1450,6 +1453,10 @@ typedef struct Catalog
 		Oid function_id;
 	} functions[_MAX_INTERNAL_FUNCTIONS];
 
+	/* Relids of all catalog tables and indexes, sorted for lookups */
+	Oid relids[_MAX_CATALOG_RELATIONS];
+	int num_relids;
+
 	bool initialized;
 } Catalog;
 
@@ -1491,6 +1498,12 @@ extern void ts_catalog_table_info_init(CatalogTableInfo *tables, int max_table,
 extern TSDLLEXPORT CatalogDatabaseInfo *ts_catalog_database_info_get(void);
 extern TSDLLEXPORT Catalog *ts_catalog_get(void);
 extern void ts_catalog_reset(void);
+extern TSDLLEXPORT Relation ts_catalog_relation_open_cached(Oid relid, LOCKMODE lockmode);
+extern TSDLLEXPORT void ts_catalog_relation_close_cached(Relation rel, LOCKMODE lockmode);
+extern void ts_catalog_relation_handles_disable(void);
+extern void ts_catalog_relation_handles_enable(void);
+extern void _catalog_init(void);
+extern void _catalog_fini(void);
 extern bool ts_is_catalog_table(Oid relid);
 
 /* Functions should operate on a passed-in Catalog struct */
@@ -80,8 +80,8 @@ cagg_watermark_init_scan_by_mat_hypertable_id(ScanIterator *iterator, const int3
 								   Int32GetDatum(mat_hypertable_id));
 }
 
-static int64
-cagg_watermark_get(Hypertable *mat_ht)
+int64
+ts_cagg_watermark_get(Hypertable *mat_ht)
 {
 	PG_USED_FOR_ASSERTS_ONLY short count = 0;
 	Datum watermark = (Datum) 0;
@@ -152,7 +152,7 @@ cagg_watermark_create(const ContinuousAgg *cagg, MemoryContext top_mctx)
 						cagg->data.mat_hypertable_id)));
 
 	/* Get the stored watermark */
-	watermark->value = cagg_watermark_get(ht);
+	watermark->value = ts_cagg_watermark_get(ht);
 
 	return watermark;
 }
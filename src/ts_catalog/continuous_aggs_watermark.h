@@ -13,6 +13,7 @@
 #include "hypertable.h"
 
 extern TSDLLEXPORT void ts_cagg_watermark_delete_by_mat_hypertable_id(int32 mat_hypertable_id);
+extern TSDLLEXPORT int64 ts_cagg_watermark_get(Hypertable *mat_ht);
 extern TSDLLEXPORT void ts_cagg_watermark_insert(Hypertable *mat_ht, int64 watermark,
 												 bool watermark_isnull);
 extern TSDLLEXPORT void ts_cagg_watermark_update(Hypertable *mat_ht, int64 watermark,
@@ -31,6 +31,7 @@
 #include <utils/fmgroids.h>
 #include <utils/fmgrprotos.h>
 #include <utils/lsyscache.h>
+#include <utils/memutils.h>
 #include <utils/relcache.h>
 #include <utils/syscache.h>
 
@@ -1210,6 +1211,33 @@ ts_get_relnatts(Oid relid)
 	return result;
 }
 
+/*
+ * Get the total memory allocated by a memory context and its children.
+ *
+ * MemoryContextMemAllocated() is only available in PG13 and later, so fall
+ * back to the context statistics on older versions.
+ */
+Size
+ts_memory_context_allocated(MemoryContext context)
+{
+#if PG13_GE
+	return MemoryContextMemAllocated(context, true);
+#else
+	MemoryContextCounters counters;
+	MemoryContext child;
+	Size total;
+
+	memset(&counters, 0, sizeof(counters));
+	context->methods->stats(context, NULL, NULL, &counters);
+	total = counters.totalspace;
+
+	for (child = context->firstchild; child != NULL; child = child->nextchild)
+		total += ts_memory_context_allocated(child);
+
+	return total;
+#endif
+}
+
 /*
  * Wrap AlterTableInternal() for event trigger handling.
  *
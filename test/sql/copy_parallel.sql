@@ -0,0 +1,82 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+
+-- Test COPY into a hypertable with parallel workers.
+create table uk_price_paid(price integer, "date" date, postcode1 text, postcode2 text, type smallint, is_new bool, duration smallint, addr1 text, addr2 text, street text, locality text, town text, district text, country text, category smallint);
+create table uk_price_paid_serial(like uk_price_paid);
+select create_hypertable('uk_price_paid', 'date', chunk_time_interval => interval '90 day');
+
+set timescaledb.max_parallel_copy_workers = 2;
+-- Parallel COPY is not atomic, so it has to be enabled explicitly
+set timescaledb.enable_nonatomic_parallel_copy = on;
+
+-- Use enough data for several blocks of rows
+\copy uk_price_paid from program 'bash -c "cat <(zcat < data/prices-10k-random-1.tsv.gz) <(zcat < data/prices-10k-random-1.tsv.gz) <(zcat < data/prices-10k-random-1.tsv.gz)"';
+\copy uk_price_paid_serial from program 'bash -c "cat <(zcat < data/prices-10k-random-1.tsv.gz) <(zcat < data/prices-10k-random-1.tsv.gz) <(zcat < data/prices-10k-random-1.tsv.gz)"';
+
+select count(*) from uk_price_paid;
+select count(*) from (select * from uk_price_paid except all select * from uk_price_paid_serial) a;
+select count(*) from (select * from uk_price_paid_serial except all select * from uk_price_paid) a;
+
+-- The workers cannot see the changes of a transaction block, so a COPY
+-- within one uses a serial copy and can be rolled back
+begin;
+\copy uk_price_paid from program 'bash -c "zcat < data/prices-10k-random-1.tsv.gz"';
+select count(*) from uk_price_paid;
+rollback;
+select count(*) from uk_price_paid;
+
+-- Columns that are not copied get their defaults and errors in the workers
+-- are reported by the leader
+create table readings(time timestamptz not null, device int, value float default 1.5);
+select create_hypertable('readings', 'time');
+
+copy readings(time, device) from stdin;
+2023-01-01 00:00	1
+2023-01-01 00:01	2
+2023-02-01 00:00	3
+\.
+
+select * from readings order by time;
+
+\set ON_ERROR_STOP 0
+copy readings from stdin;
+2023-03-01 00:00	1	1
+2023-03-01 00:01	two	2
+\.
+
+copy readings from stdin;
+2023-03-01 00:00	1	1	1
+\.
+\set ON_ERROR_STOP 1
+
+-- Without enabling non-atomic parallel COPY the rows are inserted by a
+-- serial copy
+set timescaledb.enable_nonatomic_parallel_copy = off;
+
+copy readings from stdin;
+2023-03-01 00:00	4	4
+\.
+
+set timescaledb.enable_nonatomic_parallel_copy = on;
+
+-- The blocks that were committed before an error are kept and the leader
+-- reports their number of rows. With a single worker the blocks are
+-- inserted in order, so the kept rows are a prefix of the input that ends
+-- before the failing row. Their number depends on the block size, so only
+-- these properties are checked. The serial table has the same input in
+-- order.
+create table uk_price_paid_errors(like uk_price_paid);
+select create_hypertable('uk_price_paid_errors', 'date', chunk_time_interval => interval '90 day');
+
+set timescaledb.max_parallel_copy_workers = 1;
+\set ON_ERROR_STOP 0
+\copy uk_price_paid_errors from program 'bash -c "cat <(zcat < data/prices-10k-random-1.tsv.gz) <(zcat < data/prices-10k-random-1.tsv.gz) <(zcat < data/prices-10k-random-1.tsv.gz) <(echo bad)"';
+\set ON_ERROR_STOP 1
+select count(*) as committed from uk_price_paid_errors \gset
+select :committed > 0 as some_committed, :committed < 30000 as last_block_rolled_back;
+select count(*) from (select * from uk_price_paid_errors except all select (p).* from (select p, row_number() over (order by ctid) as line from uk_price_paid_serial p) s where line <= :committed) a;
+
+reset timescaledb.max_parallel_copy_workers;
+reset timescaledb.enable_nonatomic_parallel_copy;
@@ -0,0 +1,46 @@
+-- This file and its contents are licensed under the Apache License 2.0.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-APACHE for a copy of the license.
+
+CREATE TABLE planning(time timestamptz NOT NULL, device int, value float);
+SELECT table_name FROM create_hypertable('planning', 'time', 'device', 2, chunk_time_interval => interval '1 day');
+INSERT INTO planning
+SELECT t, d, 1 FROM generate_series('2023-01-01 00:00+00'::timestamptz, '2023-01-03 12:00+00', interval '12 hour') t,
+    generate_series(1, 10) d;
+SELECT count(*) FROM show_chunks('planning');
+
+-- Get the hypertable planning statistics of a query, leaving out the
+-- timings and the number of catalog scans, which are not stable
+CREATE FUNCTION planning_stats(query text)
+RETURNS TABLE(hypertable text, expansions int, slices_examined int, chunks_examined int,
+    chunks_after_exclusion int, has_catalog_scans bool)
+LANGUAGE plpgsql AS
+$$
+DECLARE
+    plan json;
+BEGIN
+    EXECUTE format('EXPLAIN (costs off, format json) %s', query) INTO plan;
+    RETURN QUERY
+    SELECT s->>'Hypertable', (s->>'Expansions')::int, (s->>'Dimension Slices Examined')::int,
+        (s->>'Chunks Examined')::int, (s->>'Chunks After Exclusion')::int,
+        (s->>'Catalog Scans')::int > 0
+    FROM jsonb_path_query(plan::jsonb, '$[*].Hypertables[*]') s;
+END
+$$;
+
+-- nothing is collected unless enabled
+SELECT * FROM planning_stats('SELECT * FROM planning');
+
+SET timescaledb.explain_planning = on;
+
+-- all chunks are examined without restrictions
+SELECT * FROM planning_stats('SELECT * FROM planning');
+
+-- only the chunks in the matching time slice are examined
+SELECT * FROM planning_stats($$SELECT * FROM planning WHERE time < '2023-01-02 00:00+00'$$);
+
+-- chunks matching the restriction of either dimension are examined, but
+-- only the chunk matching both remains
+SELECT * FROM planning_stats($$SELECT * FROM planning WHERE time < '2023-01-02 00:00+00' AND device = 1$$);
+
+RESET timescaledb.explain_planning;
@@ -72,3 +72,21 @@ INSERT into test_table_int SELECT generate_series( 1, 20), 100;
 \x
 SELECT * FROM timescaledb_information.dimensions ORDER BY hypertable_name, dimension_number;
 \x
+
+-- Cache statistics are cumulative, so only check that they are collected
+SELECT cache_name, hits > 0 AS has_hits, misses > 0 AS has_misses, num_elements, memory_bytes
+FROM timescaledb_information.cache_stats
+WHERE cache_name = 'chunk_insert_states';
+SELECT cache_name, hits > 0 AS has_hits, misses > 0 AS has_misses
+FROM timescaledb_information.cache_stats_shared
+WHERE cache_name IN ('chunk_insert_states', 'hypertable_cache')
+ORDER BY cache_name;
+
+-- Tuples routed to the chunk of the previous tuple count as hits
+SELECT hits AS hits_before, misses AS misses_before
+FROM timescaledb_information.cache_stats
+WHERE cache_name = 'chunk_insert_states' \gset
+INSERT INTO test_table_int SELECT generate_series(21, 40), 100;
+SELECT hits - :hits_before AS hits, misses - :misses_before AS misses
+FROM timescaledb_information.cache_stats
+WHERE cache_name = 'chunk_insert_states';
@@ -30,3 +30,100 @@ FROM many_partitions_test
 GROUP BY period, device;
 
 SELECT * FROM many_partitions_test_1m ORDER BY time, device LIMIT 10;
+
+-- Buffered multi-row inserts. Rows alternate between chunks and only two
+-- chunks are kept open, so chunks with buffered rows get closed.
+CREATE TABLE buffered_insert(time timestamptz NOT NULL, device int, temp float8 CHECK (temp < 10000));
+SELECT table_name FROM create_hypertable('buffered_insert', 'time', chunk_time_interval => interval '1 day');
+CREATE UNIQUE INDEX ON buffered_insert(time, device);
+
+SET timescaledb.max_open_chunks_per_insert = 2;
+INSERT INTO buffered_insert
+SELECT '2020-01-01'::timestamptz + (i % 5) * interval '1 day' + i * interval '1 second', i % 3, i
+FROM generate_series(1, 5000) i;
+RESET timescaledb.max_open_chunks_per_insert;
+
+SELECT count(*), sum(temp), count(DISTINCT tableoid) FROM buffered_insert;
+SET enable_seqscan = false;
+SELECT count(*) FROM buffered_insert WHERE time > '2020-01-01' AND device = 1;
+RESET enable_seqscan;
+
+-- unique and check constraints of buffered rows are still enforced
+DO $$
+BEGIN
+    INSERT INTO buffered_insert VALUES ('2020-02-01', 1, 1), ('2020-02-01', 1, 2);
+EXCEPTION WHEN unique_violation THEN
+    RAISE NOTICE 'unique violation';
+END $$;
+DO $$
+BEGIN
+    INSERT INTO buffered_insert VALUES ('2020-02-01', 1, 1), ('2020-02-01', 2, 10000);
+EXCEPTION WHEN check_violation THEN
+    RAISE NOTICE 'check violation';
+END $$;
+SELECT count(*) FROM buffered_insert WHERE time >= '2020-02-01';
+
+-- rows are inserted one at a time for chunks with row triggers
+CREATE FUNCTION buffered_insert_count() RETURNS trigger LANGUAGE plpgsql AS $$
+BEGIN
+    RAISE NOTICE 'rows: %', (SELECT count(*) FROM buffered_insert WHERE time >= '2020-03-01');
+    RETURN NEW;
+END $$;
+CREATE TRIGGER buffered_insert_count BEFORE INSERT ON buffered_insert
+FOR EACH ROW EXECUTE FUNCTION buffered_insert_count();
+INSERT INTO buffered_insert VALUES ('2020-03-01', 1, 1), ('2020-03-01', 2, 2), ('2020-03-01', 3, 3);
+DROP TRIGGER buffered_insert_count ON buffered_insert;
+
+SET timescaledb.enable_buffered_insert = off;
+INSERT INTO buffered_insert VALUES ('2020-03-02', 1, 1), ('2020-03-02', 2, 2);
+RESET timescaledb.enable_buffered_insert;
+SELECT count(*) FROM buffered_insert WHERE time >= '2020-03-01';
+
+-- Rows inserted in time order are routed to the chunk of the previous row
+-- without looking up the chunk
+CREATE TABLE ordered_insert(time timestamptz NOT NULL, value int);
+SELECT table_name FROM create_hypertable('ordered_insert', 'time', chunk_time_interval => interval '1 day');
+EXPLAIN (analyze, costs off, timing off, summary off)
+INSERT INTO ordered_insert
+SELECT t, 1 FROM generate_series('2023-01-01 00:00+00'::timestamptz, '2023-01-03 23:00+00', interval '1 hour') t;
+-- rows going back and forth between chunks are still routed correctly
+INSERT INTO ordered_insert VALUES
+    ('2023-01-01 12:00+00', 2), ('2023-01-03 12:00+00', 2), ('2023-01-01 13:00+00', 2), ('2023-01-05 00:00+00', 2);
+SELECT count(*), sum(value), count(DISTINCT tableoid) FROM ordered_insert;
+SELECT count(*) FROM ordered_insert o
+JOIN timescaledb_information.chunks c ON format('%I.%I', c.chunk_schema, c.chunk_name)::regclass = o.tableoid
+WHERE o.time < c.range_start OR o.time >= c.range_end;
+
+-- Chunk insert states are evicted least recently used first when there
+-- are more open chunks than allowed, so the chunk inserted into most often
+-- stays open
+CREATE TABLE evicted_insert(time timestamptz NOT NULL, value int);
+SELECT table_name FROM create_hypertable('evicted_insert', 'time', chunk_time_interval => interval '1 day');
+SET timescaledb.max_open_chunks_per_insert = 2;
+EXPLAIN (analyze, costs off, timing off, summary off)
+INSERT INTO evicted_insert VALUES
+    ('2023-01-01 00:00+00', 1), ('2023-01-02 00:00+00', 1), ('2023-01-01 01:00+00', 1),
+    ('2023-01-03 00:00+00', 1), ('2023-01-01 02:00+00', 1);
+RESET timescaledb.max_open_chunks_per_insert;
+-- the most recently used chunk is kept open even when it alone exceeds the
+-- memory limit, so every switch to another chunk evicts one
+SET timescaledb.max_open_chunks_memory_per_insert = '1kB';
+EXPLAIN (analyze, costs off, timing off, summary off)
+INSERT INTO evicted_insert VALUES
+    ('2023-01-01 00:00+00', 2), ('2023-01-02 00:00+00', 2), ('2023-01-01 01:00+00', 2),
+    ('2023-01-03 00:00+00', 2), ('2023-01-01 02:00+00', 2);
+RESET timescaledb.max_open_chunks_memory_per_insert;
+SELECT value, count(*), count(DISTINCT tableoid) FROM evicted_insert GROUP BY value ORDER BY value;
+
+-- latencies of the insert path are collected per hypertable when enabled
+CREATE TABLE tracked_insert(time timestamptz NOT NULL, value int);
+SELECT table_name FROM create_hypertable('tracked_insert', 'time', chunk_time_interval => interval '1 day');
+SET timescaledb.track_insert_stats = on;
+INSERT INTO tracked_insert
+SELECT t, 1 FROM generate_series('2023-01-01 00:00+00'::timestamptz, '2023-01-03 23:00+00', interval '1 hour') t;
+RESET timescaledb.track_insert_stats;
+INSERT INTO tracked_insert VALUES ('2023-01-04 00:00+00', 1);
+SELECT stage, statements, calls, p50_time <= max_time AS p50_valid,
+    (SELECT sum(b) FROM unnest(histogram) b) = calls AS histogram_valid
+FROM timescaledb_information.hypertable_insert_stats
+WHERE hypertable_name = 'tracked_insert' AND stage IN ('chunk_lookup', 'chunk_create');
@@ -307,3 +307,32 @@ INSERT INTO part_time_func_null_ret VALUES (1530214157.134, 23.4, 'dev1'),
 CREATE FUNCTION _timescaledb_internal.update_dimension_partition(hypertable REGCLASS) RETURNS VOID AS :MODULE_PATHNAME, 'ts_dimension_partition_update' LANGUAGE C VOLATILE;
 SELECT _timescaledb_internal.update_dimension_partition('part_custom_dim');
 DROP FUNCTION _timescaledb_internal.update_dimension_partition;
+
+-- Rows are routed by the hash of the space partitioning columns, which is
+-- computed directly for common types instead of calling the default
+-- partitioning function. Check that each row is in a chunk covering the
+-- hash computed by the function.
+CREATE TABLE part_hash(time int NOT NULL, i2 int2, i4 int4, i8 int8, d date, t text, u uuid);
+SELECT table_name FROM create_hypertable('part_hash', 'time', chunk_time_interval => 1000);
+SELECT count(*) FROM (SELECT add_dimension('part_hash', col, 2) FROM unnest(ARRAY['i2', 'i4', 'i8', 'd', 't', 'u']::name[]) col) a;
+INSERT INTO part_hash
+SELECT 1, i, i * 1000, i * -100000000000, '2020-01-01'::date + i, 'device_' || i, md5(i::text)::uuid
+FROM generate_series(-50, 50) i;
+
+CREATE FUNCTION check_partition_hash(ht regclass, col name)
+RETURNS TABLE(total bigint, matching bigint) LANGUAGE PLPGSQL AS
+$BODY$
+BEGIN
+    RETURN QUERY EXECUTE format(
+        'SELECT count(*), count(*) FILTER (WHERE r.hash >= ds.range_start AND r.hash < ds.range_end)
+         FROM (SELECT tableoid, _timescaledb_internal.get_partition_hash(%I) AS hash FROM %s) r
+         JOIN _timescaledb_catalog.chunk c ON format(''%%I.%%I'', c.schema_name, c.table_name)::regclass = r.tableoid
+         JOIN _timescaledb_catalog.chunk_constraint cc ON cc.chunk_id = c.id
+         JOIN _timescaledb_catalog.dimension_slice ds ON ds.id = cc.dimension_slice_id
+         JOIN _timescaledb_catalog.dimension d ON d.id = ds.dimension_id AND d.column_name = %L',
+        col, ht, col);
+END
+$BODY$;
+
+SELECT col, total, matching
+FROM unnest(ARRAY['i2', 'i4', 'i8', 'd', 't', 'u']::name[]) col, check_partition_hash('part_hash', col);
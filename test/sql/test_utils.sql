@@ -78,3 +78,14 @@ CREATE TABLE hyper (time timestamptz, temp float);
 SELECT create_hypertable('hyper', 'time');
 INSERT INTO hyper VALUES ('2021-01-01', 1.0), ('2022-01-01', 2.0);
 SELECT test.scanner();
+
+-- Test the cache of catalog relations
+RESET ROLE;
+CREATE OR REPLACE FUNCTION test.catalog_relation_cache() RETURNS VOID
+    AS :MODULE_PATHNAME, 'ts_test_catalog_relation_cache' LANGUAGE C VOLATILE;
+SET ROLE :ROLE_DEFAULT_PERM_USER;
+SELECT test.catalog_relation_cache();
+BEGIN;
+SELECT count(*) FROM hyper;
+SELECT test.catalog_relation_cache();
+COMMIT;
@@ -4,10 +4,12 @@
  * LICENSE-APACHE for a copy of the license.
  */
 #include <postgres.h>
+#include <catalog/pg_class.h>
 
 #include "scanner.h"
 #include "scan_iterator.h"
 #include "chunk.h"
+#include "ts_catalog/catalog.h"
 #include "test_utils.h"
 
 TS_TEST_FN(ts_test_scanner)
@@ -104,3 +106,51 @@ TS_TEST_FN(ts_test_scanner)
 
 	PG_RETURN_VOID();
 }
+
+/*
+ * Test that all catalog tables and indexes are found in the cache of catalog
+ * relations and that other relations are not cached.
+ */
+TS_TEST_FN(ts_test_catalog_relation_cache)
+{
+	Catalog *catalog = ts_catalog_get();
+	int i;
+
+	for (i = 0; i < _MAX_CATALOG_TABLES; i++)
+	{
+		Oid relids[_MAX_TABLE_INDEXES + 1];
+		int num_relids = 0;
+		int j;
+
+		relids[num_relids++] = catalog->tables[i].id;
+
+		for (j = 0; j < _MAX_TABLE_INDEXES; j++)
+			if (OidIsValid(catalog->tables[i].index_ids[j]))
+				relids[num_relids++] = catalog->tables[i].index_ids[j];
+
+		for (j = 0; j < num_relids; j++)
+		{
+			Relation rel = ts_catalog_relation_open_cached(relids[j], AccessShareLock);
+			Relation rel2;
+
+			if (rel == NULL)
+				TestFailure("catalog relation %u of table \"%s\" is not cached",
+							relids[j],
+							catalog->tables[i].name);
+
+			TestAssertInt64Eq(RelationGetRelid(rel), relids[j]);
+
+			/* The same relation is returned while it is cached */
+			rel2 = ts_catalog_relation_open_cached(relids[j], AccessShareLock);
+			TestAssertPtrEq(rel2, rel);
+
+			ts_catalog_relation_close_cached(rel2, AccessShareLock);
+			ts_catalog_relation_close_cached(rel, AccessShareLock);
+		}
+	}
+
+	TestAssertPtrEq(ts_catalog_relation_open_cached(RelationRelationId, AccessShareLock), NULL);
+	TestAssertPtrEq(ts_catalog_relation_open_cached(InvalidOid, AccessShareLock), NULL);
+
+	PG_RETURN_VOID();
+}
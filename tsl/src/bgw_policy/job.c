@@ -8,6 +8,7 @@
 #include <access/xact.h>
 #include <catalog/namespace.h>
 #include <catalog/pg_type.h>
+#include <commands/tablecmds.h>
 #include <funcapi.h>
 #include <hypertable_cache.h>
 #include <nodes/makefuncs.h>
@@ -19,6 +20,7 @@
 #include <utils/builtins.h>
 #include <utils/lsyscache.h>
 #include <utils/portal.h>
+#include <utils/relcache.h>
 #include <utils/syscache.h>
 #include <utils/snapmgr.h>
 #include <utils/timestamp.h>
@@ -27,14 +29,17 @@
 #include "bgw/timer.h"
 #include "bgw/job.h"
 #include "bgw/job_stat.h"
+#include "bgw_policy/chunk_precreation_api.h"
 #include "bgw_policy/chunk_stats.h"
 #include "bgw_policy/compression_api.h"
 #include "bgw_policy/continuous_aggregate_api.h"
 #include "bgw_policy/policy_utils.h"
 #include "bgw_policy/reorder_api.h"
 #include "bgw_policy/retention_api.h"
+#include "bgw_policy/staging_api.h"
 #include "compat/compat.h"
 #include "compression/api.h"
+#include "continuous_aggs/invalidation.h"
 #include "continuous_aggs/materialize.h"
 #include "continuous_aggs/refresh.h"
 #include "ts_catalog/continuous_agg.h"
@@ -52,6 +57,8 @@
 #include "dimension_slice.h"
 #include "dimension_vector.h"
 #include "errors.h"
+#include "hypercube.h"
+#include "indexing.h"
 #include "job.h"
 #include "reorder.h"
 #include "utils.h"
@@ -330,18 +337,305 @@ policy_retention_read_and_validate_config(Jsonb *config, PolicyRetentionData *po
 	}
 }
 
+/*
+ * Get the current time of the hypertable in its internal time format, using
+ * the integer_now function for integer time dimensions.
+ */
+static int64
+get_current_time_internal(const Dimension *open_dim)
+{
+	Oid partitioning_type = ts_dimension_get_partition_type(open_dim);
+
+	if (IS_INTEGER_TYPE(partitioning_type))
+	{
+		Oid now_func = ts_get_integer_now_func(open_dim);
+
+		if (!OidIsValid(now_func))
+			ereport(ERROR,
+					(errcode(ERRCODE_TS_UNEXPECTED),
+					 errmsg("missing integer_now function for hypertable \"%s\"",
+							get_rel_name(open_dim->main_table_relid))));
+
+		return ts_sub_integer_from_now(0, partitioning_type, now_func);
+	}
+	else
+	{
+		Interval zero = { 0 };
+		Datum now = subtract_interval_from_now(&zero, partitioning_type);
+
+		return ts_time_value_to_internal(now, partitioning_type);
+	}
+}
+
+bool
+policy_chunk_precreation_execute(int32 job_id, Jsonb *config)
+{
+	PolicyChunkPrecreationData policy_data;
+	const Dimension *open_dim;
+	int64 time;
+	int num_created = 0;
+	int i;
+
+	policy_chunk_precreation_read_and_validate_config(config, &policy_data);
+	open_dim = hyperspace_get_open_dimension(policy_data.hypertable->space, 0);
+	time = get_current_time_internal(open_dim);
+
+	/*
+	 * Create the chunks for the current time range and the given number of
+	 * subsequent ones. The next time range starts where the previous one
+	 * ended, which respects chunk intervals changed by adaptive chunking.
+	 */
+	for (i = 0; i <= policy_data.chunks_ahead; i++)
+	{
+		int64 range_end;
+
+		num_created +=
+			ts_hypertable_create_chunks_for_time(policy_data.hypertable, time, &range_end);
+
+		if (range_end == DIMENSION_SLICE_MAXVALUE)
+			break;
+
+		time = range_end;
+	}
+
+	elog(policy_get_verbose_log(config) ? LOG : DEBUG1,
+		 "created %d chunks ahead of time for hypertable \"%s\"",
+		 num_created,
+		 get_rel_name(policy_data.hypertable->main_table_relid));
+
+	ts_cache_release(policy_data.hcache);
+
+	return true;
+}
+
+void
+policy_chunk_precreation_read_and_validate_config(Jsonb *config,
+												  PolicyChunkPrecreationData *policy_data)
+{
+	int32 htid = policy_chunk_precreation_get_hypertable_id(config);
+	int32 chunks_ahead = policy_chunk_precreation_get_chunks_ahead(config);
+	Oid table_relid = ts_hypertable_id_to_relid(htid, true);
+	Cache *hcache;
+	Hypertable *hypertable;
+
+	if (!OidIsValid(table_relid))
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("configuration hypertable id %d not found", htid)));
+
+	if (chunks_ahead < 1)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("invalid value for parameter chunks_ahead"),
+				 errhint("The number of chunks to create ahead of time must be at least 1.")));
+
+	hypertable = ts_hypertable_cache_get_cache_and_entry(table_relid, CACHE_FLAG_NONE, &hcache);
+
+	if (policy_data == NULL)
+		ts_cache_release(hcache);
+	else
+	{
+		policy_data->hypertable = hypertable;
+		policy_data->hcache = hcache;
+		policy_data->chunks_ahead = chunks_ahead;
+	}
+}
+
+/*
+ * Get the index to sort staged chunks on when merging them. This is the
+ * clustered index of the hypertable, or else an index leading with the time
+ * column, like the default time index.
+ */
+static Oid
+get_staging_merge_index(const Hypertable *ht, const Dimension *dim)
+{
+	Oid index_relid = ts_indexing_find_clustered_index(ht->main_table_relid);
+	Relation rel;
+	List *index_oids;
+	ListCell *lc;
+
+	if (OidIsValid(index_relid))
+		return index_relid;
+
+	rel = table_open(ht->main_table_relid, AccessShareLock);
+	index_oids = RelationGetIndexList(rel);
+	table_close(rel, AccessShareLock);
+
+	foreach (lc, index_oids)
+	{
+		HeapTuple idxtuple = SearchSysCache1(INDEXRELID, ObjectIdGetDatum(lfirst_oid(lc)));
+		Form_pg_index index_form;
+
+		if (!HeapTupleIsValid(idxtuple))
+			continue;
+
+		index_form = (Form_pg_index) GETSTRUCT(idxtuple);
+
+		if (index_form->indnkeyatts > 0 && index_form->indkey.values[0] == dim->column_attno)
+			index_relid = index_form->indexrelid;
+
+		ReleaseSysCache(idxtuple);
+
+		if (OidIsValid(index_relid))
+			break;
+	}
+
+	return index_relid;
+}
+
+/*
+ * Merge a staged chunk into a regular chunk.
+ *
+ * The chunk is rewritten sorted on the merge index into a logged table, and
+ * its indexes are built in bulk on the sorted data. The swap of the relation
+ * files makes the heap, its indexes and its TOAST table logged.
+ */
+void
+policy_staging_merge_chunk(const Hypertable *ht, const Chunk *chunk)
+{
+	const Dimension *dim = hyperspace_get_open_dimension(ht->space, 0);
+	Oid index_relid;
+
+	/*
+	 * Compressed chunks cannot be reordered, so they are only set logged,
+	 * which also rewrites the rows not compressed yet
+	 */
+	index_relid = ts_chunk_is_compressed(chunk) ? InvalidOid : get_staging_merge_index(ht, dim);
+
+	if (OidIsValid(index_relid))
+		reorder_chunk_set_logged(chunk->table_id, index_relid);
+	else
+	{
+		AlterTableCmd cmd = {
+			.type = T_AlterTableCmd,
+			.subtype = AT_SetLogged,
+		};
+
+		AlterTableInternal(chunk->table_id, list_make1(&cmd), false);
+	}
+}
+
+/*
+ * Merge the oldest staged chunk of the hypertable that is older than
+ * merge_after into a regular chunk.
+ *
+ * Only one chunk is merged per run, since the chunk is locked against
+ * inserts until the end of the transaction.
+ */
+bool
+policy_staging_execute(int32 job_id, Jsonb *config)
+{
+	PolicyStagingData policy_data;
+	const Dimension *dim;
+	Oid partitioning_type;
+	Datum boundary;
+	int64 boundary_internal;
+	List *chunk_ids;
+	ListCell *lc;
+	Chunk *chunk = NULL;
+	int num_staged = 0;
+
+	policy_staging_read_and_validate_config(config, &policy_data);
+	dim = hyperspace_get_open_dimension(policy_data.hypertable->space, 0);
+	partitioning_type = ts_dimension_get_partition_type(dim);
+	boundary = get_window_boundary(dim,
+								   config,
+								   policy_staging_get_merge_after_int,
+								   policy_staging_get_merge_after_interval);
+
+	boundary_internal = ts_time_value_to_internal(boundary, partitioning_type);
+	chunk_ids = ts_chunk_get_chunk_ids_by_hypertable_id(policy_data.hypertable->fd.id);
+
+	foreach (lc, chunk_ids)
+	{
+		Chunk *staged = ts_chunk_get_by_id(lfirst_int(lc), false);
+		const DimensionSlice *slice;
+
+		if (staged == NULL || staged->fd.dropped ||
+			get_rel_persistence(staged->table_id) != RELPERSISTENCE_UNLOGGED)
+			continue;
+
+		slice = ts_hypercube_get_slice_by_dimension_id(staged->cube, dim->fd.id);
+
+		if (slice == NULL || slice->fd.range_end > boundary_internal)
+			continue;
+
+		/* Merge the oldest staged chunk first */
+		if (chunk == NULL ||
+			slice->fd.range_start <
+				ts_hypercube_get_slice_by_dimension_id(chunk->cube, dim->fd.id)->fd.range_start)
+			chunk = staged;
+		num_staged++;
+	}
+
+	if (chunk == NULL)
+	{
+		elog(policy_get_verbose_log(config) ? LOG : DEBUG1,
+			 "no staged chunks to merge for hypertable \"%s\"",
+			 get_rel_name(policy_data.hypertable->main_table_relid));
+		ts_cache_release(policy_data.hcache);
+		return true;
+	}
+
+	elog(DEBUG1, "merging chunk %s.%s", chunk->fd.schema_name.data, chunk->fd.table_name.data);
+	policy_staging_merge_chunk(policy_data.hypertable, chunk);
+
+	elog(policy_get_verbose_log(config) ? LOG : DEBUG1,
+		 "merged staged chunk %s.%s",
+		 chunk->fd.schema_name.data,
+		 chunk->fd.table_name.data);
+
+	ts_cache_release(policy_data.hcache);
+
+	if (num_staged > 1)
+		enable_fast_restart(job_id, "staging");
+
+	return true;
+}
+
+void
+policy_staging_read_and_validate_config(Jsonb *config, PolicyStagingData *policy_data)
+{
+	int32 htid = policy_staging_get_hypertable_id(config);
+	Oid table_relid = ts_hypertable_id_to_relid(htid, true);
+	Cache *hcache;
+	Hypertable *hypertable;
+
+	if (!OidIsValid(table_relid))
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("configuration hypertable id %d not found", htid)));
+
+	hypertable = ts_hypertable_cache_get_cache_and_entry(table_relid, CACHE_FLAG_NONE, &hcache);
+
+	if (policy_data == NULL)
+		ts_cache_release(hcache);
+	else
+	{
+		policy_data->hypertable = hypertable;
+		policy_data->hcache = hcache;
+	}
+}
+
 bool
 policy_refresh_cagg_execute(int32 job_id, Jsonb *config)
 {
 	PolicyContinuousAggData policy_data;
+	int32 raw_hypertable_id;
 
 	policy_refresh_cagg_read_and_validate_config(config, &policy_data);
+	raw_hypertable_id = policy_data.cagg->data.raw_hypertable_id;
 	continuous_agg_refresh_internal(policy_data.cagg,
 									&policy_data.refresh_window,
 									CAGG_REFRESH_POLICY,
 									policy_data.start_is_null,
 									policy_data.end_is_null);
 
+	/* The refresh copied the hypertable invalidations to the logs of all
+	 * continuous aggregates on the hypertable, so merge the entries of these
+	 * logs while we are at it */
+	invalidation_compact_cagg_logs(raw_hypertable_id);
+
 	return true;
 }
 
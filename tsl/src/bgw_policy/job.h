@@ -38,6 +38,19 @@ typedef struct PolicyContinuousAggData
 	bool start_is_null, end_is_null;
 } PolicyContinuousAggData;
 
+typedef struct PolicyChunkPrecreationData
+{
+	Hypertable *hypertable;
+	Cache *hcache;
+	int32 chunks_ahead;
+} PolicyChunkPrecreationData;
+
+typedef struct PolicyStagingData
+{
+	Hypertable *hypertable;
+	Cache *hcache;
+} PolicyStagingData;
+
 typedef struct PolicyCompressionData
 {
 	Hypertable *hypertable;
@@ -53,6 +66,9 @@ extern bool policy_reorder_execute(int32 job_id, Jsonb *config);
 extern bool policy_retention_execute(int32 job_id, Jsonb *config);
 extern bool policy_refresh_cagg_execute(int32 job_id, Jsonb *config);
 extern bool policy_recompression_execute(int32 job_id, Jsonb *config);
+extern bool policy_chunk_precreation_execute(int32 job_id, Jsonb *config);
+extern bool policy_staging_execute(int32 job_id, Jsonb *config);
+extern void policy_staging_merge_chunk(const Hypertable *ht, const Chunk *chunk);
 extern void policy_reorder_read_and_validate_config(Jsonb *config, PolicyReorderData *policy_data);
 extern void policy_retention_read_and_validate_config(Jsonb *config,
 													  PolicyRetentionData *policy_data);
@@ -62,6 +78,9 @@ extern void policy_compression_read_and_validate_config(Jsonb *config,
 														PolicyCompressionData *policy_data);
 extern void policy_recompression_read_and_validate_config(Jsonb *config,
 														  PolicyCompressionData *policy_data);
+extern void policy_chunk_precreation_read_and_validate_config(Jsonb *config,
+															  PolicyChunkPrecreationData *policy_data);
+extern void policy_staging_read_and_validate_config(Jsonb *config, PolicyStagingData *policy_data);
 extern bool job_execute(BgwJob *job);
 
 #endif /* TIMESCALEDB_TSL_BGW_POLICY_JOB_H */
@@ -0,0 +1,408 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+#include <postgres.h>
+#include <catalog/pg_type.h>
+#include <miscadmin.h>
+#include <storage/lmgr.h>
+#include <utils/builtins.h>
+#include <utils/lsyscache.h>
+#include <utils/timestamp.h>
+
+#include <chunk.h>
+#include <dimension.h>
+#include <hypertable_cache.h>
+#include <jsonb_utils.h>
+
+#include "bgw/job.h"
+#include "bgw/job_stat.h"
+#include "bgw/timer.h"
+#include "bgw_policy/job.h"
+#include "bgw_policy/policy.h"
+#include "bgw_policy/policy_utils.h"
+#include "bgw_policy/staging_api.h"
+#include "errors.h"
+#include "hypertable.h"
+#include "utils.h"
+
+/*
+ * Default scheduled interval for staging jobs is 1/2 of the chunk interval of
+ * the hypertable, so that staged chunks are merged soon after they get old
+ * enough. If the hypertable does not have a time-based chunk interval, the
+ * default is one day.
+ */
+#define DEFAULT_SCHEDULE_INTERVAL                                                                  \
+	{                                                                                              \
+		.day = 1                                                                                   \
+	}
+
+/* Default max runtime for a staging job is unlimited, like for reorder jobs */
+#define DEFAULT_MAX_RUNTIME                                                                        \
+	DatumGetIntervalP(DirectFunctionCall3(interval_in, CStringGetDatum("0"), InvalidOid, -1))
+/* Right now, there is an infinite number of retries for staging jobs */
+#define DEFAULT_MAX_RETRIES (-1)
+/* Default retry period for staging jobs is currently 5 minutes */
+#define DEFAULT_RETRY_PERIOD                                                                       \
+	DatumGetIntervalP(DirectFunctionCall3(interval_in, CStringGetDatum("5 min"), InvalidOid, -1))
+
+#define CONFIG_KEY_HYPERTABLE_ID "hypertable_id"
+#define CONFIG_KEY_MERGE_AFTER "merge_after"
+
+#define POLICY_STAGING_CHECK_NAME "policy_staging_check"
+
+int32
+policy_staging_get_hypertable_id(const Jsonb *config)
+{
+	bool found;
+	int32 hypertable_id = ts_jsonb_get_int32_field(config, CONFIG_KEY_HYPERTABLE_ID, &found);
+
+	if (!found)
+		ereport(ERROR,
+				(errcode(ERRCODE_INTERNAL_ERROR),
+				 errmsg("could not find hypertable_id in config for job")));
+
+	return hypertable_id;
+}
+
+int64
+policy_staging_get_merge_after_int(const Jsonb *config)
+{
+	bool found;
+	int64 merge_after = ts_jsonb_get_int64_field(config, CONFIG_KEY_MERGE_AFTER, &found);
+
+	if (!found)
+		ereport(ERROR,
+				(errcode(ERRCODE_INTERNAL_ERROR),
+				 errmsg("could not find %s in config for job", CONFIG_KEY_MERGE_AFTER)));
+
+	return merge_after;
+}
+
+Interval *
+policy_staging_get_merge_after_interval(const Jsonb *config)
+{
+	Interval *interval = ts_jsonb_get_interval_field(config, CONFIG_KEY_MERGE_AFTER);
+
+	if (interval == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_INTERNAL_ERROR),
+				 errmsg("could not find %s in config for job", CONFIG_KEY_MERGE_AFTER)));
+
+	return interval;
+}
+
+static void
+validate_merge_after_type(Oid partitioning_type, Oid merge_after_type)
+{
+	Oid expected_type = InvalidOid;
+
+	if (IS_INTEGER_TYPE(partitioning_type))
+	{
+		if (!IS_INTEGER_TYPE(merge_after_type))
+			expected_type = partitioning_type;
+	}
+	else if (merge_after_type != INTERVALOID)
+		expected_type = INTERVALOID;
+
+	if (OidIsValid(expected_type))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("unsupported merge_after argument type, expected type : %s",
+						format_type_be(expected_type))));
+}
+
+Datum
+policy_staging_check(PG_FUNCTION_ARGS)
+{
+	TS_PREVENT_FUNC_IF_READ_ONLY();
+
+	if (PG_ARGISNULL(0))
+	{
+		ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR), errmsg("config must not be NULL")));
+	}
+
+	policy_staging_read_and_validate_config(PG_GETARG_JSONB_P(0), NULL);
+
+	PG_RETURN_VOID();
+}
+
+Datum
+policy_staging_proc(PG_FUNCTION_ARGS)
+{
+	if (PG_NARGS() != 2 || PG_ARGISNULL(0) || PG_ARGISNULL(1))
+		PG_RETURN_VOID();
+
+	TS_PREVENT_FUNC_IF_READ_ONLY();
+
+	policy_staging_execute(PG_GETARG_INT32(0), PG_GETARG_JSONB_P(1));
+
+	PG_RETURN_VOID();
+}
+
+Datum
+policy_staging_add(PG_FUNCTION_ARGS)
+{
+	/* behave like a strict function */
+	if (PG_ARGISNULL(0) || PG_ARGISNULL(1) || PG_ARGISNULL(2))
+		PG_RETURN_NULL();
+
+	NameData application_name;
+	NameData proc_name, proc_schema, check_name, check_schema, owner;
+	int32 job_id;
+	const Dimension *dim;
+	Interval schedule_interval = DEFAULT_SCHEDULE_INTERVAL;
+	Oid ht_oid = PG_GETARG_OID(0);
+	Datum merge_after_datum = PG_GETARG_DATUM(1);
+	Oid merge_after_type = get_fn_expr_argtype(fcinfo->flinfo, 1);
+	bool if_not_exists = PG_GETARG_BOOL(2);
+	bool user_defined_schedule_interval = !PG_ARGISNULL(3);
+	Cache *hcache;
+	Hypertable *ht;
+	int32 hypertable_id;
+	Oid partitioning_type;
+	Oid owner_id;
+	List *jobs;
+	TimestampTz initial_start = PG_ARGISNULL(4) ? DT_NOBEGIN : PG_GETARG_TIMESTAMPTZ(4);
+	bool fixed_schedule = !PG_ARGISNULL(4);
+	text *timezone = PG_ARGISNULL(5) ? NULL : PG_GETARG_TEXT_PP(5);
+	char *valid_timezone = NULL;
+
+	TS_PREVENT_FUNC_IF_READ_ONLY();
+
+	if (timezone != NULL)
+		valid_timezone = ts_bgw_job_validate_timezone(PG_GETARG_DATUM(5));
+
+	ht = ts_hypertable_cache_get_cache_and_entry(ht_oid, CACHE_FLAG_NONE, &hcache);
+	Assert(ht != NULL);
+	hypertable_id = ht->fd.id;
+
+	/* First verify that the hypertable corresponds to a valid table */
+	owner_id = ts_hypertable_permissions_check(ht_oid, GetUserId());
+
+	if (TS_HYPERTABLE_IS_INTERNAL_COMPRESSION_TABLE(ht))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("cannot add staging policy to compressed hypertable \"%s\"",
+						get_rel_name(ht_oid)),
+				 errhint("Please add the policy to the corresponding uncompressed hypertable "
+						 "instead.")));
+
+	if (hypertable_is_distributed(ht))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("staging policies not supported on a distributed hypertables")));
+
+	dim = hyperspace_get_open_dimension(ht->space, 0);
+	Assert(dim);
+	partitioning_type = ts_dimension_get_partition_type(dim);
+	validate_merge_after_type(partitioning_type, merge_after_type);
+
+	if (IS_INTEGER_TYPE(partitioning_type) && !OidIsValid(ts_get_integer_now_func(dim)))
+		ereport(ERROR,
+				(errcode(ERRCODE_TS_UNEXPECTED),
+				 errmsg("missing integer_now function for hypertable \"%s\"",
+						get_rel_name(ht_oid)),
+				 errhint("Use set_integer_now_func() to set the integer_now function.")));
+
+	/* Verify that the hypertable owner can create a background worker */
+	ts_bgw_job_validate_job_owner(owner_id);
+
+	/* Make sure that an existing staging policy doesn't exist on this hypertable */
+	jobs = ts_bgw_job_find_by_proc_and_hypertable_id(POLICY_STAGING_PROC_NAME,
+													 INTERNAL_SCHEMA_NAME,
+													 ht->fd.id);
+
+	if (user_defined_schedule_interval)
+		schedule_interval = *PG_GETARG_INTERVAL_P(3);
+	else if (IS_TIMESTAMP_TYPE(partitioning_type))
+	{
+		schedule_interval.time = dim->fd.interval_length / 2;
+		schedule_interval.day = 0;
+		schedule_interval.month = 0;
+	}
+
+	ts_cache_release(hcache);
+
+	if (jobs != NIL)
+	{
+		BgwJob *existing = linitial(jobs);
+		Assert(list_length(jobs) == 1);
+
+		if (!if_not_exists)
+			ereport(ERROR,
+					(errcode(ERRCODE_DUPLICATE_OBJECT),
+					 errmsg("staging policy already exists for hypertable \"%s\"",
+							get_rel_name(ht_oid))));
+
+		if (!policy_config_check_hypertable_lag_equality(existing->fd.config,
+														 CONFIG_KEY_MERGE_AFTER,
+														 partitioning_type,
+														 merge_after_type,
+														 merge_after_datum))
+		{
+			ereport(WARNING,
+					(errmsg("staging policy already exists for hypertable \"%s\"",
+							get_rel_name(ht_oid)),
+					 errdetail("A policy already exists with different arguments."),
+					 errhint("Remove the existing policy before adding a new one.")));
+			PG_RETURN_INT32(-1);
+		}
+		/* If all arguments are the same, do nothing */
+		ereport(NOTICE,
+				(errmsg("staging policy already exists on hypertable \"%s\", skipping",
+						get_rel_name(ht_oid))));
+		PG_RETURN_INT32(-1);
+	}
+
+	/* if users pass in -infinity for initial_start, then use the current_timestamp instead */
+	if (fixed_schedule)
+	{
+		ts_bgw_job_validate_schedule_interval(&schedule_interval);
+		if (TIMESTAMP_NOT_FINITE(initial_start))
+			initial_start = ts_timer_get_current_timestamp();
+	}
+
+	/* Next, insert a new job into jobs table */
+	namestrcpy(&application_name, "Staging Policy");
+	namestrcpy(&proc_name, POLICY_STAGING_PROC_NAME);
+	namestrcpy(&proc_schema, INTERNAL_SCHEMA_NAME);
+	namestrcpy(&check_name, POLICY_STAGING_CHECK_NAME);
+	namestrcpy(&check_schema, INTERNAL_SCHEMA_NAME);
+	namestrcpy(&owner, GetUserNameFromId(owner_id, false));
+
+	JsonbParseState *parse_state = NULL;
+
+	pushJsonbValue(&parse_state, WJB_BEGIN_OBJECT, NULL);
+	ts_jsonb_add_int32(parse_state, CONFIG_KEY_HYPERTABLE_ID, hypertable_id);
+	switch (merge_after_type)
+	{
+		case INTERVALOID:
+			ts_jsonb_add_interval(parse_state,
+								  CONFIG_KEY_MERGE_AFTER,
+								  DatumGetIntervalP(merge_after_datum));
+			break;
+		case INT2OID:
+			ts_jsonb_add_int64(parse_state,
+							   CONFIG_KEY_MERGE_AFTER,
+							   DatumGetInt16(merge_after_datum));
+			break;
+		case INT4OID:
+			ts_jsonb_add_int64(parse_state,
+							   CONFIG_KEY_MERGE_AFTER,
+							   DatumGetInt32(merge_after_datum));
+			break;
+		case INT8OID:
+			ts_jsonb_add_int64(parse_state,
+							   CONFIG_KEY_MERGE_AFTER,
+							   DatumGetInt64(merge_after_datum));
+			break;
+		default:
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("unsupported datatype for %s: %s",
+							CONFIG_KEY_MERGE_AFTER,
+							format_type_be(merge_after_type))));
+	}
+	JsonbValue *result = pushJsonbValue(&parse_state, WJB_END_OBJECT, NULL);
+	Jsonb *config = JsonbValueToJsonb(result);
+
+	job_id = ts_bgw_job_insert_relation(&application_name,
+										&schedule_interval,
+										DEFAULT_MAX_RUNTIME,
+										DEFAULT_MAX_RETRIES,
+										DEFAULT_RETRY_PERIOD,
+										&proc_schema,
+										&proc_name,
+										&check_schema,
+										&check_name,
+										owner_id,
+										true,
+										fixed_schedule,
+										hypertable_id,
+										config,
+										initial_start,
+										valid_timezone);
+
+	if (!TIMESTAMP_NOT_FINITE(initial_start))
+		ts_bgw_job_stat_upsert_next_start(job_id, initial_start);
+
+	ereport(NOTICE,
+			(errmsg("new chunks of hypertable \"%s\" are created unlogged until they are merged",
+					get_rel_name(ht_oid)),
+			 errdetail("Unlogged chunks are truncated after a crash and cannot be read on "
+					   "physical standbys.")));
+
+	PG_RETURN_INT32(job_id);
+}
+
+/*
+ * Remove the staging policy of a hypertable.
+ *
+ * New chunks are created as regular chunks again, and the chunks that are
+ * still staged are merged right away, since no job merges them later.
+ */
+Datum
+policy_staging_remove(PG_FUNCTION_ARGS)
+{
+	Oid hypertable_oid = PG_GETARG_OID(0);
+	bool if_exists = PG_GETARG_BOOL(1);
+	Hypertable *ht;
+	Cache *hcache;
+	List *chunk_ids;
+	ListCell *lc;
+
+	TS_PREVENT_FUNC_IF_READ_ONLY();
+
+	ht = ts_hypertable_cache_get_cache_and_entry(hypertable_oid, CACHE_FLAG_NONE, &hcache);
+
+	List *jobs = ts_bgw_job_find_by_proc_and_hypertable_id(POLICY_STAGING_PROC_NAME,
+														   INTERNAL_SCHEMA_NAME,
+														   ht->fd.id);
+
+	if (jobs == NIL)
+	{
+		ts_cache_release(hcache);
+
+		if (!if_exists)
+			ereport(ERROR,
+					(errcode(ERRCODE_UNDEFINED_OBJECT),
+					 errmsg("staging policy not found for hypertable \"%s\"",
+							get_rel_name(hypertable_oid))));
+		else
+		{
+			ereport(NOTICE,
+					(errmsg("staging policy not found for hypertable \"%s\", skipping",
+							get_rel_name(hypertable_oid))));
+			PG_RETURN_NULL();
+		}
+	}
+	Assert(list_length(jobs) == 1);
+	BgwJob *job = linitial(jobs);
+
+	ts_hypertable_permissions_check(hypertable_oid, GetUserId());
+
+	/* Block inserts, so that no staged chunk is created until we commit */
+	LockRelationOid(hypertable_oid, ShareRowExclusiveLock);
+
+	ts_bgw_job_delete_by_id(job->fd.id);
+
+	chunk_ids = ts_chunk_get_chunk_ids_by_hypertable_id(ht->fd.id);
+
+	foreach (lc, chunk_ids)
+	{
+		Chunk *chunk = ts_chunk_get_by_id(lfirst_int(lc), false);
+
+		if (chunk == NULL || chunk->fd.dropped ||
+			get_rel_persistence(chunk->table_id) != RELPERSISTENCE_UNLOGGED)
+			continue;
+
+		policy_staging_merge_chunk(ht, chunk);
+	}
+
+	ts_cache_release(hcache);
+
+	PG_RETURN_NULL();
+}
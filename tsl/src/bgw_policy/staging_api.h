@@ -0,0 +1,23 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+#ifndef TIMESCALEDB_TSL_BGW_POLICY_STAGING_API_H
+#define TIMESCALEDB_TSL_BGW_POLICY_STAGING_API_H
+
+#include <postgres.h>
+#include <utils/jsonb.h>
+
+/* User-facing API functions */
+extern Datum policy_staging_add(PG_FUNCTION_ARGS);
+extern Datum policy_staging_remove(PG_FUNCTION_ARGS);
+extern Datum policy_staging_proc(PG_FUNCTION_ARGS);
+extern Datum policy_staging_check(PG_FUNCTION_ARGS);
+
+extern int32 policy_staging_get_hypertable_id(const Jsonb *config);
+extern int64 policy_staging_get_merge_after_int(const Jsonb *config);
+extern Interval *policy_staging_get_merge_after_interval(const Jsonb *config);
+
+#endif /* TIMESCALEDB_TSL_BGW_POLICY_STAGING_API_H */
@@ -299,6 +299,33 @@ execute_cagg_trigger(int32 hypertable_id, Relation chunk_rel, HeapTuple chunk_tu
 	update_cache_entry(cache_entry, timeval);
 }
 
+/*
+ * Add a range of inserted time values to the invalidations of the current
+ * transaction.
+ *
+ * Used by the insert path, which tracks the range of the rows it inserts into
+ * a chunk instead of firing the invalidation trigger for every row.
+ */
+void
+continuous_agg_invalidate_inserted_range(int32 hypertable_id, int32 entry_id, int64 lowest,
+										 int64 greatest)
+{
+	ContinuousAggsCacheInvalEntry *cache_entry;
+	bool found;
+
+	if (!continuous_aggs_cache_inval_htab)
+		cache_inval_init();
+
+	cache_entry = (ContinuousAggsCacheInvalEntry *)
+		hash_search(continuous_aggs_cache_inval_htab, &hypertable_id, HASH_ENTER, &found);
+
+	if (!found)
+		cache_inval_entry_init(cache_entry, hypertable_id, entry_id);
+
+	update_cache_entry(cache_entry, lowest);
+	update_cache_entry(cache_entry, greatest);
+}
+
 static void
 cache_inval_entry_write(ContinuousAggsCacheInvalEntry *entry)
 {
@@ -16,5 +16,7 @@ extern void execute_cagg_trigger(int32 hypertable_id, Relation chunk_rel, HeapTu
 								 HeapTuple chunk_newtuple, bool update,
 								 bool is_distributed_hypertable_trigger,
 								 int32 parent_hypertable_id);
+extern void continuous_agg_invalidate_inserted_range(int32 hypertable_id, int32 entry_id,
+													 int64 lowest, int64 greatest);
 
 #endif /* TIMESCALEDB_TSL_CONTINUOUS_AGGS_INSERT_H */
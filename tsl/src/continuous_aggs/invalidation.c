@@ -11,6 +11,7 @@
 #include <utils/tuplestore.h>
 #include <nodes/makefuncs.h>
 #include <nodes/memnodes.h>
+#include <storage/lmgr.h>
 #include <storage/lockdefs.h>
 #include <access/htup_details.h>
 #include <access/htup.h>
@@ -125,10 +126,6 @@ static void
 invalidation_expand_to_bucket_boundaries(Invalidation *inv, Oid time_type_oid, int64 bucket_width,
 										 const ContinuousAggsBucketFunction *bucket_function);
 static void
-invalidation_entry_set_from_hyper_invalidation(Invalidation *entry, const TupleInfo *ti,
-											   int32 hyper_id, Oid dimtype, int64 bucket_width,
-											   const ContinuousAggsBucketFunction *bucket_function);
-static void
 invalidation_entry_set_from_cagg_invalidation(Invalidation *entry, const TupleInfo *ti, Oid dimtype,
 											  int64 bucket_width,
 											  const ContinuousAggsBucketFunction *bucket_function);
@@ -686,22 +683,6 @@ invalidation_expand_to_bucket_boundaries(Invalidation *inv, Oid time_type_oid, i
 			heap_freetuple(tuple);                                                                 \
 	} while (0);
 
-static void
-invalidation_entry_set_from_hyper_invalidation(Invalidation *entry, const TupleInfo *ti,
-											   int32 hyper_id, Oid dimtype, int64 bucket_width,
-											   const ContinuousAggsBucketFunction *bucket_function)
-{
-	INVALIDATION_ENTRY_SET(entry,
-						   ti,
-						   hypertable_id,
-						   Form_continuous_aggs_hypertable_invalidation_log);
-	/* Since hypertable invalidations are moved to the continuous aggregate
-	 * invalidation log, a different hypertable ID must be set (the ID of the
-	 * materialized hypertable). */
-	entry->hyper_id = hyper_id;
-	invalidation_expand_to_bucket_boundaries(entry, dimtype, bucket_width, bucket_function);
-}
-
 static void
 invalidation_entry_set_from_cagg_invalidation(Invalidation *entry, const TupleInfo *ti, Oid dimtype,
 											  int64 bucket_width,
@@ -799,6 +780,102 @@ cut_and_insert_new_cagg_invalidation(const CaggInvalidationState *state, const I
 	ts_catalog_restore_user(&sec_ctx);
 }
 
+/*
+ * A set of invalidations kept in memory.
+ *
+ * Invalidations are added in any order and the set is then compacted into a
+ * sorted set of non-overlapping, non-adjacent invalidations. This is used to
+ * merge invalidations in O(n log n) without scanning the logs repeatedly.
+ */
+typedef struct InvalidationSet
+{
+	Invalidation *entries;
+	int num_entries;
+	int max_entries;
+} InvalidationSet;
+
+#define INVALIDATION_SET_INITIAL_SIZE 64
+
+static void
+invalidation_set_init(InvalidationSet *set)
+{
+	set->num_entries = 0;
+	set->max_entries = INVALIDATION_SET_INITIAL_SIZE;
+	set->entries = palloc(sizeof(Invalidation) * set->max_entries);
+}
+
+static void
+invalidation_set_free(InvalidationSet *set)
+{
+	pfree(set->entries);
+	set->entries = NULL;
+	set->num_entries = 0;
+	set->max_entries = 0;
+}
+
+static void
+invalidation_set_add(InvalidationSet *set, const Invalidation *entry)
+{
+	if (set->num_entries >= set->max_entries)
+	{
+		/* The log can hold millions of entries, so allow huge allocations */
+		set->max_entries *= 2;
+		set->entries = repalloc_huge(set->entries, sizeof(Invalidation) * set->max_entries);
+	}
+
+	set->entries[set->num_entries++] = *entry;
+}
+
+static int
+invalidation_cmp(const void *left, const void *right)
+{
+	const Invalidation *a = left;
+	const Invalidation *b = right;
+
+	if (a->lowest_modified_value != b->lowest_modified_value)
+		return a->lowest_modified_value < b->lowest_modified_value ? -1 : 1;
+
+	if (a->greatest_modified_value != b->greatest_modified_value)
+		return a->greatest_modified_value < b->greatest_modified_value ? -1 : 1;
+
+	return 0;
+}
+
+/*
+ * Sort the invalidations in the set and merge all invalidations that overlap
+ * or are adjacent.
+ *
+ * An invalidation that is expanded by a merge is marked as modified. If
+ * merged is not NULL, the invalidations that were merged into another one are
+ * added to it.
+ */
+static void
+invalidation_set_compact(InvalidationSet *set, InvalidationSet *merged)
+{
+	int last = 0;
+	int i;
+
+	if (set->num_entries <= 1)
+		return;
+
+	qsort(set->entries, set->num_entries, sizeof(Invalidation), invalidation_cmp);
+
+	for (i = 1; i < set->num_entries; i++)
+	{
+		const Invalidation *entry = &set->entries[i];
+
+		if (invalidation_entry_try_merge(&set->entries[last], entry))
+		{
+			if (merged != NULL)
+				invalidation_set_add(merged, entry);
+		}
+		else
+			set->entries[++last] = *entry;
+	}
+
+	set->num_entries = last + 1;
+}
+
 /*
  * Process invalidations in the hypertable invalidation log.
  *
@@ -809,6 +886,11 @@ cut_and_insert_new_cagg_invalidation(const CaggInvalidationState *state, const I
  * window). These copied entries are later used to track invalidations across
  * refreshes on a per-cagg basis.
  *
+ * The hypertable invalidation log is scanned only once. The entries are kept
+ * in memory and merged separately for each continuous aggregate, since the
+ * entries are expanded to the bucket boundaries of each aggregate before
+ * merging.
+ *
  * After this function has run, there are no entries left in the hypertable
  * invalidation log.
  */
@@ -817,16 +899,45 @@ move_invalidations_from_hyper_to_cagg_log(const CaggInvalidationState *state)
 {
 	const CaggsInfo *all_caggs = state->all_caggs;
 	int32 hyper_id = state->raw_hypertable_id;
-	int32 last_cagg_hyper_id;
+	InvalidationSet hyper_invalidations;
+	ScanIterator iterator;
 	ListCell *lc1, *lc2, *lc3;
 
-	last_cagg_hyper_id = llast_int(all_caggs->mat_hypertable_ids);
-
 	/* We use a per-tuple memory context in the scan loop since we could be
 	 * processing a lot of invalidations (basically an unbounded
 	 * amount). Initialize it here by resetting it. */
 	MemoryContextReset(state->per_tuple_mctx);
 
+	invalidation_set_init(&hyper_invalidations);
+	hypertable_invalidation_scan_init(&iterator, hyper_id, RowExclusiveLock);
+	iterator.ctx.snapshot = state->snapshot;
+
+	/* Read and delete all invalidations */
+	ts_scanner_foreach(&iterator)
+	{
+		TupleInfo *ti = ts_scan_iterator_tuple_info(&iterator);
+		CatalogSecurityContext sec_ctx;
+		MemoryContext oldmctx;
+		Invalidation logentry;
+
+		oldmctx = MemoryContextSwitchTo(state->per_tuple_mctx);
+		INVALIDATION_ENTRY_SET(&logentry,
+							   ti,
+							   hypertable_id,
+							   Form_continuous_aggs_hypertable_invalidation_log);
+		MemoryContextSwitchTo(oldmctx);
+
+		invalidation_set_add(&hyper_invalidations, &logentry);
+
+		ts_catalog_database_info_become_owner(ts_catalog_database_info_get(), &sec_ctx);
+		ts_catalog_delete_tid_only(ti->scanrel, &logentry.tid);
+		ts_catalog_restore_user(&sec_ctx);
+
+		MemoryContextReset(state->per_tuple_mctx);
+	}
+
+	ts_scan_iterator_close(&iterator);
+
 	/*
 	 * Looping over all continuous aggregates in the outer loop ensures all
 	 * tuples for a specific continuous aggregate is inserted consecutively in
@@ -843,64 +954,40 @@ move_invalidations_from_hyper_to_cagg_log(const CaggInvalidationState *state)
 		int32 cagg_hyper_id = lfirst_int(lc1);
 		int64 bucket_width = DatumGetInt64(PointerGetDatum(lfirst(lc2)));
 		const ContinuousAggsBucketFunction *bucket_function = lfirst(lc3);
+		InvalidationSet cagg_invalidations;
+		int i;
 
-		Invalidation mergedentry;
-		ScanIterator iterator;
+		if (hyper_invalidations.num_entries == 0)
+			break;
 
-		invalidation_entry_reset(&mergedentry);
-		hypertable_invalidation_scan_init(&iterator, hyper_id, RowExclusiveLock);
-		iterator.ctx.snapshot = state->snapshot;
+		invalidation_set_init(&cagg_invalidations);
 
-		/* Scan all invalidations */
-		ts_scanner_foreach(&iterator)
+		for (i = 0; i < hyper_invalidations.num_entries; i++)
 		{
-			TupleInfo *ti;
-			MemoryContext oldmctx;
-			Invalidation logentry;
-
-			oldmctx = MemoryContextSwitchTo(state->per_tuple_mctx);
-			ti = ts_scan_iterator_tuple_info(&iterator);
-
-			invalidation_entry_set_from_hyper_invalidation(&logentry,
-														   ti,
-														   cagg_hyper_id,
-														   state->dimtype,
-														   bucket_width,
-														   bucket_function);
-
-			if (!IS_VALID_INVALIDATION(&mergedentry))
-			{
-				mergedentry = logentry;
-				mergedentry.hyper_id = cagg_hyper_id;
-			}
-			else if (!invalidation_entry_try_merge(&mergedentry, &logentry))
-			{
-				cut_and_insert_new_cagg_invalidation(state, &mergedentry, cagg_hyper_id);
-				mergedentry = logentry;
-			}
-
-			if (cagg_hyper_id == last_cagg_hyper_id)
-			{
-				CatalogSecurityContext sec_ctx;
-
-				/* The invalidation has been processed for all caggs, so the
-				 * only thing left is to delete it from the source hypertable
-				 * invalidation log. */
-				ts_catalog_database_info_become_owner(ts_catalog_database_info_get(), &sec_ctx);
-				ts_catalog_delete_tid_only(ti->scanrel, &logentry.tid);
-				ts_catalog_restore_user(&sec_ctx);
-			}
-
-			MemoryContextSwitchTo(oldmctx);
-			MemoryContextReset(state->per_tuple_mctx);
+			Invalidation entry = hyper_invalidations.entries[i];
+
+			/* Since hypertable invalidations are moved to the continuous
+			 * aggregate invalidation log, a different hypertable ID must be
+			 * set (the ID of the materialized hypertable). */
+			entry.hyper_id = cagg_hyper_id;
+			invalidation_expand_to_bucket_boundaries(&entry,
+													 state->dimtype,
+													 bucket_width,
+													 bucket_function);
+			invalidation_set_add(&cagg_invalidations, &entry);
 		}
 
-		ts_scan_iterator_close(&iterator);
+		invalidation_set_compact(&cagg_invalidations, NULL);
+
+		for (i = 0; i < cagg_invalidations.num_entries; i++)
+			cut_and_insert_new_cagg_invalidation(state,
+												 &cagg_invalidations.entries[i],
+												 cagg_hyper_id);
 
-		/* Handle the last merged invalidation */
-		if (IS_VALID_INVALIDATION(&mergedentry))
-			cut_and_insert_new_cagg_invalidation(state, &mergedentry, cagg_hyper_id);
+		invalidation_set_free(&cagg_invalidations);
 	}
+
+	invalidation_set_free(&hyper_invalidations);
 }
 
 static void
@@ -1321,6 +1408,232 @@ invalidation_process_cagg_log(int32 mat_hypertable_id, int32 raw_hypertable_id,
 	return store;
 }
 
+/*
+ * Find the lowest invalidated value of a continuous aggregate that is at or
+ * after the given start and inside the refresh window.
+ *
+ * Returns false if there are no such invalidations.
+ */
+bool
+invalidation_cagg_log_get_next(int32 mat_hypertable_id, const InternalTimeRange *refresh_window,
+							   int64 start, int64 *next)
+{
+	ScanIterator iterator;
+	bool found = false;
+
+	cagg_invalidations_scan_by_hypertable_init(&iterator, mat_hypertable_id, AccessShareLock);
+
+	ts_scanner_foreach(&iterator)
+	{
+		TupleInfo *ti = ts_scan_iterator_tuple_info(&iterator);
+		bool isnull;
+		int64 lowest = DatumGetInt64(
+			slot_getattr(ti->slot,
+						 Anum_continuous_aggs_materialization_invalidation_log_lowest_modified_value,
+						 &isnull));
+		int64 greatest = DatumGetInt64(
+			slot_getattr(ti->slot,
+						 Anum_continuous_aggs_materialization_invalidation_log_greatest_modified_value,
+						 &isnull));
+
+		/* Invalidations are inclusive at the end, while refresh windows aren't */
+		if (greatest < start || lowest >= refresh_window->end)
+			continue;
+
+		if (lowest < start)
+			lowest = start;
+
+		if (!found || lowest < *next)
+		{
+			*next = lowest;
+			found = true;
+		}
+	}
+
+	ts_scan_iterator_close(&iterator);
+
+	return found;
+}
+
+static bool
+invalidation_scan_overlaps(ScanIterator *iterator, AttrNumber lowest_attno,
+						   AttrNumber greatest_attno, const InternalTimeRange *range)
+{
+	bool found = false;
+
+	ts_scanner_foreach(iterator)
+	{
+		TupleInfo *ti = ts_scan_iterator_tuple_info(iterator);
+		bool isnull;
+		int64 lowest = DatumGetInt64(slot_getattr(ti->slot, lowest_attno, &isnull));
+		int64 greatest = DatumGetInt64(slot_getattr(ti->slot, greatest_attno, &isnull));
+
+		/* Invalidations are inclusive at the end, while ranges aren't */
+		if (lowest < range->end && greatest >= range->start)
+		{
+			found = true;
+			break;
+		}
+	}
+
+	ts_scan_iterator_close(iterator);
+
+	return found;
+}
+
+/*
+ * Check if a range of a continuous aggregate has modifications that are not
+ * materialized yet, i.e., if an entry of the hypertable invalidation log of
+ * the raw hypertable or of the invalidation log of the continuous aggregate
+ * overlaps the range.
+ *
+ * Modifications made by the current transaction are only logged when it
+ * commits, so they are not seen here.
+ */
+bool
+invalidation_logs_overlap(int32 mat_hypertable_id, int32 raw_hypertable_id,
+						  const InternalTimeRange *range)
+{
+	ScanIterator iterator;
+
+	hypertable_invalidation_scan_init(&iterator, raw_hypertable_id, AccessShareLock);
+
+	if (invalidation_scan_overlaps(
+			&iterator,
+			Anum_continuous_aggs_hypertable_invalidation_log_lowest_modified_value,
+			Anum_continuous_aggs_hypertable_invalidation_log_greatest_modified_value,
+			range))
+		return true;
+
+	cagg_invalidations_scan_by_hypertable_init(&iterator, mat_hypertable_id, AccessShareLock);
+
+	return invalidation_scan_overlaps(
+		&iterator,
+		Anum_continuous_aggs_materialization_invalidation_log_lowest_modified_value,
+		Anum_continuous_aggs_materialization_invalidation_log_greatest_modified_value,
+		range);
+}
+
+/*
+ * Compact the invalidation log of a continuous aggregate.
+ *
+ * Every refresh of a continuous aggregate copies the hypertable invalidation
+ * log to the logs of all continuous aggregates on the same hypertable, where
+ * the new entries are not merged with the existing ones. The log of a
+ * continuous aggregate that is refreshed less often than the others can
+ * therefore grow to many small, overlapping entries. This merges the entries
+ * of the log into a set of non-overlapping entries, keeping one tuple for
+ * each merged entry and deleting the others.
+ *
+ * The caller must prevent concurrent refreshes of the continuous aggregate.
+ *
+ * Returns the number of entries removed from the log.
+ */
+int
+invalidation_cagg_log_compact(int32 mat_hypertable_id)
+{
+	Relation rel = open_invalidation_log(LOG_CAGG, RowExclusiveLock);
+	TupleDesc tupdesc = RelationGetDescr(rel);
+	CatalogSecurityContext sec_ctx;
+	InvalidationSet invalidations;
+	InvalidationSet merged;
+	ScanIterator iterator;
+	int removed;
+	int i;
+
+	invalidation_set_init(&invalidations);
+	invalidation_set_init(&merged);
+	cagg_invalidations_scan_by_hypertable_init(&iterator, mat_hypertable_id, RowExclusiveLock);
+
+	ts_scanner_foreach(&iterator)
+	{
+		TupleInfo *ti = ts_scan_iterator_tuple_info(&iterator);
+		Invalidation logentry;
+
+		INVALIDATION_ENTRY_SET(&logentry,
+							   ti,
+							   materialization_id,
+							   Form_continuous_aggs_materialization_invalidation_log);
+		invalidation_set_add(&invalidations, &logentry);
+	}
+
+	ts_scan_iterator_close(&iterator);
+
+	invalidation_set_compact(&invalidations, &merged);
+
+	ts_catalog_database_info_become_owner(ts_catalog_database_info_get(), &sec_ctx);
+
+	for (i = 0; i < merged.num_entries; i++)
+		ts_catalog_delete_tid_only(rel, &merged.entries[i].tid);
+
+	for (i = 0; i < invalidations.num_entries; i++)
+	{
+		const Invalidation *entry = &invalidations.entries[i];
+
+		if (entry->is_modified)
+		{
+			ItemPointerData tid = entry->tid;
+			HeapTuple tuple = create_invalidation_tup(tupdesc,
+													  mat_hypertable_id,
+													  entry->lowest_modified_value,
+													  entry->greatest_modified_value);
+			ts_catalog_update_tid_only(rel, &tid, tuple);
+			heap_freetuple(tuple);
+		}
+	}
+
+	ts_catalog_restore_user(&sec_ctx);
+	table_close(rel, NoLock);
+
+	removed = merged.num_entries;
+	invalidation_set_free(&invalidations);
+	invalidation_set_free(&merged);
+
+	return removed;
+}
+
+/*
+ * Compact the invalidation logs of all continuous aggregates on a hypertable.
+ *
+ * The log of a continuous aggregate is skipped if the aggregate is being
+ * refreshed, since the refresh processes the log while holding a lock on the
+ * materialized hypertable.
+ *
+ * The ExclusiveLock taken on each compacted materialized hypertable is held
+ * until the end of the transaction of the policy job, so refreshes of these
+ * aggregates, and inserts into their materialized hypertables, wait for the
+ * job to commit.
+ */
+void
+invalidation_compact_cagg_logs(int32 raw_hypertable_id)
+{
+	Hypertable *raw_ht = ts_hypertable_get_by_id(raw_hypertable_id);
+	CaggsInfo all_caggs;
+	ListCell *lc;
+
+	/* The invalidation logs of distributed hypertables are on the data nodes */
+	if (raw_ht == NULL || hypertable_is_distributed(raw_ht))
+		return;
+
+	all_caggs = ts_continuous_agg_get_all_caggs_info(raw_hypertable_id);
+
+	foreach (lc, all_caggs.mat_hypertable_ids)
+	{
+		int32 mat_hypertable_id = lfirst_int(lc);
+		Oid mat_relid = ts_hypertable_id_to_relid(mat_hypertable_id, true);
+		int removed;
+
+		if (!OidIsValid(mat_relid) || !ConditionalLockRelationOid(mat_relid, ExclusiveLock))
+			continue;
+
+		removed = invalidation_cagg_log_compact(mat_hypertable_id);
+		elog(DEBUG1,
+			 "removed %d entries from the invalidation log of materialized hypertable %d",
+			 removed,
+			 mat_hypertable_id);
+	}
+}
+
 /**
  * Processes the materialization invalidation log in a data node for the CAGG being refreshed that
  * belongs to the distributed hypertable with hypertable ID 'raw_hypertable_id' in the Access Node.
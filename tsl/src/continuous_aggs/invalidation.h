@@ -61,6 +61,13 @@ extern InvalidationStore *invalidation_process_cagg_log(
 	const CaggsInfo *all_caggs_info, const long max_materializations, bool *do_merged_refresh,
 	InternalTimeRange *ret_merged_refresh_window);
 extern Datum tsl_invalidation_process_cagg_log(PG_FUNCTION_ARGS);
+extern bool invalidation_cagg_log_get_next(int32 mat_hypertable_id,
+										  const InternalTimeRange *refresh_window, int64 start,
+										  int64 *next);
+extern bool invalidation_logs_overlap(int32 mat_hypertable_id, int32 raw_hypertable_id,
+									  const InternalTimeRange *range);
+extern int invalidation_cagg_log_compact(int32 mat_hypertable_id);
+extern void invalidation_compact_cagg_logs(int32 raw_hypertable_id);
 extern void remote_invalidation_process_cagg_log(int32 mat_hypertable_id, int32 raw_hypertable_id,
 												 const InternalTimeRange *refresh_window,
 												 const CaggsInfo *all_caggs,
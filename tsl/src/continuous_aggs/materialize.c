@@ -13,6 +13,7 @@
 #include <utils/date.h>
 #include <utils/snapmgr.h>
 
+#include <cagg_refresh_stats.h>
 #include <scanner.h>
 #include <compat/compat.h>
 #include <scan_iterator.h>
@@ -20,6 +21,7 @@
 #include "ts_catalog/continuous_aggs_watermark.h"
 #include <time_utils.h>
 #include "debug_assert.h"
+#include "guc.h"
 
 #include "materialize.h"
 
@@ -50,6 +52,13 @@ static void spi_insert_materializations(Hypertable *mat_ht, SchemaAndName partia
 										const NameData *time_column_name,
 										TimeRange materialization_range,
 										const char *const chunk_condition);
+static void spi_merge_materializations(Hypertable *mat_ht, SchemaAndName partial_view,
+									   SchemaAndName materialization_table,
+									   const NameData *time_column_name,
+									   TimeRange materialization_range,
+									   const char *const chunk_condition);
+static void update_watermark_from_spi_result(Hypertable *mat_ht);
+static void count_refreshed_rows(int64 rows_deleted, int64 rows_inserted);
 
 void
 continuous_agg_update_materialization(Hypertable *mat_ht, SchemaAndName partial_view,
@@ -124,6 +133,24 @@ continuous_agg_update_materialization(Hypertable *mat_ht, SchemaAndName partial_
 									internal_time_range_to_time_range(new_materialization_range),
 									chunk_id);
 	}
+
+	ts_cagg_refresh_stats_set_phase(CAGG_REFRESH_PHASE_NONE);
+}
+
+/*
+ * Add the rows changed in the materialization table to the statistics of the
+ * refresh in progress, if any.
+ */
+static void
+count_refreshed_rows(int64 rows_deleted, int64 rows_inserted)
+{
+	CaggRefreshCounters *counters = ts_cagg_refresh_stats_counters();
+
+	if (counters == NULL)
+		return;
+
+	counters->rows_deleted += rows_deleted;
+	counters->rows_inserted += rows_inserted;
 }
 
 static bool
@@ -230,6 +257,17 @@ spi_update_materializations(Hypertable *mat_ht, SchemaAndName partial_view,
 	if (chunk_id != INVALID_CHUNK_ID)
 		appendStringInfo(chunk_condition, "AND chunk_id = %d", chunk_id);
 
+	if (ts_guc_enable_cagg_delta_refresh)
+	{
+		spi_merge_materializations(mat_ht,
+								   partial_view,
+								   materialization_table,
+								   time_column_name,
+								   invalidation_range,
+								   chunk_condition->data);
+		return;
+	}
+
 	spi_delete_materializations(materialization_table,
 								time_column_name,
 								invalidation_range,
@@ -268,10 +306,13 @@ spi_delete_materializations(SchemaAndName materialization_table, const NameData
 					 quote_literal_cstr(invalidation_end),
 					 chunk_condition);
 
+	ts_cagg_refresh_stats_set_phase(CAGG_REFRESH_PHASE_DELETE);
 	res = SPI_execute(command->data, false /* read_only */, 0 /*count*/);
 
 	if (res < 0)
 		elog(ERROR, "could not delete old values from materialization table");
+
+	count_refreshed_rows(SPI_processed, 0);
 }
 
 static void
@@ -281,7 +322,7 @@ spi_insert_materializations(Hypertable *mat_ht, SchemaAndName partial_view,
 {
 	int res;
 	StringInfo command = makeStringInfo();
-	Oid out_fn, timetype;
+	Oid out_fn;
 	bool type_is_varlena;
 	char *materialization_start;
 	char *materialization_end;
@@ -303,24 +344,18 @@ spi_insert_materializations(Hypertable *mat_ht, SchemaAndName partial_view,
 					 quote_literal_cstr(materialization_end),
 					 chunk_condition);
 
+	ts_cagg_refresh_stats_set_phase(CAGG_REFRESH_PHASE_INSERT);
 	res = SPI_execute(command->data, false /* read_only */, 0 /*count*/);
 
 	if (res < 0)
 		elog(ERROR, "could not materialize values into the materialization table");
 
+	count_refreshed_rows(0, SPI_processed);
+
 	/* Get the max(time_dimension) of the materialized data */
 	if (SPI_processed > 0)
 	{
-		int64 watermark;
-		bool isnull;
-		Datum maxdat;
-		const Dimension *dim = hyperspace_get_open_dimension(mat_ht->space, 0);
-
-		if (NULL == dim)
-			elog(ERROR, "invalid open dimension index 0");
-
-		timetype = ts_dimension_get_partition_type(dim);
-
+		ts_cagg_refresh_stats_set_phase(CAGG_REFRESH_PHASE_WATERMARK);
 		resetStringInfo(command);
 		appendStringInfo(command,
 						 "SELECT pg_catalog.max(%s) FROM %s.%s AS I "
@@ -339,19 +374,145 @@ spi_insert_materializations(Hypertable *mat_ht, SchemaAndName partial_view,
 		if (res < 0)
 			elog(ERROR, "could not get the last bucket of the materialized data");
 
-		Ensure(SPI_gettypeid(SPI_tuptable->tupdesc, 1) == timetype,
-			   "partition types for result (%d) and dimension (%d) do not match",
-			   SPI_gettypeid(SPI_tuptable->tupdesc, 1),
-			   ts_dimension_get_partition_type(dim));
-		maxdat = SPI_getbinval(SPI_tuptable->vals[0], SPI_tuptable->tupdesc, 1, &isnull);
-
-		if (!isnull)
-		{
-			watermark = ts_time_value_to_internal(maxdat, timetype);
-			ts_cagg_watermark_update(mat_ht, watermark, isnull, false);
-		}
+		update_watermark_from_spi_result(mat_ht);
 	}
 }
+
+/*
+ * Materialize a range by only applying the difference between the partial
+ * view and the materialization table.
+ *
+ * Rows of the materialization table that are not part of the new partial
+ * view output are deleted and new rows that are not already materialized
+ * are inserted. Buckets that did not change are left untouched, which avoids
+ * dead tuples and index churn when large ranges are re-materialized because
+ * of a few scattered invalidations. A changed bucket is replaced by a delete
+ * and an insert since the grouping columns of the materialization table are
+ * not known here.
+ *
+ * Rows are compared by their text representation since aggregate results
+ * need not have an equality operator. The partial view is only evaluated
+ * once, and the watermark is computed from the same pass.
+ */
+static void
+spi_merge_materializations(Hypertable *mat_ht, SchemaAndName partial_view,
+						   SchemaAndName materialization_table, const NameData *time_column_name,
+						   TimeRange materialization_range, const char *const chunk_condition)
+{
+	int res;
+	StringInfo command = makeStringInfo();
+	Oid out_fn;
+	bool type_is_varlena;
+	char *materialization_start;
+	char *materialization_end;
+	const char *mat_schema = quote_identifier(NameStr(*materialization_table.schema));
+	const char *mat_name = quote_identifier(NameStr(*materialization_table.name));
+	const char *time_column = quote_identifier(NameStr(*time_column_name));
+
+	getTypeOutputInfo(materialization_range.type, &out_fn, &type_is_varlena);
+	materialization_start =
+		quote_literal_cstr(OidOutputFunctionCall(out_fn, materialization_range.start));
+	materialization_end =
+		quote_literal_cstr(OidOutputFunctionCall(out_fn, materialization_range.end));
+
+	appendStringInfo(command,
+					 "WITH N AS (SELECT * FROM %s.%s AS I "
+					 "WHERE I.%s >= %s AND I.%s < %s %s), ",
+					 quote_identifier(NameStr(*partial_view.schema)),
+					 quote_identifier(NameStr(*partial_view.name)),
+					 time_column,
+					 materialization_start,
+					 time_column,
+					 materialization_end,
+					 chunk_condition);
+	appendStringInfo(command,
+					 "D AS (DELETE FROM %s.%s AS M "
+					 "WHERE M.%s >= %s AND M.%s < %s %s "
+					 "AND NOT EXISTS (SELECT FROM N WHERE N::text = M::text) RETURNING 1), ",
+					 mat_schema,
+					 mat_name,
+					 time_column,
+					 materialization_start,
+					 time_column,
+					 materialization_end,
+					 chunk_condition);
+	appendStringInfo(command,
+					 "I AS (INSERT INTO %s.%s SELECT * FROM N "
+					 "WHERE NOT EXISTS (SELECT FROM %s.%s AS M "
+					 "WHERE M.%s >= %s AND M.%s < %s AND N::text = M::text) RETURNING 1) ",
+					 mat_schema,
+					 mat_name,
+					 mat_schema,
+					 mat_name,
+					 time_column,
+					 materialization_start,
+					 time_column,
+					 materialization_end);
+	appendStringInfo(command,
+					 "SELECT pg_catalog.max(N.%s), "
+					 "(SELECT pg_catalog.count(*) FROM D), (SELECT pg_catalog.count(*) FROM I) "
+					 "FROM N;",
+					 time_column);
+
+	/* The delete and insert are done by the same statement */
+	ts_cagg_refresh_stats_set_phase(CAGG_REFRESH_PHASE_INSERT);
+	res = SPI_execute(command->data, false /* read_only */, 0 /*count*/);
+
+	if (res < 0)
+		elog(ERROR, "could not materialize values into the materialization table");
+
+	if (SPI_processed > 0)
+	{
+		bool isnull;
+		int64 deleted =
+			DatumGetInt64(SPI_getbinval(SPI_tuptable->vals[0], SPI_tuptable->tupdesc, 2, &isnull));
+		int64 inserted =
+			DatumGetInt64(SPI_getbinval(SPI_tuptable->vals[0], SPI_tuptable->tupdesc, 3, &isnull));
+
+		elog(DEBUG1,
+			 "delta refresh of \"%s\" deleted " INT64_FORMAT " and inserted " INT64_FORMAT
+			 " rows",
+			 NameStr(*materialization_table.name),
+			 deleted,
+			 inserted);
+
+		count_refreshed_rows(deleted, inserted);
+		ts_cagg_refresh_stats_set_phase(CAGG_REFRESH_PHASE_WATERMARK);
+		update_watermark_from_spi_result(mat_ht);
+	}
+}
+
+/*
+ * Update the watermark from the max(time_dimension) of the materialized data,
+ * which is expected in the first column of the current SPI result.
+ */
+static void
+update_watermark_from_spi_result(Hypertable *mat_ht)
+{
+	int64 watermark;
+	bool isnull;
+	Datum maxdat;
+	Oid timetype;
+	const Dimension *dim = hyperspace_get_open_dimension(mat_ht->space, 0);
+
+	if (NULL == dim)
+		elog(ERROR, "invalid open dimension index 0");
+
+	timetype = ts_dimension_get_partition_type(dim);
+
+	Ensure(SPI_gettypeid(SPI_tuptable->tupdesc, 1) == timetype,
+		   "partition types for result (%d) and dimension (%d) do not match",
+		   SPI_gettypeid(SPI_tuptable->tupdesc, 1),
+		   ts_dimension_get_partition_type(dim));
+	maxdat = SPI_getbinval(SPI_tuptable->vals[0], SPI_tuptable->tupdesc, 1, &isnull);
+
+	if (!isnull)
+	{
+		watermark = ts_time_value_to_internal(maxdat, timetype);
+		ts_cagg_watermark_update(mat_ht, watermark, isnull, false);
+	}
+}
+
 /*
  * Initialize MatTableColumnInfo.
  */
@@ -4,6 +4,8 @@
  * LICENSE-TIMESCALE for a copy of the license.
  */
 #include <postgres.h>
+#include <access/stratnum.h>
+#include <common/int.h>
 #include <utils/acl.h>
 #include <utils/lsyscache.h>
 #include <utils/fmgrprotos.h>
@@ -15,10 +17,14 @@
 #include <miscadmin.h>
 #include <fmgr.h>
 #include <executor/spi.h>
+#include <pgstat.h>
 
 #include "ts_catalog/catalog.h"
 #include "ts_catalog/continuous_agg.h"
+#include <cagg_refresh_stats.h>
+#include <chunk.h>
 #include <dimension.h>
+#include <dimension_slice.h>
 #include <hypertable.h>
 #include <hypertable_cache.h>
 #include <time_bucket.h>
@@ -37,6 +43,10 @@ typedef struct CaggRefreshState
 	Hypertable *cagg_ht;
 	InternalTimeRange refresh_window;
 	SchemaAndName partial_view;
+	/* Union of the bucketed windows materialized so far */
+	InternalTimeRange refreshed_window;
+	/* Time dimension of the raw hypertable, or zero if it is distributed */
+	int32 raw_dimension_id;
 } CaggRefreshState;
 
 static Hypertable *cagg_get_hypertable_or_fail(int32 hypertable_id);
@@ -68,13 +78,23 @@ static void continuous_agg_refresh_with_window(const ContinuousAgg *cagg,
 											   const int64 bucket_width, int32 chunk_id,
 											   const bool is_raw_ht_distributed,
 											   const bool do_merged_refresh,
-											   const InternalTimeRange merged_refresh_window);
+											   const InternalTimeRange merged_refresh_window,
+											   InternalTimeRange *refreshed_window);
 static ContinuousAgg *get_cagg_by_relid(const Oid cagg_relid);
 static void emit_up_to_date_notice(const ContinuousAgg *cagg, const CaggRefreshCallContext callctx);
 static bool process_cagg_invalidations_and_refresh(const ContinuousAgg *cagg,
 												   const InternalTimeRange *refresh_window,
 												   const CaggRefreshCallContext callctx,
-												   int32 chunk_id);
+												   int32 chunk_id,
+												   InternalTimeRange *refreshed_window);
+static bool continuous_agg_refresh_in_windows(int32 mat_id,
+											  const InternalTimeRange *refresh_window,
+											  CaggRefreshCallContext callctx,
+											  InternalTimeRange *refreshed_window);
+static void continuous_agg_refresh_cascade(int32 mat_id, const InternalTimeRange *refreshed_window);
+
+/* Number of cascading refreshes running in this backend, nested in each other */
+static int cascade_depth = 0;
 
 static Hypertable *
 cagg_get_hypertable_or_fail(int32 hypertable_id)
@@ -271,12 +291,97 @@ static void
 continuous_agg_refresh_init(CaggRefreshState *refresh, const ContinuousAgg *cagg,
 							const InternalTimeRange *refresh_window)
 {
+	Hypertable *raw_ht;
+	const Dimension *time_dim;
+
 	MemSet(refresh, 0, sizeof(*refresh));
 	refresh->cagg = *cagg;
 	refresh->cagg_ht = cagg_get_hypertable_or_fail(cagg->data.mat_hypertable_id);
 	refresh->refresh_window = *refresh_window;
 	refresh->partial_view.schema = &refresh->cagg.data.partial_view_schema;
 	refresh->partial_view.name = &refresh->cagg.data.partial_view_name;
+	refresh->refreshed_window.type = refresh_window->type;
+
+	raw_ht = cagg_get_hypertable_or_fail(cagg->data.raw_hypertable_id);
+	time_dim = hyperspace_get_open_dimension(raw_ht->space, 0);
+
+	if (!hypertable_is_distributed(raw_ht) && time_dim != NULL)
+		refresh->raw_dimension_id = time_dim->fd.id;
+}
+
+/*
+ * Get the chunks of the raw hypertable that hold data for a refresh window,
+ * and their compressed chunks.
+ */
+static void
+get_raw_chunk_relids(const CaggRefreshState *refresh,
+					 const InternalTimeRange *bucketed_refresh_window, List **chunk_relids,
+					 List **compressed_chunk_relids)
+{
+	List *chunk_ids = NIL;
+	DimensionVec *slices;
+	ListCell *lc;
+	int i;
+
+	slices = ts_dimension_slice_scan_range_limit(refresh->raw_dimension_id,
+												 BTLessStrategyNumber,
+												 bucketed_refresh_window->end,
+												 BTGreaterEqualStrategyNumber,
+												 bucketed_refresh_window->start,
+												 0,
+												 NULL);
+
+	for (i = 0; i < slices->num_slices; i++)
+		ts_chunk_constraint_scan_by_dimension_slice_to_list(slices->slices[i],
+															&chunk_ids,
+															CurrentMemoryContext);
+
+	foreach (lc, chunk_ids)
+	{
+		Chunk *chunk = ts_chunk_get_by_id(lfirst_int(lc), false);
+
+		if (chunk == NULL)
+			continue;
+
+		*chunk_relids = lappend_oid(*chunk_relids, chunk->table_id);
+
+		if (chunk->fd.compressed_chunk_id != INVALID_CHUNK_ID)
+		{
+			Oid relid = ts_chunk_get_relid(chunk->fd.compressed_chunk_id, true);
+
+			if (OidIsValid(relid))
+				*compressed_chunk_relids = lappend_oid(*compressed_chunk_relids, relid);
+		}
+	}
+}
+
+/*
+ * Get the number of tuples that this backend has read from a list of
+ * relations, according to its pending cumulative statistics.
+ */
+static int64
+get_tuples_read(List *relids)
+{
+	int64 tuples_read = 0;
+	ListCell *lc;
+
+	foreach (lc, relids)
+	{
+		PgStat_TableStatus *tabstat = find_tabstat_entry(lfirst_oid(lc));
+
+		if (tabstat != NULL)
+			tuples_read += tabstat->t_counts.t_tuples_returned + tabstat->t_counts.t_tuples_fetched;
+	}
+
+	return tuples_read;
+}
+
+static int64
+tuples_read_delta(int64 before, int64 after)
+{
+	/* The statistics might have been reported in between, which resets the
+	 * pending counters */
+	return after >= before ? after - before : after;
 }
 
 /*
@@ -303,9 +408,26 @@ continuous_agg_refresh_execute(const CaggRefreshState *refresh,
 		.end = 0,
 	};
 	const Dimension *time_dim = hyperspace_get_open_dimension(refresh->cagg_ht->space, 0);
+	CaggRefreshCounters *counters = ts_cagg_refresh_stats_counters();
+	List *chunk_relids = NIL;
+	List *compressed_chunk_relids = NIL;
+	int64 raw_rows_read = 0;
+	int64 compressed_batches_read = 0;
 
 	Assert(time_dim != NULL);
 
+	/* Count the rows read from the raw hypertable using the statistics of
+	 * its chunks */
+	if (counters != NULL && refresh->raw_dimension_id != 0)
+	{
+		get_raw_chunk_relids(refresh,
+							 bucketed_refresh_window,
+							 &chunk_relids,
+							 &compressed_chunk_relids);
+		raw_rows_read = get_tuples_read(chunk_relids);
+		compressed_batches_read = get_tuples_read(compressed_chunk_relids);
+	}
+
 	continuous_agg_update_materialization(refresh->cagg_ht,
 										  refresh->partial_view,
 										  cagg_hypertable_name,
@@ -313,6 +435,14 @@ continuous_agg_refresh_execute(const CaggRefreshState *refresh,
 										  *bucketed_refresh_window,
 										  unused_invalidation_range,
 										  chunk_id);
+
+	if (counters != NULL)
+	{
+		counters->ranges++;
+		counters->raw_rows_read += tuples_read_delta(raw_rows_read, get_tuples_read(chunk_relids));
+		counters->compressed_batches_read +=
+			tuples_read_delta(compressed_batches_read, get_tuples_read(compressed_chunk_relids));
+	}
 }
 
 static void
@@ -393,12 +523,15 @@ continuous_agg_refresh_execute_wrapper(const InternalTimeRange *bucketed_refresh
 									   const long iteration, void *arg1_refresh,
 									   void *arg2_chunk_id)
 {
-	const CaggRefreshState *refresh = (const CaggRefreshState *) arg1_refresh;
+	CaggRefreshState *refresh = (CaggRefreshState *) arg1_refresh;
 	const int32 chunk_id = *(const int32 *) arg2_chunk_id;
-	(void) iteration;
 
 	log_refresh_window(DEBUG1, &refresh->cagg, bucketed_refresh_window, "invalidation refresh on");
 	continuous_agg_refresh_execute(refresh, bucketed_refresh_window, chunk_id);
+	update_merged_refresh_window(bucketed_refresh_window,
+								 iteration,
+								 &refresh->refreshed_window,
+								 NULL);
 }
 
 static void
@@ -420,6 +553,28 @@ update_merged_refresh_window(const InternalTimeRange *bucketed_refresh_window, c
 	}
 }
 
+/*
+ * Extend the window refreshed by a refresh to also cover the given bucketed
+ * window. Empty windows are ignored.
+ */
+static void
+refreshed_window_extend(InternalTimeRange *refreshed_window, const InternalTimeRange *window)
+{
+	if (window->start >= window->end)
+		return;
+
+	if (refreshed_window->start >= refreshed_window->end)
+		*refreshed_window = *window;
+	else
+	{
+		if (window->start < refreshed_window->start)
+			refreshed_window->start = window->start;
+
+		if (window->end > refreshed_window->end)
+			refreshed_window->end = window->end;
+	}
+}
+
 static long
 continuous_agg_scan_refresh_window_ranges(const InternalTimeRange *refresh_window,
 										  const InvalidationStore *invalidations,
@@ -502,7 +657,8 @@ continuous_agg_refresh_with_window(const ContinuousAgg *cagg,
 								   const InvalidationStore *invalidations, const int64 bucket_width,
 								   int32 chunk_id, const bool is_raw_ht_distributed,
 								   const bool do_merged_refresh,
-								   const InternalTimeRange merged_refresh_window)
+								   const InternalTimeRange merged_refresh_window,
+								   InternalTimeRange *refreshed_window)
 {
 	CaggRefreshState refresh;
 	bool old_per_data_node_queries = ts_guc_enable_per_data_node_queries;
@@ -538,6 +694,7 @@ continuous_agg_refresh_with_window(const ContinuousAgg *cagg,
 						   &merged_refresh_window,
 						   "merged invalidations for refresh on");
 		continuous_agg_refresh_execute(&refresh, &merged_refresh_window, chunk_id);
+		refresh.refreshed_window = merged_refresh_window;
 	}
 	else
 	{
@@ -551,6 +708,8 @@ continuous_agg_refresh_with_window(const ContinuousAgg *cagg,
 														  (void *) &chunk_id /* arg2 */);
 		Assert(count);
 	}
+
+	refreshed_window_extend(refreshed_window, &refresh.refreshed_window);
 	ts_guc_enable_per_data_node_queries = old_per_data_node_queries;
 }
 
@@ -648,6 +807,7 @@ emit_up_to_date_notice(const ContinuousAgg *cagg, const CaggRefreshCallContext c
 				 NameStr(cagg->data.user_view_name));
 			break;
 		case CAGG_REFRESH_POLICY:
+		case CAGG_REFRESH_CASCADE:
 			break;
 	}
 }
@@ -673,7 +833,8 @@ continuous_agg_calculate_merged_refresh_window(const InternalTimeRange *refresh_
 static bool
 process_cagg_invalidations_and_refresh(const ContinuousAgg *cagg,
 									   const InternalTimeRange *refresh_window,
-									   const CaggRefreshCallContext callctx, int32 chunk_id)
+									   const CaggRefreshCallContext callctx, int32 chunk_id,
+									   InternalTimeRange *refreshed_window)
 {
 	InvalidationStore *invalidations;
 	Oid hyper_relid = ts_hypertable_id_to_relid(cagg->data.mat_hypertable_id, false);
@@ -681,6 +842,8 @@ process_cagg_invalidations_and_refresh(const ContinuousAgg *cagg,
 	InternalTimeRange merged_refresh_window;
 	long max_materializations;
 
+	ts_cagg_refresh_stats_set_phase(CAGG_REFRESH_PHASE_INVALIDATION);
+
 	/* Lock the continuous aggregate's materialized hypertable to protect
 	 * against concurrent refreshes. Only concurrent reads will be
 	 * allowed. This is a heavy lock that serializes all refreshes on the same
@@ -743,7 +906,8 @@ process_cagg_invalidations_and_refresh(const ContinuousAgg *cagg,
 										   chunk_id,
 										   is_raw_ht_distributed,
 										   do_merged_refresh,
-										   merged_refresh_window);
+										   merged_refresh_window,
+										   refreshed_window);
 		if (invalidations)
 			invalidation_store_free(invalidations);
 		return true;
@@ -752,49 +916,234 @@ process_cagg_invalidations_and_refresh(const ContinuousAgg *cagg,
 	return false;
 }
 
-void
-continuous_agg_refresh_internal(const ContinuousAgg *cagg,
-								const InternalTimeRange *refresh_window_arg,
-								const CaggRefreshCallContext callctx, const bool start_isnull,
-								const bool end_isnull)
+/*
+ * Get the start of the raw hypertable's data at or after the given value,
+ * using the time slices of its chunks. Only the chunk catalog is read, so
+ * finding the next window does not scan the raw hypertable, but the result
+ * is only as precise as the chunk ranges.
+ *
+ * Returns false if no chunk overlaps the range from start up to end.
+ */
+static bool
+raw_hypertable_get_next_chunk_start(const Hypertable *raw_ht, int64 start, int64 end,
+									int64 *next)
+{
+	const Dimension *dim = hyperspace_get_open_dimension(raw_ht->space, 0);
+	DimensionVec *slices;
+
+	/* Slices are returned in order of their range start */
+	slices = ts_dimension_slice_scan_range_limit(dim->fd.id,
+												 BTLessStrategyNumber,
+												 end,
+												 BTGreaterEqualStrategyNumber,
+												 start,
+												 1,
+												 NULL);
+
+	if (slices->num_slices == 0)
+		return false;
+
+	*next = Max(start, slices->slices[0]->fd.range_start);
+
+	return true;
+}
+
+/*
+ * Refresh a continuous aggregate in independent windows.
+ *
+ * Materializing all invalidations of a refresh window in one transaction
+ * holds the lock on the materialized hypertable until the end and loses all
+ * work if the refresh fails, which is a problem after a large backfill.
+ * Instead, split the refresh window into bucket-aligned windows that each
+ * cover at most timescaledb.cagg_refresh_window_buckets buckets of data, and
+ * process and commit the invalidations of each window in its own
+ * transaction. A range without chunks in the raw hypertable is refreshed as
+ * part of the window that follows it, since it only needs materialized rows
+ * to be deleted.
+ *
+ * Invalidations outside of the refreshed windows stay in the log, so a
+ * refresh that is interrupted is continued by the next refresh.
+ *
+ * The windows are refreshed one after another in this backend, so this
+ * bounds the work lost on failure but does not shorten the refresh.
+ *
+ * Returns true if any window was refreshed.
+ */
+static bool
+continuous_agg_refresh_in_windows(int32 mat_id, const InternalTimeRange *refresh_window,
+								  CaggRefreshCallContext callctx,
+								  InternalTimeRange *refreshed_window)
+{
+	int64 cursor = refresh_window->start;
+	bool refreshed = false;
+
+	while (cursor < refresh_window->end)
+	{
+		const ContinuousAgg *cagg = ts_continuous_agg_find_by_mat_hypertable_id(mat_id);
+		Hypertable *raw_ht = cagg_get_hypertable_or_fail(cagg->data.raw_hypertable_id);
+		int64 bucket_width = ts_continuous_agg_bucket_width(cagg);
+		InternalTimeRange window = {
+			.type = refresh_window->type,
+		};
+		int64 next_invalidation;
+		int64 next_data;
+		int64 window_width;
+
+		if (!invalidation_cagg_log_get_next(mat_id, refresh_window, cursor, &next_invalidation))
+			break;
+
+		window.start = next_invalidation;
+
+		if (!raw_hypertable_get_next_chunk_start(raw_ht,
+												 next_invalidation,
+												 refresh_window->end,
+												 &next_data) ||
+			pg_mul_s64_overflow(bucket_width, ts_guc_cagg_refresh_window_buckets, &window_width))
+			window.end = refresh_window->end;
+		else
+			window.end = ts_time_saturating_add(Max(next_invalidation, next_data),
+												window_width,
+												refresh_window->type);
+
+		window = compute_circumscribed_bucketed_refresh_window(&window,
+															   bucket_width,
+															   cagg->bucket_function);
+
+		if (window.start < refresh_window->start)
+			window.start = refresh_window->start;
+		if (window.end > refresh_window->end)
+			window.end = refresh_window->end;
+
+		log_refresh_window(DEBUG1, cagg, &window, "refreshing window of");
+
+		if (process_cagg_invalidations_and_refresh(cagg,
+												   &window,
+												   callctx,
+												   INVALID_CHUNK_ID,
+												   refreshed_window))
+		{
+			refreshed = true;
+
+			/* Only notify about refreshing on creation once */
+			if (callctx == CAGG_REFRESH_CREATION)
+				callctx = CAGG_REFRESH_WINDOW;
+		}
+
+		SPI_commit_and_chain();
+		cursor = window.end;
+	}
+
+	return refreshed;
+}
+
+/*
+ * Refresh the continuous aggregates defined on top of a continuous aggregate
+ * in the window that was just materialized.
+ *
+ * Materializing a continuous aggregate invalidates the continuous aggregates
+ * defined on it, but only within the materialized window. Refreshing them
+ * over that window right away, instead of waiting for their own policies,
+ * keeps the upper levels of a hierarchy from lagging behind while only
+ * processing the invalidations caused by this refresh. Invalidations outside
+ * of the window are left to the next refresh of the dependent aggregate.
+ *
+ * Dependent aggregates that are owned by another role are skipped, since a
+ * refresh requires ownership. Each dependent refresh cascades in turn, up to
+ * timescaledb.cagg_refresh_cascade_max_depth levels above the aggregate that
+ * was refreshed first.
+ */
+static void
+continuous_agg_refresh_cascade(int32 mat_id, const InternalTimeRange *refreshed_window)
+{
+	List *caggs;
+	List *dependent_mat_ids = NIL;
+	ListCell *lc;
+
+	if (cascade_depth >= ts_guc_cagg_refresh_cascade_max_depth)
+	{
+		elog(DEBUG1,
+			 "not cascading refresh of materialized hypertable %d beyond depth %d",
+			 mat_id,
+			 cascade_depth);
+		return;
+	}
+
+	caggs = ts_continuous_aggs_find_by_raw_table_id(mat_id);
+
+	foreach (lc, caggs)
+	{
+		ContinuousAgg *cagg = lfirst(lc);
+
+		dependent_mat_ids = lappend_int(dependent_mat_ids, cagg->data.mat_hypertable_id);
+	}
+
+	foreach (lc, dependent_mat_ids)
+	{
+		/* Every refresh commits, so look up the aggregate right before refreshing it */
+		ContinuousAgg *cagg = ts_continuous_agg_find_by_mat_hypertable_id(lfirst_int(lc));
+		InternalTimeRange window;
+
+		if (cagg == NULL)
+			continue;
+
+		if (!pg_class_ownercheck(cagg->relid, GetUserId()))
+		{
+			elog(DEBUG1,
+				 "skipping cascading refresh of continuous aggregate \"%s\" owned by another role",
+				 NameStr(cagg->data.user_view_name));
+			continue;
+		}
+
+		window = compute_circumscribed_bucketed_refresh_window(
+			refreshed_window,
+			ts_continuous_agg_bucket_width_variable(cagg) ? BUCKET_WIDTH_VARIABLE :
+															ts_continuous_agg_bucket_width(cagg),
+			cagg->bucket_function);
+		window.type = cagg->partition_type;
+
+		log_refresh_window(DEBUG1, cagg, &window, "cascading refresh of");
+
+		cascade_depth++;
+		PG_TRY();
+		{
+			continuous_agg_refresh_internal(cagg, &window, CAGG_REFRESH_CASCADE, false, false);
+		}
+		PG_CATCH();
+		{
+			cascade_depth--;
+			PG_RE_THROW();
+		}
+		PG_END_TRY();
+		cascade_depth--;
+	}
+}
+
+static void
+continuous_agg_refresh_run(const ContinuousAgg *cagg, const InternalTimeRange *refresh_window_arg,
+						   const CaggRefreshCallContext callctx, const bool start_isnull,
+						   const bool end_isnull)
 {
 	Catalog *catalog = ts_catalog_get();
 	int32 mat_id = cagg->data.mat_hypertable_id;
 	InternalTimeRange refresh_window = *refresh_window_arg;
+	InternalTimeRange refreshed_window = {
+		.type = refresh_window_arg->type,
+	};
 	int64 computed_invalidation_threshold;
 	int64 invalidation_threshold;
 	bool is_raw_ht_distributed;
-	int rc;
-
-	/* Connect to SPI manager due to the underlying SPI calls */
-	if ((rc = SPI_connect_ext(SPI_OPT_NONATOMIC) != SPI_OK_CONNECT))
-		elog(ERROR, "SPI_connect failed: %s", SPI_result_code_string(rc));
-
-	/* Lock down search_path */
-	rc = SPI_exec("SET LOCAL search_path TO pg_catalog, pg_temp", 0);
-	if (rc < 0)
-		ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR), (errmsg("could not set search_path"))));
-
-	/* Like regular materialized views, require owner to refresh. */
-	if (!pg_class_ownercheck(cagg->relid, GetUserId()))
-		aclcheck_error(ACLCHECK_NOT_OWNER,
-					   get_relkind_objtype(get_rel_relkind(cagg->relid)),
-					   get_rel_name(cagg->relid));
-
-	PreventCommandIfReadOnly(REFRESH_FUNCTION_NAME);
-
-	/* Prevent running refresh if we're in a transaction block since a refresh
-	 * can run two transactions and might take a long time to release locks if
-	 * there's a lot to materialize. Strictly, it is optional to prohibit
-	 * transaction blocks since there will be only one transaction if the
-	 * invalidation threshold needs no update. However, materialization might
-	 * still take a long time and it is probably best for consistency to always
-	 * prevent transaction blocks.  */
-	PreventInTransactionBlock(true, REFRESH_FUNCTION_NAME);
+	bool refresh_in_windows;
+	bool refreshed;
 
 	Hypertable *ht = cagg_get_hypertable_or_fail(cagg->data.raw_hypertable_id);
 	is_raw_ht_distributed = hypertable_is_distributed(ht);
 
+	/* Refreshing in windows requires fixed-size buckets and a raw hypertable
+	 * that can be queried for the time values of the open dimension */
+	refresh_in_windows = ts_guc_cagg_refresh_window_buckets > 0 && !is_raw_ht_distributed &&
+						 !ts_continuous_agg_bucket_width_variable(cagg) &&
+						 hyperspace_get_open_dimension(ht->space, 0)->partitioning == NULL;
+
 	/* No bucketing when open ended */
 	if (!(start_isnull && end_isnull))
 	{
@@ -842,6 +1191,7 @@ continuous_agg_refresh_internal(const ContinuousAgg *cagg,
 	 * serializes around a lock on the materialized hypertable for the
 	 * continuous aggregate that gets refreshed.
 	 */
+	ts_cagg_refresh_stats_set_phase(CAGG_REFRESH_PHASE_INVALIDATION);
 	LockRelationOid(catalog_get_table_id(catalog, CONTINUOUS_AGGS_INVALIDATION_THRESHOLD),
 					AccessExclusiveLock);
 
@@ -869,10 +1219,6 @@ continuous_agg_refresh_internal(const ContinuousAgg *cagg,
 	if (refresh_window.start >= refresh_window.end)
 	{
 		emit_up_to_date_notice(cagg, callctx);
-
-		if ((rc = SPI_finish()) != SPI_OK_FINISH)
-			elog(ERROR, "SPI_finish failed: %s", SPI_result_code_string(rc));
-
 		return;
 	}
 
@@ -899,8 +1245,84 @@ continuous_agg_refresh_internal(const ContinuousAgg *cagg,
 
 	cagg = ts_continuous_agg_find_by_mat_hypertable_id(mat_id);
 
-	if (!process_cagg_invalidations_and_refresh(cagg, &refresh_window, callctx, INVALID_CHUNK_ID))
+	if (refresh_in_windows)
+		refreshed =
+			continuous_agg_refresh_in_windows(mat_id, &refresh_window, callctx, &refreshed_window);
+	else
+		refreshed = process_cagg_invalidations_and_refresh(cagg,
+														   &refresh_window,
+														   callctx,
+														   INVALID_CHUNK_ID,
+														   &refreshed_window);
+
+	if (!refreshed)
+	{
+		/* Refreshing in windows might have committed, so look up the aggregate again */
+		cagg = ts_continuous_agg_find_by_mat_hypertable_id(mat_id);
 		emit_up_to_date_notice(cagg, callctx);
+	}
+	else if (ts_guc_enable_cagg_refresh_cascade &&
+			 refreshed_window.start < refreshed_window.end)
+	{
+		/* Commit the materialization so that the invalidations it caused
+		 * are in the log when refreshing the dependent aggregates */
+		SPI_commit_and_chain();
+		ts_cagg_refresh_stats_set_phase(CAGG_REFRESH_PHASE_CASCADE);
+		continuous_agg_refresh_cascade(mat_id, &refreshed_window);
+	}
+}
+
+void
+continuous_agg_refresh_internal(const ContinuousAgg *cagg,
+								const InternalTimeRange *refresh_window_arg,
+								const CaggRefreshCallContext callctx, const bool start_isnull,
+								const bool end_isnull)
+{
+	CaggRefreshStats stats;
+	int rc;
+
+	/* Connect to SPI manager due to the underlying SPI calls */
+	if ((rc = SPI_connect_ext(SPI_OPT_NONATOMIC) != SPI_OK_CONNECT))
+		elog(ERROR, "SPI_connect failed: %s", SPI_result_code_string(rc));
+
+	/* Lock down search_path */
+	rc = SPI_exec("SET LOCAL search_path TO pg_catalog, pg_temp", 0);
+	if (rc < 0)
+		ereport(ERROR, (errcode(ERRCODE_INTERNAL_ERROR), (errmsg("could not set search_path"))));
+
+	/* Like regular materialized views, require owner to refresh. */
+	if (!pg_class_ownercheck(cagg->relid, GetUserId()))
+		aclcheck_error(ACLCHECK_NOT_OWNER,
+					   get_relkind_objtype(get_rel_relkind(cagg->relid)),
+					   get_rel_name(cagg->relid));
+
+	PreventCommandIfReadOnly(REFRESH_FUNCTION_NAME);
+
+	/* Prevent running refresh if we're in a transaction block since a refresh
+	 * can run two transactions and might take a long time to release locks if
+	 * there's a lot to materialize. Strictly, it is optional to prohibit
+	 * transaction blocks since there will be only one transaction if the
+	 * invalidation threshold needs no update. However, materialization might
+	 * still take a long time and it is probably best for consistency to always
+	 * prevent transaction blocks.  */
+	PreventInTransactionBlock(true, REFRESH_FUNCTION_NAME);
+
+	/* Record the statistics of the refresh, also when it fails, so that
+	 * failing refresh jobs show up */
+	ts_cagg_refresh_stats_begin(&stats, cagg->data.mat_hypertable_id);
+
+	PG_TRY();
+	{
+		continuous_agg_refresh_run(cagg, refresh_window_arg, callctx, start_isnull, end_isnull);
+	}
+	PG_CATCH();
+	{
+		ts_cagg_refresh_stats_end(&stats, true);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+
+	ts_cagg_refresh_stats_end(&stats, false);
 
 	if ((rc = SPI_finish()) != SPI_OK_FINISH)
 		elog(ERROR, "SPI_finish failed: %s", SPI_result_code_string(rc));
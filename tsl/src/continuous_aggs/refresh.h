@@ -19,6 +19,8 @@ typedef enum CaggRefreshCallContext
 	CAGG_REFRESH_WINDOW,
 	CAGG_REFRESH_CHUNK,
 	CAGG_REFRESH_POLICY,
+	/* Refresh of a dependent continuous aggregate after refreshing another */
+	CAGG_REFRESH_CASCADE,
 } CaggRefreshCallContext;
 
 extern Datum continuous_agg_refresh(PG_FUNCTION_ARGS);
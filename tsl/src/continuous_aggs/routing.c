@@ -0,0 +1,778 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+
+/*
+ * Routing of aggregate queries on hypertables to continuous aggregates.
+ *
+ * A query that groups the rows of a hypertable by time_bucket() can be
+ * answered from a real-time continuous aggregate on the hypertable if the
+ * aggregate uses the same bucketing function with a bucket width that
+ * divides the bucket width of the query, and if all grouping columns and
+ * aggregates of the query are columns of the continuous aggregate.
+ *
+ * If the buckets and grouping columns are the same, every row of the
+ * continuous aggregate is a group of the query and the aggregates are read
+ * as they are. Otherwise, the rows of the continuous aggregate are grouped
+ * again, which only works for aggregates that can be computed from their own
+ * results: min(), max(), sum() and count().
+ *
+ * The hypertable in the query is replaced by the query of the continuous
+ * aggregate view, which returns the materialized buckets and aggregates the
+ * raw data after the watermark, as if the view had been referenced in the
+ * query. The hypertable stays in the range table of the query so that the
+ * permissions on the hypertable are still checked.
+ *
+ * Filters on the grouping columns are applied to the columns of the
+ * continuous aggregate. Filters on the time column are only supported if
+ * they compare the time column with constants that are aligned with the
+ * buckets of the continuous aggregate, so that a bucket either matches the
+ * filter entirely or not at all.
+ *
+ * The materialized buckets of the continuous aggregate are only used if they
+ * are up-to-date, i.e., if the invalidation logs have no entries in the time
+ * range of the query before the watermark, and if the current transaction
+ * has not modified the hypertable. Otherwise, the query is answered from the
+ * hypertable.
+ */
+#include <postgres.h>
+#include <access/stratnum.h>
+#include <catalog/pg_aggregate.h>
+#include <catalog/pg_namespace.h>
+#include <catalog/pg_type.h>
+#include <miscadmin.h>
+#include <nodes/makefuncs.h>
+#include <nodes/nodeFuncs.h>
+#include <optimizer/optimizer.h>
+#include <optimizer/tlist.h>
+#include <parser/parse_coerce.h>
+#include <parser/parse_func.h>
+#include <parser/parsetree.h>
+#include <rewrite/rewriteHandler.h>
+#include <rewrite/rewriteManip.h>
+#include <utils/acl.h>
+#include <utils/builtins.h>
+#include <utils/date.h>
+#include <utils/lsyscache.h>
+#include <utils/rel.h>
+#include <utils/typcache.h>
+
+#include "compat/compat.h"
+#include "dimension.h"
+#include "func_cache.h"
+#include "hypertable.h"
+#include "hypertable_cache.h"
+#include "ts_catalog/continuous_agg.h"
+#include "ts_catalog/continuous_aggs_watermark.h"
+#include "time_utils.h"
+#include "utils.h"
+
+#include "insert.h"
+#include "invalidation.h"
+#include "routing.h"
+
+/*
+ * An expression of the continuous aggregate query and the column of the
+ * continuous aggregate view that holds it, if any.
+ */
+typedef struct CaggColumn
+{
+	Node *expr;
+	AttrNumber attno;
+} CaggColumn;
+
+typedef struct CaggRoute
+{
+	ContinuousAgg *cagg;
+	/* Bucketing of the continuous aggregate */
+	Oid bucket_funcid;
+	Const *bucket_width;
+	int64 width;
+	AttrNumber bucket_attno;
+	/* Grouping columns other than the bucket, and aggregates */
+	List *group_columns;
+	List *agg_columns;
+	TupleDesc tupdesc;
+	/* Bucket expression of the routed query */
+	FuncExpr *query_bucket;
+	/* Time range of the routed query, as far as its filters are routed */
+	InternalTimeRange range;
+	/* Range table index of the continuous aggregate in the routed query */
+	Index rti;
+	/* Whether the rows of the continuous aggregate are grouped again */
+	bool regroup;
+	bool failed;
+} CaggRoute;
+
+/*
+ * Get the width of a bucket in the internal time unit, or false if the
+ * width is not fixed.
+ */
+static bool
+bucket_width_to_internal(const Const *width, int64 *result)
+{
+	if (width->consttype == INTERVALOID && DatumGetIntervalP(width->constvalue)->month != 0)
+		return false;
+
+	*result = ts_interval_value_to_internal(width->constvalue, width->consttype);
+
+	return *result > 0;
+}
+
+/*
+ * Check if an expression is a call of time_bucket() with a constant width on
+ * the time column of the hypertable.
+ */
+static FuncExpr *
+get_time_bucket(Node *node, Index rti, AttrNumber time_attno)
+{
+	FuncExpr *func;
+	FuncInfo *finfo;
+	Const *width;
+	Var *var;
+	int64 width_internal;
+
+	if (!IsA(node, FuncExpr))
+		return NULL;
+
+	func = castNode(FuncExpr, node);
+	finfo = ts_func_cache_get_bucketing_func(func->funcid);
+
+	if (finfo == NULL || finfo->origin != ORIGIN_TIMESCALE ||
+		strcmp(finfo->funcname, "time_bucket") != 0 || list_length(func->args) != 2 ||
+		func_volatile(func->funcid) != PROVOLATILE_IMMUTABLE)
+		return NULL;
+
+	if (!IsA(linitial(func->args), Const) || !IsA(lsecond(func->args), Var))
+		return NULL;
+
+	width = linitial_node(Const, func->args);
+	var = lsecond_node(Var, func->args);
+
+	if (width->constisnull || var->varno != rti || var->varattno != time_attno ||
+		var->varlevelsup != 0 || !bucket_width_to_internal(width, &width_internal))
+		return NULL;
+
+	return func;
+}
+
+static bool
+exprs_contain(List *exprs, Node *expr)
+{
+	ListCell *lc;
+
+	foreach (lc, exprs)
+	{
+		if (equal(lfirst(lc), expr))
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * Read the columns of a continuous aggregate from the query of its direct
+ * view, with the hypertable at the given range table index.
+ */
+static bool
+cagg_route_init(CaggRoute *route, ContinuousAgg *cagg, const Hypertable *ht, Index ht_rti,
+				AttrNumber time_attno)
+{
+	Query *query = ts_continuous_agg_get_query(cagg);
+	RangeTblRef *rtr;
+	RangeTblEntry *rte;
+	Relation view_rel;
+	AttrNumber attno = 0;
+	ListCell *lc;
+
+	MemSet(route, 0, sizeof(CaggRoute));
+	route->cagg = cagg;
+
+	if (query->commandType != CMD_SELECT || query->groupClause == NIL ||
+		query->groupingSets != NIL || query->havingQual != NULL || query->hasSubLinks ||
+		query->hasWindowFuncs || query->hasTargetSRFs || query->cteList != NIL ||
+		query->setOperations != NULL || query->distinctClause != NIL ||
+		query->jointree->quals != NULL || list_length(query->jointree->fromlist) != 1 ||
+		!IsA(linitial(query->jointree->fromlist), RangeTblRef))
+		return false;
+
+	rtr = linitial_node(RangeTblRef, query->jointree->fromlist);
+	rte = rt_fetch(rtr->rtindex, query->rtable);
+
+	if (rte->rtekind != RTE_RELATION || rte->relid != ht->main_table_relid)
+		return false;
+
+	/* Make the expressions comparable to the ones of the routed query */
+	ChangeVarNodes((Node *) query->targetList, rtr->rtindex, ht_rti, 0);
+
+	foreach (lc, query->targetList)
+	{
+		TargetEntry *tle = lfirst_node(TargetEntry, lc);
+		CaggColumn *column = palloc(sizeof(CaggColumn));
+		FuncExpr *bucket;
+
+		column->expr = (Node *) tle->expr;
+		column->attno = tle->resjunk ? InvalidAttrNumber : ++attno;
+
+		if (get_sortgroupref_clause_noerr(tle->ressortgroupref, query->groupClause) == NULL)
+		{
+			if (IsA(tle->expr, Aggref) && !tle->resjunk)
+				route->agg_columns = lappend(route->agg_columns, column);
+
+			continue;
+		}
+
+		bucket = get_time_bucket((Node *) tle->expr, ht_rti, time_attno);
+
+		if (bucket != NULL && !tle->resjunk && route->bucket_attno == InvalidAttrNumber)
+		{
+			route->bucket_funcid = bucket->funcid;
+			route->bucket_width = linitial_node(Const, bucket->args);
+			bucket_width_to_internal(route->bucket_width, &route->width);
+			route->bucket_attno = column->attno;
+		}
+		else
+			route->group_columns = lappend(route->group_columns, column);
+	}
+
+	if (route->bucket_attno == InvalidAttrNumber)
+		return false;
+
+	/* The columns of the view must match the query of the direct view */
+	view_rel = relation_open(cagg->relid, AccessShareLock);
+	route->tupdesc = CreateTupleDescCopy(RelationGetDescr(view_rel));
+	relation_close(view_rel, NoLock);
+
+	if (route->tupdesc->natts != attno)
+		return false;
+
+	foreach (lc, query->targetList)
+	{
+		TargetEntry *tle = lfirst_node(TargetEntry, lc);
+
+		if (!tle->resjunk &&
+			TupleDescAttr(route->tupdesc, AttrNumberGetAttrOffset(tle->resno))->atttypid !=
+				exprType((Node *) tle->expr))
+			return false;
+	}
+
+	return true;
+}
+
+static Var *
+make_column_var(const CaggRoute *route, AttrNumber attno)
+{
+	Form_pg_attribute attr = TupleDescAttr(route->tupdesc, AttrNumberGetAttrOffset(attno));
+
+	return makeVar(route->rti, attno, attr->atttypid, attr->atttypmod, attr->attcollation, 0);
+}
+
+/*
+ * Aggregate the results of an aggregate over the rows of a group of the
+ * continuous aggregate.
+ */
+static Node *
+make_reaggregate(const Aggref *aggref, Var *var)
+{
+	const char *name = get_func_name(aggref->aggfnoid);
+	Oid argtype = var->vartype;
+	Aggref *reagg;
+	Node *result;
+	Oid funcid;
+	Oid rettype;
+
+	if (get_func_namespace(aggref->aggfnoid) != PG_CATALOG_NAMESPACE)
+		return NULL;
+
+	if (strcmp(name, "count") == 0 || strcmp(name, "sum") == 0)
+	{
+		if (aggref->aggdistinct != NIL)
+			return NULL;
+
+		/* Counts are added up */
+		name = "sum";
+	}
+	else if (strcmp(name, "min") != 0 && strcmp(name, "max") != 0)
+		return NULL;
+
+	funcid = LookupFuncName(list_make2(makeString("pg_catalog"), makeString(name)),
+							1,
+							&argtype,
+							true);
+
+	if (!OidIsValid(funcid))
+		return NULL;
+
+	rettype = get_func_rettype(funcid);
+
+	/* min() and max() return the type of their argument */
+	if (IsPolymorphicType(rettype))
+		rettype = argtype;
+
+	reagg = makeNode(Aggref);
+	reagg->aggfnoid = funcid;
+	reagg->aggtype = rettype;
+	reagg->aggcollid = aggref->aggcollid;
+	reagg->inputcollid = var->varcollid;
+	reagg->aggargtypes = list_make1_oid(argtype);
+	reagg->args = list_make1(makeTargetEntry((Expr *) var, 1, NULL, false));
+	reagg->aggkind = AGGKIND_NORMAL;
+	reagg->aggsplit = AGGSPLIT_SIMPLE;
+	reagg->location = -1;
+
+	/* E.g., the sum of counts is numeric */
+	result = coerce_to_target_type(NULL,
+								   (Node *) reagg,
+								   rettype,
+								   aggref->aggtype,
+								   exprTypmod((Node *) aggref),
+								   COERCION_EXPLICIT,
+								   COERCE_IMPLICIT_CAST,
+								   -1);
+
+	return result;
+}
+
+static Node *
+route_aggref(Aggref *aggref, CaggRoute *route)
+{
+	ListCell *lc;
+
+	foreach (lc, route->agg_columns)
+	{
+		CaggColumn *column = lfirst(lc);
+		Var *var;
+		Node *result;
+
+		if (!equal(aggref, column->expr))
+			continue;
+
+		var = make_column_var(route, column->attno);
+
+		if (!route->regroup)
+			return (Node *) var;
+
+		result = make_reaggregate(aggref, var);
+
+		if (result != NULL)
+			return result;
+
+		break;
+	}
+
+	route->failed = true;
+
+	return (Node *) aggref;
+}
+
+/*
+ * Replace the grouping expressions and aggregates of the routed query with
+ * the columns of the continuous aggregate.
+ */
+static Node *
+route_mutator(Node *node, CaggRoute *route)
+{
+	ListCell *lc;
+
+	if (node == NULL || route->failed)
+		return node;
+
+	if (IsA(node, Aggref))
+		return route_aggref(castNode(Aggref, node), route);
+
+	if (equal(node, route->query_bucket))
+	{
+		Var *var = make_column_var(route, route->bucket_attno);
+		FuncExpr *bucket;
+
+		if (!route->regroup)
+			return (Node *) var;
+
+		bucket = copyObject(route->query_bucket);
+		lsecond(bucket->args) = var;
+
+		return (Node *) bucket;
+	}
+
+	foreach (lc, route->group_columns)
+	{
+		CaggColumn *column = lfirst(lc);
+
+		if (column->attno != InvalidAttrNumber && equal(node, column->expr))
+			return (Node *) make_column_var(route, column->attno);
+	}
+
+	/* Any other column of the hypertable is not available */
+	if (IsA(node, Var))
+	{
+		route->failed = true;
+		return node;
+	}
+
+	return expression_tree_mutator(node, route_mutator, route);
+}
+
+static bool
+time_value_is_finite(Datum value, Oid type)
+{
+	switch (type)
+	{
+		case DATEOID:
+			return !DATE_NOT_FINITE(DatumGetDateADT(value));
+		case TIMESTAMPOID:
+		case TIMESTAMPTZOID:
+			return !TIMESTAMP_NOT_FINITE(DatumGetTimestamp(value));
+		default:
+			return true;
+	}
+}
+
+/*
+ * Route a filter that compares the time column with a constant aligned with
+ * the buckets of the continuous aggregate. Rows of a bucket are at or after
+ * the start of the bucket and before the start of the next bucket, so such
+ * filters can be applied to the bucket instead.
+ */
+static Node *
+route_time_qual(Node *qual, CaggRoute *route, AttrNumber time_attno)
+{
+	OpExpr *op;
+	Var *var;
+	Const *value;
+	Oid opno;
+	TypeCacheEntry *tce;
+	int strategy;
+	Datum bucketed;
+	int64 internal;
+
+	if (!IsA(qual, OpExpr) || list_length(castNode(OpExpr, qual)->args) != 2)
+		return NULL;
+
+	op = castNode(OpExpr, qual);
+	opno = op->opno;
+
+	if (IsA(linitial(op->args), Var) && IsA(lsecond(op->args), Const))
+	{
+		var = linitial_node(Var, op->args);
+		value = lsecond_node(Const, op->args);
+	}
+	else if (IsA(linitial(op->args), Const) && IsA(lsecond(op->args), Var))
+	{
+		value = linitial_node(Const, op->args);
+		var = lsecond_node(Var, op->args);
+		opno = get_commutator(op->opno);
+	}
+	else
+		return NULL;
+
+	if (var->varno != lsecond_node(Var, route->query_bucket->args)->varno ||
+		var->varattno != time_attno || var->varlevelsup != 0 || !OidIsValid(opno) ||
+		value->constisnull || value->consttype != var->vartype ||
+		!time_value_is_finite(value->constvalue, value->consttype))
+		return NULL;
+
+	tce = lookup_type_cache(var->vartype, TYPECACHE_BTREE_OPFAMILY);
+	strategy = get_op_opfamily_strategy(opno, tce->btree_opf);
+
+	if (strategy != BTGreaterEqualStrategyNumber && strategy != BTLessStrategyNumber)
+		return NULL;
+
+	bucketed =
+		OidFunctionCall2(route->bucket_funcid, route->bucket_width->constvalue, value->constvalue);
+
+	internal = ts_time_value_to_internal(value->constvalue, value->consttype);
+
+	if (ts_time_value_to_internal(bucketed, value->consttype) != internal)
+		return NULL;
+
+	if (strategy == BTGreaterEqualStrategyNumber)
+		route->range.start = Max(route->range.start, internal);
+	else
+		route->range.end = Min(route->range.end, internal);
+
+	op = copyObject(op);
+	op->opno = opno;
+	op->opfuncid = InvalidOid;
+	op->args = list_make2(make_column_var(route, route->bucket_attno), copyObject(value));
+	set_opfuncid(op);
+
+	return (Node *) op;
+}
+
+static Node *
+route_quals(Node *quals, CaggRoute *route, AttrNumber time_attno)
+{
+	List *routed = NIL;
+	ListCell *lc;
+
+	if (quals == NULL)
+		return NULL;
+
+	foreach (lc, make_ands_implicit((Expr *) quals))
+	{
+		Node *qual = lfirst(lc);
+		Node *result = route_time_qual(qual, route, time_attno);
+
+		if (result == NULL)
+			result = route_mutator(qual, route);
+
+		routed = lappend(routed, result);
+	}
+
+	return (Node *) make_ands_explicit(routed);
+}
+
+/*
+ * Check that the materialized buckets of a continuous aggregate are
+ * up-to-date in the time range of the routed query. Buckets after the
+ * watermark are aggregated from the hypertable by the continuous aggregate
+ * view.
+ */
+static bool
+cagg_route_is_up_to_date(const CaggRoute *route, Cache *hcache)
+{
+	Hypertable *mat_ht = ts_hypertable_cache_get_entry_by_id(hcache,
+															  route->cagg->data.mat_hypertable_id);
+	InternalTimeRange range = route->range;
+
+	if (mat_ht == NULL)
+		return false;
+
+	/* A refresh without a start leaves the invalidation of the values
+	 * before the first bucket that fits the time type in the log. There is
+	 * no data there. */
+	range.start =
+		Max(range.start,
+			ts_time_saturating_add(ts_time_get_min(range.type), route->width - 1, range.type));
+	range.end = Min(range.end, ts_cagg_watermark_get(mat_ht));
+
+	if (range.start >= range.end)
+		return true;
+
+	return !invalidation_logs_overlap(route->cagg->data.mat_hypertable_id,
+									  route->cagg->data.raw_hypertable_id,
+									  &range);
+}
+
+/*
+ * Replace the hypertable in the routed query with the query of the
+ * continuous aggregate view, in the same way as the rewriter expands views.
+ */
+static void
+replace_with_cagg(Query *query, RangeTblRef *rtr, const CaggRoute *route)
+{
+	RangeTblEntry *rte = rt_fetch(rtr->rtindex, query->rtable);
+	RangeTblEntry *subrte = makeNode(RangeTblEntry);
+	RangeTblEntry *view_rte;
+	Relation view_rel;
+	Query *subquery;
+	List *colnames = NIL;
+	int i;
+
+	view_rel = relation_open(route->cagg->relid, AccessShareLock);
+	subquery = copyObject(get_view_query(view_rel));
+	AcquireRewriteLocks(subquery, true, false);
+
+	/* Check the permissions on the view at execution */
+	view_rte = rt_fetch(PRS2_OLD_VARNO, subquery->rtable);
+	Assert(view_rte->relid == route->cagg->relid);
+	view_rte->requiredPerms = ACL_SELECT;
+	view_rte->checkAsUser = rte->checkAsUser;
+
+	for (i = 0; i < route->tupdesc->natts; i++)
+		colnames = lappend(colnames,
+						   makeString(pstrdup(NameStr(TupleDescAttr(route->tupdesc, i)->attname))));
+
+	subrte->rtekind = RTE_SUBQUERY;
+	subrte->subquery = subquery;
+	subrte->security_barrier = RelationIsSecurityView(view_rel);
+	subrte->eref = makeAlias(RelationGetRelationName(view_rel), colnames);
+	subrte->inh = false;
+	subrte->inFromCl = true;
+	relation_close(view_rel, NoLock);
+
+	query->rtable = lappend(query->rtable, subrte);
+	Assert(list_length(query->rtable) == (int) route->rti);
+	rtr->rtindex = route->rti;
+
+	/* The hypertable is only kept for permission checks */
+	rte->inh = false;
+}
+
+/*
+ * Get the bucket expression among the grouping expressions of a query.
+ */
+static FuncExpr *
+get_query_bucket(List *group_exprs, Index rti, AttrNumber time_attno)
+{
+	FuncExpr *result = NULL;
+	ListCell *lc;
+
+	foreach (lc, group_exprs)
+	{
+		FuncExpr *bucket = get_time_bucket(lfirst(lc), rti, time_attno);
+
+		if (bucket == NULL)
+			continue;
+
+		/* Grouping by several buckets is not supported */
+		if (result != NULL && !equal(result, bucket))
+			return NULL;
+
+		result = bucket;
+	}
+
+	return result;
+}
+
+/*
+ * Try to route an aggregate query on a hypertable to a continuous aggregate.
+ *
+ * The query is modified in place if it can be answered by a continuous
+ * aggregate. If several continuous aggregates can answer the query, the one
+ * with the largest buckets is used.
+ */
+bool
+continuous_agg_route_query(Query *query)
+{
+	Cache *hcache;
+	Hypertable *ht;
+	RangeTblRef *rtr;
+	RangeTblEntry *rte;
+	const Dimension *time_dim;
+	List *group_exprs = NIL;
+	FuncExpr *query_bucket;
+	int64 query_width;
+	CaggRoute best = { 0 };
+	List *best_tlist = NIL;
+	Node *best_quals = NULL;
+	Node *best_having = NULL;
+	ListCell *lc;
+
+	if (query->commandType != CMD_SELECT || !query->hasAggs || query->groupClause == NIL ||
+		query->groupingSets != NIL || query->hasWindowFuncs || query->hasTargetSRFs ||
+		query->hasSubLinks || query->hasRecursive || query->hasModifyingCTE ||
+		query->hasForUpdate || query->hasRowSecurity || query->cteList != NIL ||
+		query->rowMarks != NIL || query->setOperations != NULL || query->utilityStmt != NULL ||
+		list_length(query->jointree->fromlist) != 1 ||
+		!IsA(linitial(query->jointree->fromlist), RangeTblRef) ||
+		contain_volatile_functions(query->jointree->quals))
+		return false;
+
+	rtr = linitial_node(RangeTblRef, query->jointree->fromlist);
+	rte = rt_fetch(rtr->rtindex, query->rtable);
+
+	if (rte->rtekind != RTE_RELATION || !rte->inh || rte->tablesample != NULL)
+		return false;
+
+	hcache = ts_hypertable_cache_pin();
+	ht = ts_hypertable_cache_get_entry(hcache, rte->relid, CACHE_FLAG_MISSING_OK);
+
+	/* Modifications of the current transaction are not in the invalidation
+	 * logs yet */
+	if (ht == NULL || hypertable_is_distributed(ht) ||
+		(time_dim = hyperspace_get_open_dimension(ht->space, 0)) == NULL ||
+		continuous_agg_hypertable_modified_in_xact(ht->fd.id))
+	{
+		ts_cache_release(hcache);
+		return false;
+	}
+
+	foreach (lc, query->groupClause)
+	{
+		SortGroupClause *sgc = lfirst_node(SortGroupClause, lc);
+
+		group_exprs = lappend(group_exprs, get_sortgroupclause_expr(sgc, query->targetList));
+	}
+
+	query_bucket = get_query_bucket(group_exprs, rtr->rtindex, time_dim->column_attno);
+
+	if (query_bucket == NULL)
+	{
+		ts_cache_release(hcache);
+		return false;
+	}
+
+	bucket_width_to_internal(linitial_node(Const, query_bucket->args), &query_width);
+
+	foreach (lc, ts_continuous_aggs_find_by_raw_table_id(ht->fd.id))
+	{
+		ContinuousAgg *cagg = lfirst(lc);
+		CaggRoute route;
+		List *tlist;
+		Node *quals;
+		Node *having;
+		ListCell *lc_column;
+
+		/* Only real-time aggregates return the same result as the query */
+		if (!ContinuousAggIsFinalized(cagg) || cagg->data.materialized_only ||
+			ContinuousAggIsHierarchical(cagg) || ts_continuous_agg_bucket_width_variable(cagg) ||
+			pg_class_aclcheck(cagg->relid, GetUserId(), ACL_SELECT) != ACLCHECK_OK)
+			continue;
+
+		if (!cagg_route_init(&route, cagg, ht, rtr->rtindex, time_dim->column_attno) ||
+			route.bucket_funcid != query_bucket->funcid || query_width % route.width != 0 ||
+			route.width <= best.width)
+			continue;
+
+		route.query_bucket = query_bucket;
+		route.range.type = ts_dimension_get_partition_type(time_dim);
+		route.range.start = PG_INT64_MIN;
+		route.range.end = PG_INT64_MAX;
+		route.rti = list_length(query->rtable) + 1;
+		route.regroup = route.width != query_width;
+
+		/* Rows of the continuous aggregate are groups of the query if it
+		 * groups by all grouping columns of the continuous aggregate */
+		foreach (lc_column, route.group_columns)
+		{
+			CaggColumn *column = lfirst(lc_column);
+
+			if (!exprs_contain(group_exprs, column->expr))
+				route.regroup = true;
+		}
+
+		tlist = (List *) route_mutator((Node *) copyObject(query->targetList), &route);
+		quals = route_quals(copyObject(query->jointree->quals), &route, time_dim->column_attno);
+		having = route_mutator(copyObject(query->havingQual), &route);
+
+		if (route.failed || !cagg_route_is_up_to_date(&route, hcache))
+			continue;
+
+		best = route;
+		best_tlist = tlist;
+		best_quals = quals;
+		best_having = having;
+	}
+
+	ts_cache_release(hcache);
+
+	if (best.cagg == NULL)
+		return false;
+
+	elog(DEBUG1,
+		 "routing query on \"%s\" to continuous aggregate \"%s\"",
+		 get_rel_name(rte->relid),
+		 NameStr(best.cagg->data.user_view_name));
+
+	replace_with_cagg(query, rtr, &best);
+	query->targetList = best_tlist;
+
+	if (best.regroup)
+	{
+		query->jointree->quals = best_quals;
+		query->havingQual = best_having;
+	}
+	else
+	{
+		/* Every row of the continuous aggregate is a group */
+		query->jointree->quals = make_and_qual(best_quals, best_having);
+		query->havingQual = NULL;
+		query->groupClause = NIL;
+		query->hasAggs = false;
+	}
+
+	return true;
+}
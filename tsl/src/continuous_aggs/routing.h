@@ -0,0 +1,14 @@
+/*
+ * This file and its contents are licensed under the Timescale License.
+ * Please see the included NOTICE for copyright information and
+ * LICENSE-TIMESCALE for a copy of the license.
+ */
+#ifndef TIMESCALEDB_TSL_CONTINUOUS_AGGS_ROUTING_H
+#define TIMESCALEDB_TSL_CONTINUOUS_AGGS_ROUTING_H
+
+#include <postgres.h>
+#include <nodes/parsenodes.h>
+
+extern bool continuous_agg_route_query(Query *query);
+
+#endif /* TIMESCALEDB_TSL_CONTINUOUS_AGGS_ROUTING_H */
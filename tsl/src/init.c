@@ -12,7 +12,9 @@
 #include "bgw_policy/retention_api.h"
 #include "bgw_policy/job.h"
 #include "bgw_policy/job_api.h"
+#include "bgw_policy/chunk_precreation_api.h"
 #include "bgw_policy/reorder_api.h"
+#include "bgw_policy/staging_api.h"
 #include "bgw_policy/policies_v2.h"
 #include "chunk.h"
 #include "chunk_api.h"
@@ -31,6 +33,7 @@
 #include "continuous_aggs/refresh.h"
 #include "continuous_aggs/invalidation.h"
 #include "continuous_aggs/repair.h"
+#include "continuous_aggs/routing.h"
 #include "cross_module_fn.h"
 #include "nodes/data_node_dispatch.h"
 #include "data_node.h"
@@ -97,6 +100,10 @@ CrossModuleFunctions tsl_cm_functions = {
 	.set_rel_pathlist_query = tsl_set_rel_pathlist_query,
 
 	/* bgw policies */
+	.policy_chunk_precreation_add = policy_chunk_precreation_add,
+	.policy_chunk_precreation_proc = policy_chunk_precreation_proc,
+	.policy_chunk_precreation_check = policy_chunk_precreation_check,
+	.policy_chunk_precreation_remove = policy_chunk_precreation_remove,
 	.policy_compression_add = policy_compression_add,
 	.policy_compression_remove = policy_compression_remove,
 	.policy_recompression_proc = policy_recompression_proc,
@@ -113,6 +120,10 @@ CrossModuleFunctions tsl_cm_functions = {
 	.policy_retention_proc = policy_retention_proc,
 	.policy_retention_check = policy_retention_check,
 	.policy_retention_remove = policy_retention_remove,
+	.policy_staging_add = policy_staging_add,
+	.policy_staging_proc = policy_staging_proc,
+	.policy_staging_check = policy_staging_check,
+	.policy_staging_remove = policy_staging_remove,
 
 	.job_add = job_add,
 	.job_alter = job_alter,
@@ -151,10 +162,12 @@ CrossModuleFunctions tsl_cm_functions = {
 	.process_cagg_viewstmt = tsl_process_continuous_agg_viewstmt,
 	.continuous_agg_invalidation_trigger = continuous_agg_trigfn,
 	.continuous_agg_call_invalidation_trigger = execute_cagg_trigger,
+	.continuous_agg_invalidate_inserted_range = continuous_agg_invalidate_inserted_range,
 	.continuous_agg_refresh = continuous_agg_refresh,
 	.continuous_agg_invalidate_raw_ht = continuous_agg_invalidate_raw_ht,
 	.continuous_agg_invalidate_mat_ht = continuous_agg_invalidate_mat_ht,
 	.continuous_agg_update_options = continuous_agg_update_options,
+	.continuous_agg_route_query = continuous_agg_route_query,
 	.invalidation_cagg_log_add_entry = tsl_invalidation_cagg_log_add_entry,
 	.invalidation_hyper_log_add_entry = tsl_invalidation_hyper_log_add_entry,
 	.remote_invalidation_log_delete = remote_invalidation_log_delete,
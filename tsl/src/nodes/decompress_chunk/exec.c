@@ -128,6 +128,9 @@ decompress_chunk_state_create(CustomScan *cscan)
 	List *sortinfo = lfourth(cscan->custom_private);
 	build_batch_sorted_merge_info(chunk_state, sortinfo);
 
+	chunk_state->batch_quals = cscan->custom_exprs;
+	chunk_state->batch_qual_indexes = list_nth(cscan->custom_private, 4);
+
 	/* Sort keys should only be present when sorted_merge_append is used */
 	Assert(chunk_state->sorted_merge_append == true || chunk_state->n_sortkeys == 0);
 	Assert(chunk_state->n_sortkeys == 0 || chunk_state->sortkeys != NULL);
@@ -439,9 +442,55 @@ decompress_chunk_begin(CustomScanState *node, EState *estate, int eflags)
 		}
 	}
 
+	/*
+	 * Build the filter to use for the batches where the batch quals hold,
+	 * which consists of the remaining filters.
+	 */
+	if (state->batch_quals != NIL)
+	{
+		List *reduced_qual = NIL;
+		ListCell *lc;
+		int index = 0;
+
+		foreach (lc, cscan->scan.plan.qual)
+		{
+			if (!list_member_int(state->batch_qual_indexes, index++))
+				reduced_qual = lappend(reduced_qual, lfirst(lc));
+		}
+
+		state->batch_qual = ExecInitQual(state->batch_quals, ps);
+		state->reduced_qual = ExecInitQual(reduced_qual, ps);
+	}
+
 	node->custom_ps = lappend(node->custom_ps, ExecInitNode(compressed_scan, estate, eflags));
 }
 
+/*
+ * Choose the filter to apply to the tuples of a batch, based on the metadata
+ * of the batch.
+ */
+static ExprState *
+decompress_batch_get_qual(DecompressChunkState *chunk_state, TupleTableSlot *compressed_slot)
+{
+	ExprContext *econtext = chunk_state->csstate.ss.ps.ps_ExprContext;
+	bool batch_qual_holds;
+
+	if (chunk_state->batch_qual == NULL)
+		return chunk_state->csstate.ss.ps.qual;
+
+	/* The batch quals refer to the metadata columns of the compressed tuple */
+	econtext->ecxt_scantuple = compressed_slot;
+	batch_qual_holds = ExecQual(chunk_state->batch_qual, econtext);
+	econtext->ecxt_scantuple = NULL;
+
+	if (!batch_qual_holds)
+		return chunk_state->csstate.ss.ps.qual;
+
+	chunk_state->batches_without_qual++;
+
+	return chunk_state->reduced_qual;
+}
+
 /*
  * Convert Arrow array to an array of Postgres Datum's.
  */
@@ -544,6 +593,8 @@ decompress_initialize_batch(DecompressChunkState *chunk_state, DecompressBatchSt
 	ExecCopySlot(batch_state->compressed_slot, subslot);
 	Assert(!TupIsNull(batch_state->compressed_slot));
 
+	batch_state->qual = decompress_batch_get_qual(chunk_state, batch_state->compressed_slot);
+
 	/* DecompressBatchState can be re-used. The expensive TupleTableSlot are created on demand as
 	 * soon as this state is used for the first time.
 	 */
@@ -768,7 +819,7 @@ decompress_initialize_batch(DecompressChunkState *chunk_state, DecompressBatchSt
 
 /* Perform the projection and selection of the decompressed tuple */
 static bool pg_nodiscard
-decompress_chunk_perform_select_project(CustomScanState *node,
+decompress_chunk_perform_select_project(CustomScanState *node, ExprState *qual,
 										TupleTableSlot *decompressed_slot_scan,
 										TupleTableSlot *decompressed_slot_projected)
 {
@@ -784,7 +835,7 @@ decompress_chunk_perform_select_project(CustomScanState *node,
 	econtext->ecxt_scantuple = decompressed_slot_scan;
 	ResetExprContext(econtext);
 
-	if (node->ss.ps.qual && !ExecQual(node->ss.ps.qual, econtext))
+	if (qual && !ExecQual(qual, econtext))
 	{
 		InstrCountFiltered1(node, 1);
 		return false;
@@ -918,6 +969,14 @@ decompress_chunk_explain(CustomScanState *node, List *ancestors, ExplainState *e
 		{
 			ExplainPropertyBool("Bulk Decompression", chunk_state->using_bulk_decompression, es);
 		}
+
+		if (es->analyze && chunk_state->batch_qual != NULL)
+		{
+			ExplainPropertyInteger("Batches Without Row Filter",
+								   NULL,
+								   chunk_state->batches_without_qual,
+								   es);
+		}
 	}
 }
 
@@ -1021,6 +1080,7 @@ decompress_get_next_tuple_from_batch(DecompressChunkState *chunk_state,
 
 		/* Perform selection and projection if needed */
 		bool is_valid_tuple = decompress_chunk_perform_select_project(&chunk_state->csstate,
+																	  batch_state->qual,
 																	  decompressed_slot_scan,
 																	  decompressed_slot_projected);
 
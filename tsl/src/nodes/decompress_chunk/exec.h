@@ -85,6 +85,7 @@ typedef struct DecompressBatchState
 	int current_batch_row;
 	MemoryContext per_batch_context;
 	MemoryContext arrow_context;
+	ExprState *qual; /* The filter to apply to the tuples of the batch */
 } DecompressBatchState;
 
 typedef struct DecompressChunkState
@@ -111,6 +112,17 @@ typedef struct DecompressChunkState
 
 	bool using_bulk_decompression; /* For EXPLAIN ANALYZE. */
 
+	/*
+	 * Conditions on the metadata of a batch that imply the filters at the
+	 * given positions for all rows of the batch. For such batches, the
+	 * reduced filter is applied instead of the full one.
+	 */
+	List *batch_quals;
+	List *batch_qual_indexes;
+	ExprState *batch_qual;
+	ExprState *reduced_qual;
+	int64 batches_without_qual; /* For EXPLAIN ANALYZE. */
+
 	/*
 	 * Make non-refcounted copies of the tupdesc for reuse across all batch states
 	 * and avoid spending CPU in ResourceOwner when creating a big number of table
@@ -5,7 +5,10 @@
  */
 
 #include <postgres.h>
+#include <access/htup_details.h>
+#include <access/stratnum.h>
 #include <access/sysattr.h>
+#include <catalog/pg_attribute.h>
 #include <catalog/pg_namespace.h>
 #include <catalog/pg_operator.h>
 #include <nodes/bitmapset.h>
@@ -19,6 +22,8 @@
 #include <optimizer/tlist.h>
 #include <parser/parsetree.h>
 #include <utils/builtins.h>
+#include <utils/lsyscache.h>
+#include <utils/syscache.h>
 #include <utils/typcache.h>
 
 #include "compression/compression.h"
@@ -336,6 +341,149 @@ clause_has_compressed_attrs(Node *node, void *context)
 	return expression_tree_walker(node, clause_has_compressed_attrs, context);
 }
 
+static bool
+column_is_not_null(Oid relid, AttrNumber attno)
+{
+	HeapTuple tuple = SearchSysCache2(ATTNUM, ObjectIdGetDatum(relid), Int16GetDatum(attno));
+	bool result = false;
+
+	if (HeapTupleIsValid(tuple))
+	{
+		result = ((Form_pg_attribute) GETSTRUCT(tuple))->attnotnull;
+		ReleaseSysCache(tuple);
+	}
+
+	return result;
+}
+
+/*
+ * Replace the column reference of a batch qual with a reference to one of
+ * the metadata columns of the compressed relation.
+ */
+static Expr *
+make_batch_qual(OpExpr *opexpr, int var_arg, Index compressed_relid, AttrNumber metadata_attno)
+{
+	OpExpr *batch_qual = copyObject(opexpr);
+	Var *var = list_nth_node(Var, batch_qual->args, var_arg);
+
+	var->varno = compressed_relid;
+	var->varattno = metadata_attno;
+	var->varlevelsup = 0;
+#if PG13_GE
+	var->varnosyn = var->varno;
+	var->varattnosyn = var->varattno;
+#else
+	var->varnoold = var->varno;
+	var->varoattno = var->varattno;
+#endif
+
+	return (Expr *) batch_qual;
+}
+
+/*
+ * Find the decompression filters that can be checked once per batch.
+ *
+ * A filter of the form "column op constant" where the column is an orderby
+ * column and op is a btree comparison operator holds for every row of a batch
+ * if it holds for both the min and the max value of the column in the batch,
+ * since the set of values satisfying such a filter is an interval. This is
+ * the common case when refreshing a continuous aggregate, where most batches
+ * are completely inside the refresh window, so DecompressChunk does not have
+ * to evaluate the filter row by row for these batches.
+ *
+ * Batches that cannot contain any matching row are not handled here, since
+ * the same filters are pushed down to the compressed scan as conditions on
+ * the metadata columns, which already removes such batches.
+ *
+ * The column must be NOT NULL, because the metadata does not tell whether a
+ * batch contains NULL values. Returns the conditions on the metadata columns
+ * that are checked per batch, and sets batch_qual_indexes to the positions of
+ * the filters they replace.
+ */
+static List *
+build_batch_quals(CompressionInfo *info, List *quals, List **batch_qual_indexes)
+{
+	List *batch_quals = NIL;
+	ListCell *lc;
+	int index = 0;
+
+	*batch_qual_indexes = NIL;
+
+	if (contain_subplans((Node *) quals))
+		return NIL;
+
+	foreach (lc, quals)
+	{
+		Node *qual = lfirst(lc);
+		OpExpr *opexpr;
+		Var *var;
+		Node *other;
+		int var_arg;
+		TypeCacheEntry *tce;
+		int strategy;
+
+		index++;
+
+		if (!IsA(qual, OpExpr) || list_length(castNode(OpExpr, qual)->args) != 2)
+			continue;
+
+		opexpr = castNode(OpExpr, qual);
+
+		if (IsA(linitial(opexpr->args), Var))
+		{
+			var = linitial(opexpr->args);
+			other = lsecond(opexpr->args);
+			var_arg = 0;
+		}
+		else if (IsA(lsecond(opexpr->args), Var))
+		{
+			var = lsecond(opexpr->args);
+			other = linitial(opexpr->args);
+			var_arg = 1;
+		}
+		else
+			continue;
+
+		if ((Index) var->varno != info->chunk_rel->relid || var->varattno <= 0 ||
+			!IsA(other, Const) || castNode(Const, other)->constisnull)
+			continue;
+
+		if (var->varcollid != opexpr->inputcollid || !op_strict(opexpr->opno))
+			continue;
+
+		tce = lookup_type_cache(var->vartype, TYPECACHE_BTREE_OPFAMILY);
+		strategy = get_op_opfamily_strategy(opexpr->opno, tce->btree_opf);
+		if (strategy == InvalidStrategy)
+			continue;
+
+		char *column_name = get_attname(info->chunk_rte->relid, var->varattno, false);
+		FormData_hypertable_compression *ci =
+			get_column_compressioninfo(info->hypertable_compression_info, column_name);
+
+		if (ci->orderby_column_index <= 0 ||
+			!column_is_not_null(info->chunk_rte->relid, var->varattno))
+			continue;
+
+		AttrNumber min_attno =
+			get_attnum(info->compressed_rte->relid, compression_column_segment_min_name(ci));
+		AttrNumber max_attno =
+			get_attnum(info->compressed_rte->relid, compression_column_segment_max_name(ci));
+
+		if (min_attno == InvalidAttrNumber || max_attno == InvalidAttrNumber)
+			continue;
+
+		Index compressed_relid = info->compressed_rel->relid;
+
+		batch_quals =
+			lappend(batch_quals, make_batch_qual(opexpr, var_arg, compressed_relid, min_attno));
+		batch_quals =
+			lappend(batch_quals, make_batch_qual(opexpr, var_arg, compressed_relid, max_attno));
+		*batch_qual_indexes = lappend_int(*batch_qual_indexes, index - 1);
+	}
+
+	return batch_quals;
+}
+
 /*
  * Find the resno of the given attribute in the provided target list
  */
@@ -608,8 +756,24 @@ decompress_chunk_plan_create(PlannerInfo *root, RelOptInfo *rel, CustomPath *pat
 							  dcpath->reverse,
 							  dcpath->sorted_merge_append);
 
+	/*
+	 * The batch quals are evaluated on the tuples of the compressed scan, so
+	 * we only build them when the compressed scan produces a physical tlist.
+	 * They are expressions that have to be processed by setrefs like the
+	 * filters, so they go into custom_exprs.
+	 */
+	List *batch_qual_indexes = NIL;
+
+	if (target_list_compressed_is_physical)
+		decompress_plan->custom_exprs =
+			build_batch_quals(dcpath->info, decompress_plan->scan.plan.qual, &batch_qual_indexes);
+
 	decompress_plan->custom_private =
-		list_make4(settings, dcpath->decompression_map, dcpath->is_segmentby_column, sort_options);
+		list_make5(settings,
+				   dcpath->decompression_map,
+				   dcpath->is_segmentby_column,
+				   sort_options,
+				   batch_qual_indexes);
 
 	return &decompress_plan->scan.plan;
 }
@@ -75,12 +75,12 @@
 #include "debug_assert.h"
 
 static void reorder_rel(Oid tableOid, Oid indexOid, bool verbose, Oid wait_id,
-						Oid destination_tablespace, Oid index_tablespace);
+						Oid destination_tablespace, Oid index_tablespace, bool set_logged);
 
 #define REORDER_ACCESS_EXCLUSIVE_DEADLOCK_TIMEOUT "101000"
 
 static void rebuild_relation(Relation OldHeap, Oid indexOid, bool verbose, Oid wait_id,
-							 Oid destination_tablespace, Oid index_tablespace);
+							 Oid destination_tablespace, Oid index_tablespace, bool set_logged);
 static void copy_heap_data(Oid OIDNewHeap, Oid OIDOldHeap, Oid OIDOldIndex, bool verbose,
 						   bool *pSwapToastByContent, TransactionId *pFreezeXid,
 						   MultiXactId *pCutoffMulti);
@@ -389,9 +389,9 @@ tsl_copy_chunk_cleanup_proc(PG_FUNCTION_ARGS)
 	PG_RETURN_VOID();
 }
 
-void
-reorder_chunk(Oid chunk_id, Oid index_id, bool verbose, Oid wait_id, Oid destination_tablespace,
-			  Oid index_tablespace)
+static void
+reorder_chunk_internal(Oid chunk_id, Oid index_id, bool verbose, Oid wait_id,
+					   Oid destination_tablespace, Oid index_tablespace, bool set_logged)
 {
 	Chunk *chunk;
 	Cache *hcache;
@@ -483,10 +483,38 @@ reorder_chunk(Oid chunk_id, Oid index_id, bool verbose, Oid wait_id, Oid destina
 				verbose,
 				wait_id,
 				destination_tablespace,
-				index_tablespace);
+				index_tablespace,
+				set_logged);
 	ts_cache_release(hcache);
 }
 
+void
+reorder_chunk(Oid chunk_id, Oid index_id, bool verbose, Oid wait_id, Oid destination_tablespace,
+			  Oid index_tablespace)
+{
+	reorder_chunk_internal(chunk_id,
+						   index_id,
+						   verbose,
+						   wait_id,
+						   destination_tablespace,
+						   index_tablespace,
+						   false);
+}
+
+/*
+ * Reorder an unlogged chunk and make it a regular, logged chunk.
+ *
+ * The chunk is rewritten into a new logged table in the order of the index,
+ * and its indexes are built in bulk on the new table, like for any reorder.
+ * This is cheaper than reordering the chunk and setting it logged
+ * separately, since that would rewrite it twice.
+ */
+void
+reorder_chunk_set_logged(Oid chunk_id, Oid index_id)
+{
+	reorder_chunk_internal(chunk_id, index_id, false, InvalidOid, InvalidOid, InvalidOid, true);
+}
+
 /*
  * Find the index to reorder a chunk on based on a possibly NULL indexname
  * returns NULL if no such index is found
@@ -530,7 +558,7 @@ chunk_get_reorder_index(Hypertable *ht, Chunk *chunk, Oid index_relid, ChunkInde
  */
 static void
 reorder_rel(Oid tableOid, Oid indexOid, bool verbose, Oid wait_id, Oid destination_tablespace,
-			Oid index_tablespace)
+			Oid index_tablespace, bool set_logged)
 {
 	Relation OldHeap;
 	HeapTuple tuple;
@@ -574,7 +602,8 @@ reorder_rel(Oid tableOid, Oid indexOid, bool verbose, Oid wait_id, Oid destinati
 				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
 				 errmsg("cannot reorder a system relation")));
 
-	if (OldHeap->rd_rel->relpersistence != RELPERSISTENCE_PERMANENT)
+	if (OldHeap->rd_rel->relpersistence != RELPERSISTENCE_PERMANENT &&
+		!(set_logged && OldHeap->rd_rel->relpersistence == RELPERSISTENCE_UNLOGGED))
 		ereport(ERROR,
 				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
 				 errmsg("can only reorder a permanent table")));
@@ -630,7 +659,13 @@ reorder_rel(Oid tableOid, Oid indexOid, bool verbose, Oid wait_id, Oid destinati
 	check_index_is_clusterable_compat(OldHeap, indexOid, ExclusiveLock);
 
 	/* rebuild_relation does all the dirty work */
-	rebuild_relation(OldHeap, indexOid, verbose, wait_id, destination_tablespace, index_tablespace);
+	rebuild_relation(OldHeap,
+					 indexOid,
+					 verbose,
+					 wait_id,
+					 destination_tablespace,
+					 index_tablespace,
+					 set_logged);
 
 	/* NB: rebuild_relation does table_close() on OldHeap */
 }
@@ -640,12 +675,13 @@ reorder_rel(Oid tableOid, Oid indexOid, bool verbose, Oid wait_id, Oid destinati
  *
  * OldHeap: table to rebuild --- must be opened and exclusive-locked!
  * indexOid: index to cluster by, or InvalidOid to rewrite in physical order.
+ * set_logged: make the rebuilt table logged, like ALTER TABLE ... SET LOGGED.
  *
  * NB: this routine closes OldHeap at the right time; caller should not.
  */
 static void
 rebuild_relation(Relation OldHeap, Oid indexOid, bool verbose, Oid wait_id,
-				 Oid destination_tablespace, Oid index_tablespace)
+				 Oid destination_tablespace, Oid index_tablespace, bool set_logged)
 {
 	Oid tableOid = RelationGetRelid(OldHeap);
 	Oid tableSpace = OidIsValid(destination_tablespace) ? destination_tablespace :
@@ -661,8 +697,12 @@ rebuild_relation(Relation OldHeap, Oid indexOid, bool verbose, Oid wait_id,
 	/* Mark the correct index as clustered */
 	mark_index_clustered(OldHeap, indexOid, true);
 
-	/* Remember info about rel before closing OldHeap */
-	relpersistence = OldHeap->rd_rel->relpersistence;
+	/*
+	 * Remember info about rel before closing OldHeap. The indexes created for
+	 * the new table get its persistence, and the relation files swap makes
+	 * it the persistence of the rebuilt table and its indexes.
+	 */
+	relpersistence = set_logged ? RELPERSISTENCE_PERMANENT : OldHeap->rd_rel->relpersistence;
 
 	/* Close relcache entry, but keep lock until transaction commit */
 	table_close(OldHeap, NoLock);
@@ -17,5 +17,6 @@ extern Datum tsl_copy_chunk_cleanup_proc(PG_FUNCTION_ARGS);
 extern Datum tsl_subscription_exec(PG_FUNCTION_ARGS);
 extern void reorder_chunk(Oid chunk_id, Oid index_id, bool verbose, Oid wait_id,
 						  Oid destination_tablespace, Oid index_tablespace);
+extern void reorder_chunk_set_logged(Oid chunk_id, Oid index_id);
 
 #endif /* TIMESCALEDB_TSL_REORDER_H */
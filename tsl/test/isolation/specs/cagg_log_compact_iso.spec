@@ -0,0 +1,87 @@
+# This file and its contents are licensed under the Timescale License.
+# Please see the included NOTICE for copyright information and
+# LICENSE-TIMESCALE for a copy of the license.
+
+#
+# The refresh policy of a continuous aggregate compacts the invalidation
+# logs of all continuous aggregates on the hypertable, merging entries
+# that overlap or are adjacent. The log of an aggregate whose materialized
+# hypertable is locked is skipped.
+#
+setup
+{
+    SELECT _timescaledb_internal.stop_background_workers();
+    CREATE TABLE compact_test(time INTEGER NOT NULL, val INTEGER);
+    SELECT create_hypertable('compact_test', 'time', chunk_time_interval => 10);
+    CREATE OR REPLACE FUNCTION integer_now_compact() RETURNS INT LANGUAGE SQL STABLE AS $$ SELECT coalesce(max(time), 0) FROM compact_test $$;
+    SELECT set_integer_now_func('compact_test', 'integer_now_compact');
+}
+
+setup
+{
+    CREATE MATERIALIZED VIEW compact_a
+        WITH (timescaledb.continuous, timescaledb.materialized_only = true)
+        AS SELECT time_bucket(10, time), count(val) FROM compact_test GROUP BY 1 WITH NO DATA;
+    CREATE MATERIALIZED VIEW compact_b
+        WITH (timescaledb.continuous, timescaledb.materialized_only = true)
+        AS SELECT time_bucket(10, time), max(val) FROM compact_test GROUP BY 1 WITH NO DATA;
+    SELECT add_continuous_aggregate_policy('compact_a', 1000, 0, '1 hour');
+}
+
+setup
+{
+    DELETE FROM _timescaledb_catalog.continuous_aggs_materialization_invalidation_log
+    WHERE materialization_id = (SELECT mat_hypertable_id FROM _timescaledb_catalog.continuous_agg WHERE user_view_name = 'compact_b');
+    INSERT INTO _timescaledb_catalog.continuous_aggs_materialization_invalidation_log
+    SELECT mat_hypertable_id, lo, hi
+    FROM _timescaledb_catalog.continuous_agg, (VALUES (0, 9), (5, 14), (15, 19), (30, 39), (30, 39), (41, 49), (50, 59), (100, 200), (120, 130)) v(lo, hi)
+    WHERE user_view_name = 'compact_b';
+    CREATE FUNCTION lock_mattable(cagg name) RETURNS void AS $$
+    DECLARE
+      mattable text;
+    BEGIN
+      SELECT format('%I.%I', materialization_hypertable_schema, materialization_hypertable_name)
+      FROM timescaledb_information.continuous_aggregates
+      WHERE view_name = cagg
+      INTO mattable;
+      EXECUTE format('LOCK TABLE %s IN EXCLUSIVE MODE', mattable);
+    END; $$ LANGUAGE plpgsql;
+}
+
+teardown
+{
+    DROP FUNCTION lock_mattable(name);
+    DROP TABLE compact_test CASCADE;
+}
+
+session "P"
+setup { SET client_min_messages TO WARNING; }
+step "RunPolicy"
+{
+    DO $$
+    DECLARE
+      job_id int;
+    BEGIN
+      SELECT id FROM _timescaledb_config.bgw_job
+      WHERE proc_name = 'policy_refresh_continuous_aggregate'
+      INTO job_id;
+      CALL run_job(job_id);
+    END; $$;
+}
+
+session "S"
+step "ShowLog"
+{
+    SELECT lowest_modified_value AS lo, greatest_modified_value AS hi
+    FROM _timescaledb_catalog.continuous_aggs_materialization_invalidation_log
+    WHERE materialization_id = (SELECT mat_hypertable_id FROM _timescaledb_catalog.continuous_agg WHERE user_view_name = 'compact_b')
+    ORDER BY 1, 2;
+}
+
+# Holding a lock on the materialized hypertable of compact_b, like a
+# refresh of compact_b does, makes the policy skip the log of compact_b
+session "L"
+step "LockMat" { BEGIN; SELECT lock_mattable('compact_b'); }
+step "UnlockMat" { ROLLBACK; }
+
+permutation "LockMat" "RunPolicy" "ShowLog" "UnlockMat" "RunPolicy" "ShowLog"
@@ -5,3 +5,51 @@
 \set IS_DISTRIBUTED FALSE
 
 \ir include/cagg_invalidation_common.sql
+
+-- Rows inserted through the chunk dispatch add the range of inserted
+-- time values of each transaction to the invalidation log, for both
+-- INSERT and COPY
+RESET timescaledb.materializations_per_refresh_window;
+CREATE TABLE dispatch_inval (time int NOT NULL, device int, temp float);
+SELECT table_name FROM create_hypertable('dispatch_inval', 'time', chunk_time_interval => 10);
+CREATE OR REPLACE FUNCTION dispatch_inval_now()
+RETURNS int LANGUAGE SQL STABLE AS
+$$
+    SELECT coalesce(max(time), 0)
+    FROM dispatch_inval
+$$;
+SELECT set_integer_now_func('dispatch_inval', 'dispatch_inval_now');
+INSERT INTO dispatch_inval SELECT t, 1, 1.0 FROM generate_series(0, 99) t;
+
+CREATE MATERIALIZED VIEW dispatch_inval_10
+WITH (timescaledb.continuous,
+      timescaledb.materialized_only=true)
+AS
+SELECT time_bucket(10, time) AS bucket, device, avg(temp) AS avg_temp
+FROM dispatch_inval
+GROUP BY 1,2 WITH NO DATA;
+
+CALL refresh_continuous_aggregate('dispatch_inval_10', 0, 100);
+SELECT id AS dispatch_inval_id FROM _timescaledb_catalog.hypertable
+WHERE table_name = 'dispatch_inval' \gset
+
+-- One range covering all chunks inserted into by a transaction
+INSERT INTO dispatch_inval VALUES (15, 1, 2.0), (3, 2, 2.0), (27, 1, 2.0);
+COPY dispatch_inval FROM STDIN;
+42	1	2.0
+55	2	2.0
+48	1	2.0
+\.
+-- Rows above the invalidation threshold are not logged, but a range
+-- starting below the threshold is
+INSERT INTO dispatch_inval VALUES (150, 1, 2.0);
+BEGIN;
+INSERT INTO dispatch_inval VALUES (95, 1, 2.0);
+COPY dispatch_inval FROM STDIN;
+160	2	2.0
+\.
+COMMIT;
+
+SELECT start, "end" FROM hyper_invals
+WHERE hyper_id = :dispatch_inval_id
+ORDER BY 1, 2;
@@ -0,0 +1,156 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+-- Disable background workers since we are testing manual refresh
+\c :TEST_DBNAME :ROLE_SUPERUSER
+SELECT _timescaledb_internal.stop_background_workers();
+SET ROLE :ROLE_DEFAULT_PERM_USER;
+
+CREATE TABLE conditions (time timestamptz NOT NULL, device int, temp int);
+SELECT table_name FROM create_hypertable('conditions', 'time');
+
+INSERT INTO conditions
+SELECT t, d, (extract(epoch FROM t)::int / 600 * d) % 40
+FROM generate_series('2020-05-01 00:00 UTC'::timestamptz, '2020-05-04 23:50 UTC',
+                     '10 minutes') t,
+     generate_series(1, 3) d;
+
+-- Aggregate queries on the hypertable can be answered by a real-time
+-- continuous aggregate with the same or finer buckets
+CREATE MATERIALIZED VIEW hourly_temp
+WITH (timescaledb.continuous,
+      timescaledb.materialized_only=false)
+AS
+SELECT time_bucket('1 hour', time) AS hour, device, min(temp) AS min_temp,
+    max(temp) AS max_temp, sum(temp) AS sum_temp, count(*) AS num_rows
+FROM conditions
+GROUP BY 1,2 WITH NO DATA;
+CALL refresh_continuous_aggregate('hourly_temp', NULL, '2020-05-04 00:00 UTC');
+
+-- Run a query with and without routing. Show whether the query was routed,
+-- i.e., whether its plan reads the chunks of the materialized hypertable,
+-- and whether it returns the same result as without routing.
+CREATE FUNCTION check_routing(query text, OUT routed bool, OUT same_result bool)
+LANGUAGE plpgsql AS
+$$
+DECLARE
+    mat_id int;
+    plan_line text;
+BEGIN
+    SELECT mat_hypertable_id INTO mat_id
+    FROM _timescaledb_catalog.continuous_agg
+    WHERE user_view_name = 'hourly_temp';
+    PERFORM set_config('timescaledb.enable_cagg_query_routing', 'on', true);
+    routed := false;
+    FOR plan_line IN EXECUTE 'EXPLAIN (COSTS OFF) ' || query LOOP
+        IF strpos(plan_line, format('_hyper_%s_', mat_id)) > 0 THEN
+            routed := true;
+        END IF;
+    END LOOP;
+    EXECUTE 'CREATE TEMP TABLE routed_result AS ' || query;
+    PERFORM set_config('timescaledb.enable_cagg_query_routing', 'off', true);
+    EXECUTE 'CREATE TEMP TABLE unrouted_result AS ' || query;
+    EXECUTE 'SELECT NOT EXISTS ('
+        '(SELECT * FROM routed_result EXCEPT ALL SELECT * FROM unrouted_result) '
+        'UNION ALL '
+        '(SELECT * FROM unrouted_result EXCEPT ALL SELECT * FROM routed_result))'
+    INTO same_result;
+    DROP TABLE routed_result, unrouted_result;
+END
+$$;
+
+-- Same buckets and grouping columns
+SELECT * FROM check_routing($$
+SELECT time_bucket('1 hour', time), device, max(temp), count(*)
+FROM conditions
+WHERE time >= '2020-05-02 00:00 UTC' AND time < '2020-05-03 00:00 UTC'
+GROUP BY 1, 2
+$$);
+
+-- Coarser buckets are aggregated from the rows of the continuous aggregate
+SELECT * FROM check_routing($$
+SELECT time_bucket('1 day', time), min(temp), max(temp), sum(temp), count(*)
+FROM conditions
+WHERE time >= '2020-05-01 00:00 UTC' AND time < '2020-05-04 00:00 UTC'
+GROUP BY 1
+$$);
+
+-- Data after the watermark is aggregated in real time
+SELECT * FROM check_routing($$
+SELECT time_bucket('1 hour', time), device, count(*)
+FROM conditions
+WHERE time >= '2020-05-03 00:00 UTC'
+GROUP BY 1, 2
+$$);
+
+-- Filters that are not aligned with the buckets, and aggregates that are
+-- not in the continuous aggregate, are answered from the hypertable
+SELECT * FROM check_routing($$
+SELECT time_bucket('1 day', time), max(temp)
+FROM conditions
+WHERE time >= '2020-05-02 00:30 UTC' AND time < '2020-05-03 00:00 UTC'
+GROUP BY 1
+$$);
+
+SELECT * FROM check_routing($$
+SELECT time_bucket('1 day', time), avg(temp)
+FROM conditions
+WHERE time >= '2020-05-02 00:00 UTC' AND time < '2020-05-03 00:00 UTC'
+GROUP BY 1
+$$);
+
+-- Modifications that are not materialized yet are in the invalidation
+-- logs. Queries on the modified range are answered from the hypertable,
+-- while queries on other ranges are still routed.
+UPDATE conditions SET temp = 100
+WHERE time >= '2020-05-02 00:00 UTC' AND time < '2020-05-02 01:00 UTC';
+
+SELECT * FROM check_routing($$
+SELECT time_bucket('1 hour', time), device, max(temp), count(*)
+FROM conditions
+WHERE time >= '2020-05-02 00:00 UTC' AND time < '2020-05-03 00:00 UTC'
+GROUP BY 1, 2
+$$);
+
+SELECT * FROM check_routing($$
+SELECT time_bucket('1 day', time), max(temp), count(*)
+FROM conditions
+GROUP BY 1
+$$);
+
+SELECT * FROM check_routing($$
+SELECT time_bucket('1 hour', time), device, max(temp), count(*)
+FROM conditions
+WHERE time >= '2020-05-03 00:00 UTC' AND time < '2020-05-04 00:00 UTC'
+GROUP BY 1, 2
+$$);
+
+-- Modifications of the current transaction are only logged when it
+-- commits, so the hypertable is not routed after modifying it
+BEGIN;
+UPDATE conditions SET temp = 50
+WHERE time >= '2020-05-03 00:00 UTC' AND time < '2020-05-03 01:00 UTC';
+SELECT * FROM check_routing($$
+SELECT time_bucket('1 hour', time), device, max(temp), count(*)
+FROM conditions
+WHERE time >= '2020-05-03 00:00 UTC' AND time < '2020-05-04 00:00 UTC'
+GROUP BY 1, 2
+$$);
+ROLLBACK;
+
+-- Once the modified range is refreshed, queries on it are routed again
+CALL refresh_continuous_aggregate('hourly_temp', '2020-05-02 00:00 UTC', '2020-05-02 01:00 UTC');
+
+SELECT * FROM check_routing($$
+SELECT time_bucket('1 hour', time), device, max(temp), count(*)
+FROM conditions
+WHERE time >= '2020-05-02 00:00 UTC' AND time < '2020-05-03 00:00 UTC'
+GROUP BY 1, 2
+$$);
+
+SELECT * FROM check_routing($$
+SELECT time_bucket('1 day', time), max(temp), count(*)
+FROM conditions
+GROUP BY 1
+$$);
@@ -311,3 +311,85 @@ SELECT time_bucket('7 days', time) AS day, device, avg(temp) AS avg_temp
 FROM conditions
 GROUP BY 1,2 WITH NO DATA;
 COMMIT;
+
+-- Delta refresh only modifies the materialized rows that changed
+SELECT format('%I.%I', h.schema_name, h.table_name) AS mat_table
+FROM _timescaledb_catalog.continuous_agg ca
+JOIN _timescaledb_catalog.hypertable h ON h.id = ca.mat_hypertable_id
+WHERE ca.user_view_name = 'daily_temp' \gset
+CREATE TEMP TABLE daily_temp_before AS
+SELECT day, device, xmin::text AS row_xmin FROM :mat_table;
+
+SET timescaledb.enable_cagg_delta_refresh TO on;
+UPDATE conditions SET temp = temp + 10
+WHERE time >= '2020-05-02 00:00 UTC' AND time < '2020-05-03 00:00 UTC' AND device = 1;
+DELETE FROM conditions WHERE time >= '2020-05-04 00:00 UTC' AND device = 2;
+CALL refresh_continuous_aggregate('daily_temp', NULL, NULL);
+RESET timescaledb.enable_cagg_delta_refresh;
+
+-- Only the changed buckets are rewritten or deleted. The other rows in
+-- the refreshed buckets keep the version they had before the refresh.
+SELECT to_char(b.day AT TIME ZONE 'UTC', 'YYYY-MM-DD') AS day, b.device,
+    CASE WHEN m.day IS NULL THEN 'deleted' ELSE 'rewritten' END AS status
+FROM daily_temp_before b
+LEFT JOIN :mat_table m ON m.day = b.day AND m.device = b.device
+WHERE b.day < '2020-05-05 00:00 UTC' AND m.xmin::text IS DISTINCT FROM b.row_xmin
+ORDER BY 1, 2;
+SELECT count(*) > 0 AS has_unchanged
+FROM daily_temp_before b
+JOIN :mat_table m ON m.day = b.day AND m.device = b.device AND m.xmin::text = b.row_xmin
+WHERE b.day IN ('2020-05-02 00:00 UTC', '2020-05-04 00:00 UTC');
+
+-- The aggregate should match the equivalent query on the source table
+SELECT count(*) FROM (
+    (SELECT * FROM daily_temp
+     EXCEPT
+     SELECT time_bucket('1 day', time), device, avg(temp) FROM conditions GROUP BY 1,2)
+    UNION ALL
+    (SELECT time_bucket('1 day', time), device, avg(temp) FROM conditions GROUP BY 1,2
+     EXCEPT
+     SELECT * FROM daily_temp)
+) AS diff;
+
+-- Refresh in windows of one bucket, each committed separately
+TRUNCATE daily_temp_before;
+INSERT INTO daily_temp_before SELECT day, device, xmin::text FROM :mat_table;
+SET timescaledb.cagg_refresh_window_buckets TO 1;
+UPDATE conditions SET temp = temp + 5
+WHERE time >= '2020-05-01 00:00 UTC' AND time < '2020-05-02 00:00 UTC' AND device = 3;
+UPDATE conditions SET temp = temp + 5
+WHERE time >= '2020-05-03 00:00 UTC' AND time < '2020-05-04 00:00 UTC' AND device = 0;
+CALL refresh_continuous_aggregate('daily_temp', NULL, NULL);
+RESET timescaledb.cagg_refresh_window_buckets;
+
+-- Each invalidated bucket is refreshed in its own window, and every
+-- window is committed in a separate transaction
+SELECT count(DISTINCT m.day) AS windows, count(DISTINCT m.xmin::text) AS transactions
+FROM :mat_table m
+JOIN daily_temp_before b ON m.day = b.day AND m.device = b.device
+WHERE m.xmin::text <> b.row_xmin;
+
+SELECT count(*) FROM (
+    (SELECT * FROM daily_temp
+     EXCEPT
+     SELECT time_bucket('1 day', time), device, avg(temp) FROM conditions GROUP BY 1,2)
+    UNION ALL
+    (SELECT time_bucket('1 day', time), device, avg(temp) FROM conditions GROUP BY 1,2
+     EXCEPT
+     SELECT * FROM daily_temp)
+) AS diff;
+
+-- Nothing left to refresh
+CALL refresh_continuous_aggregate('daily_temp', NULL, NULL);
+
+-- Refresh statistics are recorded per continuous aggregate. The last
+-- refresh had nothing to do.
+SELECT refreshes > 0 AS refreshed,
+    ranges_refreshed > 0 AS has_ranges,
+    rows_inserted > 0 AS has_inserts,
+    raw_rows_read > 0 AS has_raw_rows,
+    last_ranges_refreshed,
+    last_rows_inserted,
+    running_pid
+FROM timescaledb_information.continuous_aggregate_refresh_stats
+WHERE view_name = 'daily_temp';
@@ -0,0 +1,74 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+-- A refresh of a continuous aggregate cascades to the continuous
+-- aggregates defined on top of it
+CREATE TABLE cascade_raw(time int NOT NULL, value int);
+SELECT table_name FROM create_hypertable('cascade_raw', 'time', chunk_time_interval => 10);
+CREATE FUNCTION cascade_now() RETURNS int LANGUAGE SQL STABLE AS
+$$
+    SELECT coalesce(max(time), 0) FROM cascade_raw
+$$;
+SELECT set_integer_now_func('cascade_raw', 'cascade_now');
+INSERT INTO cascade_raw SELECT t, 1 FROM generate_series(0, 99) t;
+
+CREATE MATERIALIZED VIEW cascade_1
+WITH (timescaledb.continuous, timescaledb.materialized_only = true)
+AS SELECT time_bucket(10, time) AS bucket, sum(value) AS total
+FROM cascade_raw GROUP BY 1 WITH NO DATA;
+CREATE MATERIALIZED VIEW cascade_2
+WITH (timescaledb.continuous, timescaledb.materialized_only = true)
+AS SELECT time_bucket(20, bucket) AS bucket, sum(total) AS total
+FROM cascade_1 GROUP BY 1 WITH NO DATA;
+CREATE MATERIALIZED VIEW cascade_3
+WITH (timescaledb.continuous, timescaledb.materialized_only = true)
+AS SELECT time_bucket(40, bucket) AS bucket, sum(total) AS total
+FROM cascade_2 GROUP BY 1 WITH NO DATA;
+
+CREATE VIEW cascade_totals AS
+SELECT 'cascade_1' AS cagg, count(*) AS buckets, sum(total) AS total FROM cascade_1
+UNION ALL
+SELECT 'cascade_2', count(*), sum(total) FROM cascade_2
+UNION ALL
+SELECT 'cascade_3', count(*), sum(total) FROM cascade_3;
+
+-- Refreshing the first level refreshes all levels
+SET timescaledb.enable_cagg_refresh_cascade = on;
+CALL refresh_continuous_aggregate('cascade_1', 0, 100);
+SELECT * FROM cascade_totals ORDER BY 1;
+
+-- Without cascading, only the refreshed level is updated
+INSERT INTO cascade_raw VALUES (5, 100);
+SET timescaledb.enable_cagg_refresh_cascade = off;
+CALL refresh_continuous_aggregate('cascade_1', 0, 20);
+SELECT * FROM cascade_totals ORDER BY 1;
+
+-- A refresh of a level in the middle cascades to the levels above it
+SET timescaledb.enable_cagg_refresh_cascade = on;
+CALL refresh_continuous_aggregate('cascade_2', 0, 20);
+SELECT * FROM cascade_totals ORDER BY 1;
+
+-- Cascading stops at the maximum depth, and the levels above keep their
+-- invalidations for their own refresh
+INSERT INTO cascade_raw VALUES (15, 100);
+SET timescaledb.cagg_refresh_cascade_max_depth = 1;
+CALL refresh_continuous_aggregate('cascade_1', 0, 20);
+SELECT * FROM cascade_totals ORDER BY 1;
+RESET timescaledb.cagg_refresh_cascade_max_depth;
+CALL refresh_continuous_aggregate('cascade_3', 0, 40);
+SELECT * FROM cascade_totals ORDER BY 1;
+
+-- A refresh that cascades commits between the levels, so it cannot run
+-- inside a transaction block
+INSERT INTO cascade_raw VALUES (25, 100);
+\set ON_ERROR_STOP 0
+BEGIN;
+CALL refresh_continuous_aggregate('cascade_1', 0, 40);
+ROLLBACK;
+\set ON_ERROR_STOP 1
+SELECT * FROM cascade_totals ORDER BY 1;
+CALL refresh_continuous_aggregate('cascade_1', 0, 40);
+SELECT * FROM cascade_totals ORDER BY 1;
+
+RESET timescaledb.enable_cagg_refresh_cascade;
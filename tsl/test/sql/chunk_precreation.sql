@@ -0,0 +1,65 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+CREATE TABLE precreate(time int NOT NULL, device int, value float);
+SELECT table_name FROM create_hypertable('precreate', 'time', 'device', 2, chunk_time_interval => 10);
+
+\set ON_ERROR_STOP 0
+-- integer time needs an integer_now function
+SELECT add_chunk_precreation_policy('precreate');
+\set ON_ERROR_STOP 1
+
+CREATE FUNCTION precreate_now() RETURNS int LANGUAGE SQL STABLE AS 'SELECT 25';
+SELECT set_integer_now_func('precreate', 'precreate_now');
+
+\set ON_ERROR_STOP 0
+SELECT add_chunk_precreation_policy('precreate', chunks_ahead => 0);
+\set ON_ERROR_STOP 1
+
+SELECT add_chunk_precreation_policy('precreate', chunks_ahead => 2) AS job_id \gset
+SELECT application_name LIKE 'Chunk Precreation Policy%' AS name_ok, schedule_interval, config
+FROM _timescaledb_config.bgw_job WHERE id = :job_id;
+
+\set ON_ERROR_STOP 0
+SELECT add_chunk_precreation_policy('precreate', chunks_ahead => 2);
+\set ON_ERROR_STOP 1
+SELECT add_chunk_precreation_policy('precreate', chunks_ahead => 2, if_not_exists => true);
+SELECT add_chunk_precreation_policy('precreate', chunks_ahead => 3, if_not_exists => true);
+
+-- the config is validated by the check function
+\set ON_ERROR_STOP 0
+SELECT _timescaledb_internal.policy_chunk_precreation_check('{"hypertable_id": 1, "chunks_ahead": 0}');
+SELECT _timescaledb_internal.policy_chunk_precreation_check('{"hypertable_id": 1}');
+SELECT _timescaledb_internal.policy_chunk_precreation_check('{"hypertable_id": 1000, "chunks_ahead": 1}');
+\set ON_ERROR_STOP 1
+SELECT _timescaledb_internal.policy_chunk_precreation_check('{"hypertable_id": 1, "chunks_ahead": 1}');
+
+-- the job creates the chunks of the current time range and of the next two
+-- for every space partition
+CALL run_job(:job_id);
+SELECT range_start_integer, range_end_integer, count(*)
+FROM timescaledb_information.chunks WHERE hypertable_name = 'precreate'
+GROUP BY 1, 2 ORDER BY 1;
+
+-- running it again creates no chunks, and inserts use the created chunks
+CALL run_job(:job_id);
+INSERT INTO precreate SELECT t, d, 1 FROM generate_series(20, 49) t, generate_series(1, 4) d;
+SELECT count(*) FROM timescaledb_information.chunks WHERE hypertable_name = 'precreate';
+
+SELECT remove_chunk_precreation_policy('precreate');
+SELECT count(*) FROM _timescaledb_config.bgw_job WHERE id = :job_id;
+\set ON_ERROR_STOP 0
+SELECT remove_chunk_precreation_policy('precreate');
+\set ON_ERROR_STOP 1
+SELECT remove_chunk_precreation_policy('precreate', if_exists => true);
+
+-- the job runs every half chunk interval for time-based hypertables
+CREATE TABLE precreate_tz(time timestamptz NOT NULL, value float);
+SELECT table_name FROM create_hypertable('precreate_tz', 'time', chunk_time_interval => interval '1 day');
+SELECT add_chunk_precreation_policy('precreate_tz') AS job_id \gset
+SELECT schedule_interval, config FROM _timescaledb_config.bgw_job WHERE id = :job_id;
+CALL run_job(:job_id);
+SELECT count(*) FROM timescaledb_information.chunks
+WHERE hypertable_name = 'precreate_tz' AND range_end > now();
+SELECT remove_chunk_precreation_policy('precreate_tz');
@@ -0,0 +1,70 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+-- Filters on orderby columns are checked against the min/max metadata of
+-- each compressed batch. Batches that cannot match are removed by the
+-- filter pushed down to the compressed scan, and batches where the filter
+-- holds for the min and the max value are decompressed without checking
+-- the filter for every row.
+CREATE TABLE batch_filter (time int NOT NULL, device int, value float);
+SELECT table_name FROM create_hypertable('batch_filter', 'time', chunk_time_interval => 10000);
+ALTER TABLE batch_filter SET (
+    timescaledb.compress,
+    timescaledb.compress_orderby = 'time',
+    timescaledb.compress_segmentby = 'device');
+
+-- Four batches of 1000 rows for every device
+INSERT INTO batch_filter SELECT t, d, t FROM generate_series(0, 3999) t, generate_series(1, 4) d;
+SELECT count(compress_chunk(ch)) FROM show_chunks('batch_filter') ch;
+
+CREATE FUNCTION batch_filter_stats(query text)
+RETURNS TABLE (batches_read bigint, batches_without_filter bigint, rows_removed bigint, rows bigint)
+LANGUAGE plpgsql AS
+$$
+DECLARE
+    plan jsonb;
+BEGIN
+    EXECUTE 'EXPLAIN (ANALYZE, COSTS OFF, TIMING OFF, SUMMARY OFF, FORMAT JSON) ' || query
+    INTO plan;
+    RETURN QUERY
+    SELECT sum((node->'Plans'->0->>'Actual Rows')::bigint)::bigint,
+        sum((node->>'Batches Without Row Filter')::bigint)::bigint,
+        sum((node->>'Rows Removed by Filter')::bigint)::bigint,
+        sum((node->>'Actual Rows')::bigint)::bigint
+    FROM jsonb_path_query(plan, 'strict $.** ? (@."Custom Plan Provider" == "DecompressChunk")') node;
+END
+$$;
+
+EXPLAIN (costs off) SELECT * FROM batch_filter WHERE time >= 1500 AND time < 3500;
+
+-- Only the batches at the bounds are filtered row by row
+SELECT * FROM batch_filter_stats('SELECT * FROM batch_filter WHERE time >= 1500 AND time < 3500');
+SELECT * FROM batch_filter_stats('SELECT * FROM batch_filter WHERE 3500 > time AND 1500 <= time');
+SELECT count(*), min(time), max(time) FROM batch_filter WHERE time >= 1500 AND time < 3500;
+
+-- Bounds at the edges of the batches
+SELECT * FROM batch_filter_stats('SELECT * FROM batch_filter WHERE time >= 1000 AND time <= 2999');
+SELECT count(*), min(time), max(time) FROM batch_filter WHERE time >= 1000 AND time <= 2999;
+SELECT * FROM batch_filter_stats('SELECT * FROM batch_filter WHERE time > 1000 AND time < 2999');
+SELECT count(*), min(time), max(time) FROM batch_filter WHERE time > 1000 AND time < 2999;
+
+-- An equality filter holds for all rows of a batch only if all rows have
+-- the same value
+SELECT * FROM batch_filter_stats('SELECT * FROM batch_filter WHERE time = 2500');
+SELECT count(*), min(time), max(time) FROM batch_filter WHERE time = 2500;
+
+-- Bounds outside of the range of the data
+SELECT * FROM batch_filter_stats('SELECT * FROM batch_filter WHERE time > -100 AND time < 5000');
+SELECT * FROM batch_filter_stats('SELECT * FROM batch_filter WHERE time > 3999');
+SELECT count(*) FROM batch_filter WHERE time > -100 AND time < 5000;
+SELECT count(*) FROM batch_filter WHERE time > 3999;
+
+-- NULL bounds match no rows
+SELECT count(*) FROM batch_filter WHERE time < NULL::int;
+SELECT count(*) FROM batch_filter WHERE time < (SELECT NULL::int);
+SELECT count(*) FROM batch_filter WHERE time >= 1500 AND time < (SELECT NULL::int);
+
+-- Columns without metadata are filtered row by row
+SELECT * FROM batch_filter_stats('SELECT * FROM batch_filter WHERE value >= 1500 AND value < 3500');
+SELECT count(*), min(time), max(time) FROM batch_filter WHERE value >= 1500 AND value < 3500;
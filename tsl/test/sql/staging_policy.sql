@@ -0,0 +1,78 @@
+-- This file and its contents are licensed under the Timescale License.
+-- Please see the included NOTICE for copyright information and
+-- LICENSE-TIMESCALE for a copy of the license.
+
+CREATE TABLE staged(time int NOT NULL, device int, value text);
+SELECT table_name FROM create_hypertable('staged', 'time', chunk_time_interval => 10);
+
+\set ON_ERROR_STOP 0
+SELECT add_staging_policy('staged', interval '1 day');
+-- integer time needs an integer_now function
+SELECT add_staging_policy('staged', 10);
+\set ON_ERROR_STOP 1
+
+CREATE FUNCTION staged_now() RETURNS int LANGUAGE SQL STABLE AS 'SELECT 45';
+SELECT set_integer_now_func('staged', 'staged_now');
+
+SELECT add_staging_policy('staged', 10) AS job_id \gset
+SELECT application_name LIKE 'Staging Policy%' AS name_ok, schedule_interval, config
+FROM _timescaledb_config.bgw_job WHERE id = :job_id;
+
+\set ON_ERROR_STOP 0
+SELECT add_staging_policy('staged', 10);
+\set ON_ERROR_STOP 1
+SELECT add_staging_policy('staged', 10, if_not_exists => true);
+SELECT add_staging_policy('staged', 20, if_not_exists => true);
+
+-- the persistence of the heap, the indexes and the TOAST table of the chunks
+CREATE VIEW staged_chunks AS
+SELECT ch.range_start_integer, c.relpersistence AS heap,
+       (SELECT string_agg(DISTINCT i.relpersistence::text, ',')
+        FROM pg_index x JOIN pg_class i ON i.oid = x.indexrelid
+        WHERE x.indrelid = c.oid) AS indexes,
+       t.relpersistence AS toast
+FROM timescaledb_information.chunks ch
+JOIN pg_class c ON c.oid = format('%I.%I', ch.chunk_schema, ch.chunk_name)::regclass
+LEFT JOIN pg_class t ON t.oid = c.reltoastrelid
+WHERE ch.hypertable_name = 'staged';
+
+-- new chunks are created unlogged while the policy exists
+INSERT INTO staged SELECT t, t % 3, repeat('x', 100 * t) FROM generate_series(0, 49) t;
+SELECT * FROM staged_chunks ORDER BY range_start_integer;
+
+-- compressed chunks are set logged, like their compressed chunk
+ALTER TABLE staged SET (timescaledb.compress);
+SELECT count(compress_chunk(c)) FROM show_chunks('staged', older_than => 10) c;
+
+-- every run merges the oldest chunk that ends before now - merge_after
+CALL run_job(:job_id);
+SELECT * FROM staged_chunks ORDER BY range_start_integer;
+CALL run_job(:job_id);
+CALL run_job(:job_id);
+CALL run_job(:job_id);
+SELECT * FROM staged_chunks ORDER BY range_start_integer;
+
+SELECT c.relpersistence
+FROM _timescaledb_catalog.chunk ch
+JOIN _timescaledb_catalog.chunk comp ON comp.id = ch.compressed_chunk_id
+JOIN pg_class c ON c.oid = format('%I.%I', comp.schema_name, comp.table_name)::regclass;
+
+-- merged chunks are sorted on the time index and keep their rows
+SELECT array_agg(time ORDER BY ctid) FROM staged WHERE time >= 10 AND time < 20;
+SELECT count(*), sum(length(value)) FROM staged;
+
+-- removing the policy merges the chunks that are still staged
+SELECT remove_staging_policy('staged');
+SELECT count(*) FROM _timescaledb_config.bgw_job WHERE id = :job_id;
+SELECT * FROM staged_chunks ORDER BY range_start_integer;
+SELECT array_agg(time ORDER BY ctid) FROM staged WHERE time >= 40;
+SELECT count(*), sum(length(value)) FROM staged;
+
+\set ON_ERROR_STOP 0
+SELECT remove_staging_policy('staged');
+\set ON_ERROR_STOP 1
+SELECT remove_staging_policy('staged', if_exists => true);
+
+-- new chunks are logged again
+INSERT INTO staged VALUES (55, 1, 'x');
+SELECT * FROM staged_chunks WHERE range_start_integer = 50;